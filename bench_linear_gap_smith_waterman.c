@@ -0,0 +1,985 @@
+/* Benchmark of the Smith-Waterman linear gap penalty kernels with synthetic
+ * EDNAFULL (NUC4.4) queries and reads.
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+#include <getopt.h>
+#include <sys/resource.h>
+
+#include "gqss.h"
+
+#define BENCH_GAP_PENALTY 16
+#define BENCH_BATCH_SIZE 1024
+#define BENCH_MAX_TIMINGS 8
+
+//stages faster than this in the baseline are too noisy to be compared
+#define BENCH_MIN_COMPARED_SECONDS 0.05
+
+static struct option getopt_long_options[] = {
+	{"query-length", required_argument, NULL, 0},
+	{"reads", required_argument, NULL, 0},
+	{"read-length", required_argument, NULL, 0},
+	{"error-rate", required_argument, NULL, 0},
+	{"indel-rate", required_argument, NULL, 0},
+	{"duplicate-rate", required_argument, NULL, 0},
+	{"seed", required_argument, NULL, 0},
+	{"reference-reads", required_argument, NULL, 0},
+	{"repeat", required_argument, NULL, 0},
+	{"json", required_argument, NULL, 0},
+	{"baseline", required_argument, NULL, 0},
+	{"tolerance", required_argument, NULL, 0},
+	{"threads", required_argument, NULL, 't'},
+	{"help", no_argument, NULL, 'h'},
+	{NULL, 0, NULL, 0}
+};
+
+static const char* help_message =
+	"Usage: bench_linear_gap_smith_waterman [OPTION]...\n"
+	"   or: bench_linear_gap_smith_waterman generate [OPTION]... PREFIX\n"
+	"Time the parsing, alignment, traceback and formatting of synthetic reads, or write\n"
+	"the synthetic query and reads to PREFIX.fasta and PREFIX.fastq.\n"
+	"\n"
+	"  --query-length=INT          length of the query (default value is 1000)\n"
+	"  --reads=INT                 number of reads (default value is 10000)\n"
+	"  --read-length=INT           length of the reads (default value is 150)\n"
+	"  --error-rate=F              probability of a substitution per base (default\n"
+	"                              value is 0.01)\n"
+	"  --indel-rate=F              probability of an insertion or deletion per base\n"
+	"                              (default value is 0.001)\n"
+	"  --duplicate-rate=F          probability of a read repeating an earlier read\n"
+	"                              (default value is 0.1)\n"
+	"  --seed=INT                  seed of the generator (default value is 1)\n"
+	"  --reference-reads=INT       number of reads aligned by the reference kernel\n"
+	"                              linear_gap_smith_waterman() (default value is 200)\n"
+	"  --repeat=INT                run the benchmark INT times and keep the median\n"
+	"                              time of each stage (default value is 1)\n"
+	"  --json=FILE                 write the results and the peak resident set size\n"
+	"                              to FILE as JSON\n"
+	"  --baseline=FILE             compare the results to the JSON results FILE, the\n"
+	"                              exit status is 1 on a regression\n"
+	"  --tolerance=F               fraction by which a result may be worse than the\n"
+	"                              baseline (default value is 0.2)\n"
+	"  -t, --threads=INT           number of threads of the batch aligner (default\n"
+	"                              value is 1)\n"
+	"  -h, --help                  print this help message and exit\n";
+
+typedef struct bench_options {
+	size_t query_length;
+	size_t read_count;
+	size_t read_length;
+	double error_rate;
+	double indel_rate;
+	double duplicate_rate;
+	uint64_t seed;
+	size_t reference_read_count;
+	size_t repeat_count;
+	char* json_filename;
+	char* baseline_filename;
+	double tolerance;
+	size_t thread_count;
+	char* generate_prefix;
+} bench_options;
+
+/*
+	bench_data is the synthetic input of a benchmark: the query and the reads as the 'fastq_length' bytes of a FASTQ file,
+	parsed into 'records'.
+*/
+typedef struct bench_data {
+	char* query;
+	char* fastq;
+	size_t fastq_length;
+	gqss_fastq_record* records;
+	size_t record_count;
+	uint64_t cell_count;
+} bench_data;
+
+/*
+	bench_timing is the time spent by a stage or kernel on 'read_count' reads of 'cell_count' scoring matrix cells (0 for
+	the stages that fill no scoring matrix, such as the traceback).
+*/
+typedef struct bench_timing {
+	const char* name;
+	size_t read_count;
+	uint64_t cell_count;
+	double seconds;
+} bench_timing;
+
+//SplitMix64 generator, the same seed always generates the same data
+static uint64_t next_random(uint64_t* state) {
+	*state = (*state) + UINT64_C(0x9e3779b97f4a7c15);
+
+	uint64_t value = *state;
+	value = (value ^ (value >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+	value = (value ^ (value >> 27)) * UINT64_C(0x94d049bb133111eb);
+	return value ^ (value >> 31);
+}
+
+//uniformly distributed value in [0, 1)
+static double next_probability(uint64_t* state) {
+	return (double)(next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static char next_base(uint64_t* state) {
+	return "ACGT"[next_random(state) & 3];
+}
+
+static double elapsed_seconds(struct timespec* start_time) {
+	struct timespec end_time;
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+	return (double)(end_time.tv_sec - start_time->tv_sec) + ((double)(end_time.tv_nsec - start_time->tv_nsec) * 0.000000001);
+}
+
+/*
+	size_t generate_read(bench_options* options, uint64_t* state, char* query, char* read)
+
+	generate_read() writes a read of up to 'options->read_length' bases to 'read': a random window of 'query' (or of its
+	reverse complement, for half of the reads) with substitutions, insertions and deletions at the rates of 'options'. The
+	function returns the length of the read.
+*/
+static size_t generate_read(bench_options* options, uint64_t* state, char* query, char* read) {
+	size_t window_length = (options->read_length < options->query_length) ? options->read_length : options->query_length;
+	size_t start = (size_t)(next_random(state) % (options->query_length - window_length + 1));
+	bool reverse_complement = ((next_random(state) & 1) == 1);
+
+	size_t read_length = 0;
+	size_t position = start;
+	while ((read_length < options->read_length) && (position < start + window_length)) {
+		char base = reverse_complement ? complement_dna_base(query[options->query_length - 1 - position]) : query[position];
+
+		double event = next_probability(state);
+		if (event < (options->indel_rate / 2)) {
+			//deletion of the query base
+			position++;
+			continue;
+		}
+		if (event < options->indel_rate) {
+			//insertion before the query base
+			read[read_length] = next_base(state);
+			read_length++;
+			continue;
+		}
+		if (event < (options->indel_rate + options->error_rate)) {
+			//substitution by any other base
+			char substitution = next_base(state);
+			while (substitution == base) {
+				substitution = next_base(state);
+			}
+			base = substitution;
+		}
+
+		read[read_length] = base;
+		read_length++;
+		position++;
+	}
+
+	//reads longer than the query end with random bases
+	while (read_length < options->read_length) {
+		read[read_length] = next_base(state);
+		read_length++;
+	}
+	return read_length;
+}
+
+/*
+	bool generate_bench_data(bench_options* options, bench_data* data)
+
+	generate_bench_data() generates a random query and a FASTQ file of 'options->read_count' reads of it, a fraction
+	'options->duplicate_rate' of which repeat an earlier read. The function returns false if memory could not be allocated.
+*/
+static bool generate_bench_data(bench_options* options, bench_data* data) {
+	uint64_t state = options->seed;
+
+	memset(data, 0, sizeof(bench_data));
+
+	//identifier line of up to 40 characters, sequence, separator and quality lines
+	size_t record_capacity = 40 + (2 * options->read_length) + 4;
+
+	data->query = (char *)malloc((options->query_length + 1) * sizeof(char));
+	data->fastq = (char *)malloc((options->read_count * record_capacity + 1) * sizeof(char));
+	char* read = (char *)malloc((options->read_length + 1) * sizeof(char));
+	size_t* read_starts = (size_t *)malloc((options->read_count + 1) * sizeof(size_t));
+	size_t* read_lengths = (size_t *)malloc((options->read_count + 1) * sizeof(size_t));
+	if ((data->query == NULL) || (data->fastq == NULL) || (read == NULL) || (read_starts == NULL) || (read_lengths == NULL)) {
+		perror("generate_bench_data(): malloc(): error");
+
+		free(read_lengths);
+		free(read_starts);
+		free(read);
+		return false;
+	}
+
+	for (size_t i = 0; i < options->query_length; i++) {
+		data->query[i] = next_base(&state);
+	}
+	data->query[options->query_length] = '\0';
+
+	size_t length = 0;
+	for (size_t i = 0; i < options->read_count; i++) {
+		size_t read_length;
+		if ((i > 0) && (next_probability(&state) < options->duplicate_rate)) {
+			size_t earlier = (size_t)(next_random(&state) % i);
+			read_length = read_lengths[earlier];
+			memcpy(read, data->fastq + read_starts[earlier], read_length);
+		}
+		else {
+			read_length = generate_read(options, &state, data->query, read);
+		}
+
+		length = length + (size_t)sprintf(data->fastq + length, "@bench_read_%zu\n", i);
+		read_starts[i] = length;
+		read_lengths[i] = read_length;
+		memcpy(data->fastq + length, read, read_length);
+		length = length + read_length;
+		memcpy(data->fastq + length, "\n+\n", 3);
+		length = length + 3;
+		memset(data->fastq + length, 'I', read_length);
+		length = length + read_length;
+		data->fastq[length] = '\n';
+		length++;
+	}
+	data->fastq[length] = '\0';
+	data->fastq_length = length;
+
+	free(read_lengths);
+	free(read_starts);
+	free(read);
+	return true;
+}
+
+static void free_bench_data(bench_data* data) {
+	free(data->query);
+	free(data->fastq);
+	free(data->records);
+	return;
+}
+
+/*
+	int write_generated_files(bench_options* options, bench_data* data)
+
+	write_generated_files() writes the query to 'PREFIX.fasta' and the reads to 'PREFIX.fastq', for benchmarks of the
+	ednafull_linear_smith_waterman application. The function returns the exit status.
+*/
+static int write_generated_files(bench_options* options, bench_data* data) {
+	size_t prefix_length = strlen(options->generate_prefix);
+	char* filename = (char *)malloc((prefix_length + 7) * sizeof(char));
+	if (filename == NULL) {
+		perror("write_generated_files(): malloc(): error");
+		return 1;
+	}
+
+	sprintf(filename, "%s.fasta", options->generate_prefix);
+	FILE* fasta_fd = fopen(filename, "wb");
+	if ((fasta_fd == NULL) || (fprintf(fasta_fd, ">bench_query length=%zu seed=%" PRIu64 "\n%s\n", options->query_length, options->seed, data->query) < 0)
+			|| (fclose(fasta_fd) != 0)) {
+		perror("write_generated_files(): failed to write the FASTA file");
+		free(filename);
+		return 2;
+	}
+	printf("Query written to \"%s\"\n", filename);
+
+	sprintf(filename, "%s.fastq", options->generate_prefix);
+	FILE* fastq_fd = fopen(filename, "wb");
+	if ((fastq_fd == NULL) || (fwrite(data->fastq, sizeof(char), data->fastq_length, fastq_fd) != data->fastq_length) || (fclose(fastq_fd) != 0)) {
+		perror("write_generated_files(): failed to write the FASTQ file");
+		free(filename);
+		return 2;
+	}
+	printf("%zu reads written to \"%s\"\n", options->read_count, filename);
+
+	free(filename);
+	return 0;
+}
+
+/*
+	bool bench_parse(bench_data* data, bench_timing* timing)
+
+	bench_parse() times the parsing of the FASTQ data into 'data->records' in batches, as the alignment stream parses its
+	input. The function returns false if memory could not be allocated.
+*/
+static bool bench_parse(bench_data* data, bench_timing* timing) {
+	size_t capacity = BENCH_BATCH_SIZE;
+
+	//records of an earlier repetition
+	free(data->records);
+	data->records = (gqss_fastq_record *)malloc(capacity * sizeof(gqss_fastq_record));
+	if (data->records == NULL) {
+		perror("bench_parse(): malloc(): error");
+		return false;
+	}
+
+	struct timespec start_time;
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+	size_t offset = 0;
+	data->record_count = 0;
+	while (offset < data->fastq_length) {
+		if (capacity - data->record_count < BENCH_BATCH_SIZE) {
+			capacity = capacity * 2;
+			gqss_fastq_record* records = (gqss_fastq_record *)realloc(data->records, capacity * sizeof(gqss_fastq_record));
+			if (records == NULL) {
+				perror("bench_parse(): realloc(): error");
+				return false;
+			}
+			data->records = records;
+		}
+
+		size_t record_count;
+		offset = offset + parse_fastq_records(data->fastq + offset, data->fastq_length - offset, true, data->records + data->record_count, BENCH_BATCH_SIZE, &record_count);
+		if (record_count == 0) {
+			break;
+		}
+		data->record_count = data->record_count + record_count;
+	}
+
+	timing->name = "parse";
+	timing->read_count = data->record_count;
+	timing->cell_count = 0;
+	timing->seconds = elapsed_seconds(&start_time);
+	return true;
+}
+
+/*
+	bool bench_reference(bench_options* options, bench_data* data, bench_timing* fill, bench_timing* traceback)
+
+	bench_reference() times linear_gap_smith_waterman() and trace_linear_gap_smith_waterman() on the first
+	'options->reference_read_count' reads. The function returns false if memory could not be allocated.
+*/
+static bool bench_reference(bench_options* options, bench_data* data, bench_timing* fill, bench_timing* traceback) {
+	size_t read_count = (options->reference_read_count < data->record_count) ? options->reference_read_count : data->record_count;
+	size_t query_length = strlen(data->query);
+
+	fill->name = "reference fill";
+	fill->read_count = read_count;
+	fill->cell_count = 0;
+	fill->seconds = 0;
+	traceback->name = "reference traceback";
+	traceback->read_count = read_count;
+	traceback->cell_count = 0;
+	traceback->seconds = 0;
+
+	char* read = (char *)malloc((options->read_length + 1) * sizeof(char));
+	int64_t* scores = (int64_t *)malloc(query_length * options->read_length * sizeof(int64_t));
+	char* trace_X = (char *)malloc((query_length + options->read_length + 3) * sizeof(char));
+	char* trace_Y = (char *)malloc((query_length + options->read_length + 3) * sizeof(char));
+	if ((read == NULL) || (scores == NULL) || (trace_X == NULL) || (trace_Y == NULL)) {
+		perror("bench_reference(): malloc(): error");
+
+		free(trace_Y);
+		free(trace_X);
+		free(scores);
+		free(read);
+		return false;
+	}
+
+	struct timespec start_time;
+	for (size_t i = 0; i < read_count; i++) {
+		gqss_fastq_record* record = &(data->records[i]);
+		memcpy(read, record->sequence, record->sequence_length);
+		read[record->sequence_length] = '\0';
+
+		clock_gettime(CLOCK_MONOTONIC, &start_time);
+		linear_gap_smith_waterman(data->query, read, scores, get_nuc_4_4_value, BENCH_GAP_PENALTY);
+		fill->seconds = fill->seconds + elapsed_seconds(&start_time);
+
+		clock_gettime(CLOCK_MONOTONIC, &start_time);
+		size_t x;
+		size_t y;
+		if (best_linear_gap_smith_waterman_score_indices(query_length, record->sequence_length, scores, &x, &y)) {
+			trace_linear_gap_smith_waterman(data->query, read, scores, trace_X, trace_Y, &x, &y, get_nuc_4_4_value, BENCH_GAP_PENALTY);
+		}
+		traceback->seconds = traceback->seconds + elapsed_seconds(&start_time);
+
+		fill->cell_count = fill->cell_count + ((uint64_t)query_length * record->sequence_length);
+	}
+
+	free(trace_Y);
+	free(trace_X);
+	free(scores);
+	free(read);
+	return true;
+}
+
+/*
+	bool bench_aligner(bench_data* data, bench_timing* fill, bench_timing* traceback)
+
+	bench_aligner() times a gqss_aligner computing the scores only (a traceback cut-off of INT64_MAX) and then traces back
+	every read, timed by the counters of the aligner (see gqss_aligner_stats). The function returns false if an alignment
+	failed.
+*/
+static bool bench_aligner(bench_data* data, bench_timing* fill, bench_timing* traceback) {
+	gqss_aligner* aligner = gqss_aligner_create(data->query, strlen(data->query), get_nuc_4_4_value, BENCH_GAP_PENALTY);
+	if (aligner == NULL) {
+		return false;
+	}
+
+	gqss_alignment_result result;
+	struct timespec start_time;
+
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+	for (size_t i = 0; i < data->record_count; i++) {
+		if (!gqss_aligner_align_cutoff(aligner, data->records[i].sequence, data->records[i].sequence_length, INT64_MAX, &result)) {
+			gqss_aligner_destroy(aligner);
+			return false;
+		}
+	}
+	fill->seconds = elapsed_seconds(&start_time);
+
+	//the counters time the traceback alone, not the fill computed again before it
+	gqss_aligner_set_stats(aligner, true);
+	for (size_t i = 0; i < data->record_count; i++) {
+		if (!gqss_aligner_align(aligner, data->records[i].sequence, data->records[i].sequence_length, &result)) {
+			gqss_aligner_destroy(aligner);
+			return false;
+		}
+	}
+
+	gqss_aligner_stats stats;
+	memset(&stats, 0, sizeof(gqss_aligner_stats));
+	gqss_aligner_add_stats(aligner, &stats);
+	traceback->seconds = (double)stats.traceback_nanoseconds / 1e9;
+
+	fill->name = "aligner fill";
+	fill->read_count = data->record_count;
+	fill->cell_count = data->cell_count;
+	traceback->name = "aligner traceback";
+	traceback->read_count = data->record_count;
+	traceback->cell_count = 0;
+
+	gqss_aligner_destroy(aligner);
+	return true;
+}
+
+/*
+	bool align_bench_batches(bench_data* data, gqss_batch_aligner* batch_aligner, FILE* null_fd, bench_timing* fill, bench_timing* traceback, bench_timing* format)
+
+	align_bench_batches() aligns the reads in batches of the alignment stream with 'batch_aligner', first without and then with
+	the traceback, and writes the TSV rows of the alignments to 'null_fd'. The traceback is timed by the counters of the
+	worker aligners, the time of all workers divided by their number. The function returns false if an alignment failed.
+*/
+static bool align_bench_batches(bench_data* data, gqss_batch_aligner* batch_aligner, FILE* null_fd, bench_timing* fill, bench_timing* traceback, bench_timing* format) {
+	size_t read_offsets[BENCH_BATCH_SIZE];
+	size_t read_lengths[BENCH_BATCH_SIZE];
+	struct timespec start_time;
+
+	gqss_batch_result results;
+	gqss_batch_result_init(&results);
+
+	bool aligned = true;
+	for (size_t first = 0; aligned && (first < data->record_count); first = first + BENCH_BATCH_SIZE) {
+		size_t read_count = ((data->record_count - first) < BENCH_BATCH_SIZE) ? (data->record_count - first) : BENCH_BATCH_SIZE;
+		gqss_fastq_record* records = data->records + first;
+
+		for (size_t i = 0; i < read_count; i++) {
+			read_offsets[i] = (size_t)(records[i].sequence - data->fastq);
+			read_lengths[i] = records[i].sequence_length;
+		}
+
+		clock_gettime(CLOCK_MONOTONIC, &start_time);
+		aligned = gqss_batch_aligner_align_cutoff(batch_aligner, data->fastq, read_offsets, read_lengths, read_count, INT64_MAX, &results);
+		fill->seconds = fill->seconds + elapsed_seconds(&start_time);
+
+		//only the traceback pass is counted, so that the fill pass is timed without reading the clock per read
+		gqss_batch_aligner_set_stats(batch_aligner, true);
+		aligned = aligned && gqss_batch_aligner_align(batch_aligner, data->fastq, read_offsets, read_lengths, read_count, &results);
+		gqss_batch_aligner_set_stats(batch_aligner, false);
+
+		clock_gettime(CLOCK_MONOTONIC, &start_time);
+		for (size_t i = 0; aligned && (i < read_count); i++) {
+			size_t alignment_length = results.alignment_offsets[i + 1] - results.alignment_offsets[i] - 1;
+			size_t quality_length = (alignment_length > 0) ? (results.read_stops[i] - results.read_starts[i] + 1) : 0;
+
+			write_int_linear_gap_penalty_tsv_alignment(null_fd, "", ">bench_query", records[i].identifier, records[i].identifier_length, "NUC4.4",
+										results.scores[i], BENCH_GAP_PENALTY,
+										(results.query_alignments + results.alignment_offsets[i]),
+										(results.read_alignments + results.alignment_offsets[i]),
+										alignment_length, (records[i].quality + results.read_starts[i]), quality_length);
+		}
+		fflush(null_fd);
+		format->seconds = format->seconds + elapsed_seconds(&start_time);
+	}
+
+	gqss_aligner_stats stats;
+	memset(&stats, 0, sizeof(gqss_aligner_stats));
+	size_t worker_count = gqss_batch_aligner_worker_count(batch_aligner);
+	for (size_t i = 0; i < worker_count; i++) {
+		gqss_batch_aligner_add_stats(batch_aligner, i, &stats);
+	}
+	traceback->seconds = (double)stats.traceback_nanoseconds / 1e9 / (double)worker_count;
+
+	gqss_batch_result_free(&results);
+	return aligned;
+}
+
+/*
+	bool bench_batch_aligner(bench_options* options, bench_data* data, bench_timing* fill, bench_timing* traceback, bench_timing* format)
+
+	bench_batch_aligner() times a gqss_batch_aligner on 'options->thread_count' threads like bench_aligner() and the
+	formatting of the TSV rows of the alignments (written to /dev/null). The function returns false if an alignment failed.
+*/
+static bool bench_batch_aligner(bench_options* options, bench_data* data, bench_timing* fill, bench_timing* traceback, bench_timing* format) {
+	fill->name = "batch aligner fill";
+	fill->read_count = data->record_count;
+	fill->cell_count = data->cell_count;
+	fill->seconds = 0;
+	traceback->name = "batch aligner traceback";
+	traceback->read_count = data->record_count;
+	traceback->cell_count = 0;
+	traceback->seconds = 0;
+	format->name = "format";
+	format->read_count = data->record_count;
+	format->cell_count = 0;
+	format->seconds = 0;
+
+	//a single thread aligns on the calling thread, as in ednafull_linear_smith_waterman
+	gqss_thread_pool* pool = NULL;
+	if (options->thread_count > 1) {
+		pool = gqss_thread_pool_create(options->thread_count);
+		if (pool == NULL) {
+			printf("error: failed to start %zu worker threads!\n", options->thread_count);
+			return false;
+		}
+	}
+
+	gqss_aligner* aligner = gqss_aligner_create(data->query, strlen(data->query), get_nuc_4_4_value, BENCH_GAP_PENALTY);
+	gqss_batch_aligner* batch_aligner = (aligner != NULL) ? gqss_batch_aligner_create(aligner, pool) : NULL;
+	FILE* null_fd = fopen("/dev/null", "wb");
+
+	bool aligned = false;
+	if ((batch_aligner != NULL) && (null_fd != NULL)) {
+		aligned = align_bench_batches(data, batch_aligner, null_fd, fill, traceback, format);
+	}
+
+	if (null_fd != NULL) {
+		fclose(null_fd);
+	}
+	gqss_batch_aligner_destroy(batch_aligner);
+	gqss_aligner_destroy(aligner);
+	gqss_thread_pool_destroy(pool);
+	return aligned;
+}
+
+/*
+	bool run_bench(bench_options* options, bench_data* data, bench_timing* timings, size_t* timing_count)
+
+	run_bench() times every stage once and assigns the timings to 'timings' (at least BENCH_MAX_TIMINGS entries) and their
+	number to 'timing_count'. The function returns false if a stage failed.
+*/
+static bool run_bench(bench_options* options, bench_data* data, bench_timing* timings, size_t* timing_count) {
+	*timing_count = 0;
+	bool completed = bench_parse(data, &timings[*timing_count]);
+	*timing_count = *timing_count + 1;
+
+	data->cell_count = 0;
+	for (size_t i = 0; i < data->record_count; i++) {
+		data->cell_count = data->cell_count + ((uint64_t)options->query_length * data->records[i].sequence_length);
+	}
+
+	if (completed && (options->reference_read_count > 0)) {
+		completed = bench_reference(options, data, &timings[*timing_count], &timings[*timing_count + 1]);
+		*timing_count = *timing_count + 2;
+	}
+	if (completed) {
+		completed = bench_aligner(data, &timings[*timing_count], &timings[*timing_count + 1]);
+		*timing_count = *timing_count + 2;
+	}
+	if (completed) {
+		completed = bench_batch_aligner(options, data, &timings[*timing_count], &timings[*timing_count + 1], &timings[*timing_count + 2]);
+		*timing_count = *timing_count + 3;
+	}
+	return completed;
+}
+
+static double reads_per_second(bench_timing* timing) {
+	return (timing->seconds > 0) ? ((double)timing->read_count / timing->seconds) : 0;
+}
+
+static double gcups(bench_timing* timing) {
+	return (timing->seconds > 0) ? ((double)timing->cell_count / timing->seconds * 0.000000001) : 0;
+}
+
+static void print_timing(bench_timing* timing) {
+	printf("%-28s%10zu%12.3lf%14.0lf", timing->name, timing->read_count, timing->seconds, reads_per_second(timing));
+	if (timing->cell_count > 0) {
+		printf("%10.3lf", gcups(timing));
+	}
+	printf("\n");
+	return;
+}
+
+//peak resident set size of the process in kilobytes
+static long get_peak_rss(void) {
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+	return usage.ru_maxrss;
+}
+
+/*
+	bool write_bench_json(bench_options* options, bench_timing* timings, size_t timing_count, long peak_rss)
+
+	write_bench_json() writes the options, the timings and the peak resident set size of a benchmark to
+	'options->json_filename', one stage object per line so that the file can also be compared with diff. The function
+	returns false if the file could not be written.
+*/
+static bool write_bench_json(bench_options* options, bench_timing* timings, size_t timing_count, long peak_rss) {
+	FILE* json_fd = fopen(options->json_filename, "wb");
+	if (json_fd == NULL) {
+		return false;
+	}
+
+	fprintf(json_fd, "{\n");
+	fprintf(json_fd, "  \"time\": %lld,\n", (long long)time(NULL));
+	fprintf(json_fd, "  \"query_length\": %zu,\n", options->query_length);
+	fprintf(json_fd, "  \"reads\": %zu,\n", options->read_count);
+	fprintf(json_fd, "  \"read_length\": %zu,\n", options->read_length);
+	fprintf(json_fd, "  \"error_rate\": %.6lf,\n", options->error_rate);
+	fprintf(json_fd, "  \"indel_rate\": %.6lf,\n", options->indel_rate);
+	fprintf(json_fd, "  \"duplicate_rate\": %.6lf,\n", options->duplicate_rate);
+	fprintf(json_fd, "  \"seed\": %" PRIu64 ",\n", options->seed);
+	fprintf(json_fd, "  \"threads\": %zu,\n", options->thread_count);
+	fprintf(json_fd, "  \"repeat\": %zu,\n", options->repeat_count);
+	fprintf(json_fd, "  \"peak_rss_kb\": %ld,\n", peak_rss);
+	fprintf(json_fd, "  \"stages\": [\n");
+	for (size_t i = 0; i < timing_count; i++) {
+		fprintf(json_fd, "    {\"name\": \"%s\", \"reads\": %zu, \"cells\": %" PRIu64 ", \"seconds\": %.6lf, \"reads_per_second\": %.3lf, \"gcups\": %.6lf}%s\n",
+				timings[i].name, timings[i].read_count, timings[i].cell_count, timings[i].seconds, reads_per_second(&timings[i]),
+				gcups(&timings[i]), ((i + 1 < timing_count) ? "," : ""));
+	}
+	fprintf(json_fd, "  ]\n");
+	fprintf(json_fd, "}\n");
+
+	bool written = !ferror(json_fd);
+	return (fclose(json_fd) == 0) && written;
+}
+
+/*
+	bool find_json_number(char* object, const char* key, double* value)
+
+	find_json_number() assigns the number of the member 'key' of the JSON object starting at 'object' (up to its first '}',
+	the objects written by write_bench_json() are flat) to 'value'. The function returns false if the object has no such
+	number.
+*/
+static bool find_json_number(char* object, const char* key, double* value) {
+	char* object_end = strchr(object, '}');
+	size_t key_length = strlen(key);
+
+	for (char* member = strstr(object, key); (member != NULL) && ((object_end == NULL) || (member < object_end)); member = strstr(member + 1, key)) {
+		//the key is quoted and followed by a colon
+		if ((member > object) && (member[-1] == '"') && (member[key_length] == '"')) {
+			return (sscanf(member + key_length + 1, " : %lf", value) == 1);
+		}
+	}
+	return false;
+}
+
+/*
+	bool compare_result(const char* name, const char* unit, double result, double baseline, bool higher_is_better, double tolerance)
+
+	compare_result() prints a result next to its baseline and returns false if it is worse than the baseline by more than
+	'tolerance' (a fraction of the baseline).
+*/
+static bool compare_result(const char* name, const char* unit, double result, double baseline, bool higher_is_better, double tolerance) {
+	double change = (baseline > 0) ? ((result - baseline) / baseline) : 0;
+	bool regressed = higher_is_better ? (change < -tolerance) : (change > tolerance);
+
+	printf("%-28s%-14s%16.3lf%16.3lf%+9.1lf%%%s\n", name, unit, baseline, result, (change * 100), (regressed ? "  REGRESSION" : ""));
+	return !regressed;
+}
+
+/*
+	int compare_baseline(bench_options* options, bench_timing* timings, size_t timing_count, long peak_rss)
+
+	compare_baseline() compares the reads per second and GCUPS of every stage and the peak resident set size to the JSON
+	results of 'options->baseline_filename' (written by write_bench_json()). Stages missing from the baseline or faster than
+	BENCH_MIN_COMPARED_SECONDS in it are not compared. The function returns the exit status: 0 without regression, 1 on a
+	regression and 2 if the baseline could not be read.
+*/
+static int compare_baseline(bench_options* options, bench_timing* timings, size_t timing_count, long peak_rss) {
+	FILE* baseline_fd = fopen(options->baseline_filename, "rb");
+	if (baseline_fd == NULL) {
+		perror("compare_baseline(): fopen(): error");
+		return 2;
+	}
+
+	fseek(baseline_fd, 0, SEEK_END);
+	long baseline_length = ftell(baseline_fd);
+	fseek(baseline_fd, 0, SEEK_SET);
+
+	char* baseline = (baseline_length >= 0) ? (char *)malloc(((size_t)baseline_length + 1) * sizeof(char)) : NULL;
+	if ((baseline == NULL) || (fread(baseline, sizeof(char), (size_t)baseline_length, baseline_fd) != (size_t)baseline_length)) {
+		perror("compare_baseline(): failed to read the baseline");
+		free(baseline);
+		fclose(baseline_fd);
+		return 2;
+	}
+	baseline[baseline_length] = '\0';
+	fclose(baseline_fd);
+
+	char* stages = strstr(baseline, "\"stages\"");
+	if (stages == NULL) {
+		printf("error: \"%s\" has no benchmark stages!\n", options->baseline_filename);
+		free(baseline);
+		return 2;
+	}
+
+	printf("\nCompared to \"%s\" (tolerance %.1lf%%)\n\n", options->baseline_filename, (options->tolerance * 100));
+	printf("%-28s%-14s%16s%16s%10s\n", "Stage", "Result", "Baseline", "Current", "Change");
+
+	bool passed = true;
+	char name_member[64];
+	for (size_t i = 0; i < timing_count; i++) {
+		snprintf(name_member, sizeof(name_member), "\"name\": \"%s\"", timings[i].name);
+
+		double baseline_seconds;
+		double baseline_value;
+		char* stage = strstr(stages, name_member);
+		if ((stage == NULL) || (!find_json_number(stage, "seconds", &baseline_seconds)) || (baseline_seconds < BENCH_MIN_COMPARED_SECONDS)) {
+			continue;
+		}
+
+		if (find_json_number(stage, "reads_per_second", &baseline_value)) {
+			passed = compare_result(timings[i].name, "reads/second", reads_per_second(&timings[i]), baseline_value, true, options->tolerance) && passed;
+		}
+		if ((timings[i].cell_count > 0) && find_json_number(stage, "gcups", &baseline_value)) {
+			passed = compare_result(timings[i].name, "GCUPS", gcups(&timings[i]), baseline_value, true, options->tolerance) && passed;
+		}
+	}
+
+	double baseline_rss;
+	if (find_json_number(baseline, "peak_rss_kb", &baseline_rss)) {
+		passed = compare_result("peak resident set size", "kilobytes", (double)peak_rss, baseline_rss, false, options->tolerance) && passed;
+	}
+
+	free(baseline);
+
+	if (!passed) {
+		printf("\nerror: performance regression beyond the tolerance of %.1lf%%!\n", (options->tolerance * 100));
+		return 1;
+	}
+	return 0;
+}
+
+/*
+	int parse_bench_options(int argc, char* argv[], bench_options* options)
+
+	parse_bench_options() parses the application's given arguments. The function returns 0 when no problems were
+	encountered during parsing and 1 on failure.
+*/
+static int parse_bench_options(int argc, char* argv[], bench_options* options) {
+	int getopt_index = 0;
+	int c;
+
+	options->query_length = 1000;
+	options->read_count = 10000;
+	options->read_length = 150;
+	options->error_rate = 0.01;
+	options->indel_rate = 0.001;
+	options->duplicate_rate = 0.1;
+	options->seed = 1;
+	options->reference_read_count = 200;
+	options->repeat_count = 1;
+	options->json_filename = NULL;
+	options->baseline_filename = NULL;
+	options->tolerance = 0.2;
+	options->thread_count = 1;
+	options->generate_prefix = NULL;
+
+	while ((c = getopt_long(argc, argv, "t:h", getopt_long_options, &getopt_index)) != -1) {
+		bool parsed = true;
+		switch (c) {
+			case 0:
+				if (strcmp(getopt_long_options[getopt_index].name, "query-length") == 0) {
+					parsed = (sscanf(optarg, "%zu", &options->query_length) == 1) && (options->query_length > 0);
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "reads") == 0) {
+					parsed = (sscanf(optarg, "%zu", &options->read_count) == 1) && (options->read_count > 0);
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "read-length") == 0) {
+					parsed = (sscanf(optarg, "%zu", &options->read_length) == 1) && (options->read_length > 0);
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "error-rate") == 0) {
+					parsed = (sscanf(optarg, "%lf", &options->error_rate) == 1) && (options->error_rate >= 0) && (options->error_rate <= 1);
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "indel-rate") == 0) {
+					parsed = (sscanf(optarg, "%lf", &options->indel_rate) == 1) && (options->indel_rate >= 0) && (options->indel_rate <= 1);
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "duplicate-rate") == 0) {
+					parsed = (sscanf(optarg, "%lf", &options->duplicate_rate) == 1) && (options->duplicate_rate >= 0) && (options->duplicate_rate <= 1);
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "seed") == 0) {
+					parsed = (sscanf(optarg, "%" SCNu64, &options->seed) == 1);
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "reference-reads") == 0) {
+					parsed = (sscanf(optarg, "%zu", &options->reference_read_count) == 1);
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "repeat") == 0) {
+					parsed = (sscanf(optarg, "%zu", &options->repeat_count) == 1) && (options->repeat_count > 0);
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "json") == 0) {
+					options->json_filename = optarg;
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "baseline") == 0) {
+					options->baseline_filename = optarg;
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "tolerance") == 0) {
+					parsed = (sscanf(optarg, "%lf", &options->tolerance) == 1) && (options->tolerance >= 0);
+				}
+				if (!parsed) {
+					printf("bench_linear_gap_smith_waterman: option --%s: invalid value '%s'.\n", getopt_long_options[getopt_index].name, optarg);
+				}
+				break;
+			case 't':
+				parsed = (sscanf(optarg, "%zu", &options->thread_count) == 1) && (options->thread_count > 0);
+				if (!parsed) {
+					printf("bench_linear_gap_smith_waterman: option -t, --threads: expected a positive integer.\n");
+				}
+				break;
+			case 'h':
+				printf("%s", help_message);
+				exit(0);
+			default:
+				parsed = false;
+				break;
+		}
+
+		if (!parsed) {
+			printf("Try 'bench_linear_gap_smith_waterman --help' for more information.\n");
+			return 1;
+		}
+	}
+
+	if ((options->error_rate + options->indel_rate) > 1) {
+		printf("bench_linear_gap_smith_waterman: the error and indel rates add up to more than 1.\n");
+		return 1;
+	}
+
+	if ((optind < argc) && (strcmp(argv[optind], "generate") == 0)) {
+		if (optind + 2 != argc) {
+			printf("bench_linear_gap_smith_waterman: generate: expected a single file name PREFIX.\n");
+			printf("Try 'bench_linear_gap_smith_waterman --help' for more information.\n");
+			return 1;
+		}
+		options->generate_prefix = argv[optind + 1];
+	}
+	else if (optind < argc) {
+		printf("bench_linear_gap_smith_waterman: unexpected argument '%s'.\n", argv[optind]);
+		printf("Try 'bench_linear_gap_smith_waterman --help' for more information.\n");
+		return 1;
+	}
+	return 0;
+}
+
+static int compare_seconds(const void* a, const void* b) {
+	double first = *(const double *)a;
+	double second = *(const double *)b;
+	return (first > second) - (first < second);
+}
+
+//median of the 'count' seconds at 'seconds', which are sorted in place
+static double get_median_seconds(double* seconds, size_t count) {
+	qsort(seconds, count, sizeof(double), compare_seconds);
+	if ((count % 2) == 0) {
+		return (seconds[count / 2 - 1] + seconds[count / 2]) / 2;
+	}
+	return seconds[count / 2];
+}
+
+int main(int argc, char* argv[]) {
+	bench_options options;
+	bench_data data;
+
+	if (parse_bench_options(argc, argv, &options) != 0) {
+		return 1;
+	}
+
+	if (!generate_bench_data(&options, &data)) {
+		free_bench_data(&data);
+		return 1;
+	}
+
+	if (options.generate_prefix != NULL) {
+		int status = write_generated_files(&options, &data);
+		free_bench_data(&data);
+		return status;
+	}
+
+	bench_timing timings[BENCH_MAX_TIMINGS];
+	bench_timing repetition[BENCH_MAX_TIMINGS];
+	size_t timing_count = 0;
+
+	//the seconds of stage 'j' in repetition 'i' are at 'repetition_seconds[j * repeat_count + i]'
+	double* repetition_seconds = (double *)malloc((options.repeat_count * BENCH_MAX_TIMINGS) * sizeof(double));
+	if (repetition_seconds == NULL) {
+		perror("main(): malloc(): error");
+		free_bench_data(&data);
+		return 1;
+	}
+
+	bool completed = true;
+	for (size_t i = 0; completed && (i < options.repeat_count); i++) {
+		bench_timing* run_timings = (i == 0) ? timings : repetition;
+		completed = run_bench(&options, &data, run_timings, &timing_count);
+		for (size_t j = 0; completed && (j < timing_count); j++) {
+			repetition_seconds[j * options.repeat_count + i] = run_timings[j].seconds;
+		}
+	}
+
+	//the median repetition of each stage is not moved by a few repetitions disturbed by the rest of the system
+	for (size_t j = 0; completed && (j < timing_count); j++) {
+		timings[j].seconds = get_median_seconds(&repetition_seconds[j * options.repeat_count], options.repeat_count);
+	}
+	free(repetition_seconds);
+
+	if (!completed) {
+		printf("error: the benchmark failed!\n");
+		free_bench_data(&data);
+		return 1;
+	}
+
+	printf("Query length %zu, %zu reads of length %zu, error rate %.4lf, indel rate %.4lf, duplicate rate %.2lf, seed %" PRIu64 ", %zu threads\n\n",
+			options.query_length, data.record_count, options.read_length, options.error_rate, options.indel_rate, options.duplicate_rate,
+			options.seed, options.thread_count);
+	printf("%-28s%10s%12s%14s%10s\n", "Stage", "Reads", "Seconds", "Reads/Second", "GCUPS");
+	for (size_t i = 0; i < timing_count; i++) {
+		print_timing(&timings[i]);
+	}
+
+	long peak_rss = get_peak_rss();
+	printf("\nPeak resident set size: %ld kilobytes\n", peak_rss);
+
+	free_bench_data(&data);
+
+	if (options.json_filename != NULL) {
+		if (!write_bench_json(&options, timings, timing_count, peak_rss)) {
+			perror("main(): failed to write the JSON results");
+			return 2;
+		}
+		printf("Results written to \"%s\"\n", options.json_filename);
+	}
+
+	if (options.baseline_filename != NULL) {
+		return compare_baseline(&options, timings, timing_count, peak_rss);
+	}
+	return 0;
+}
@@ -0,0 +1,772 @@
+/* Differential check of the Smith-Waterman linear gap penalty kernels against
+ * the reference linear_gap_smith_waterman() and trace_linear_gap_smith_waterman().
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "gqss.h"
+
+//number of reads aligned against the query of a case
+#define CHECK_CASE_READS 16
+
+#define CHECK_KERNEL_COUNT 7
+
+//number of sequences printed in full in a mismatch report
+#define CHECK_PRINT_LENGTH 120
+
+static struct option getopt_long_options[] = {
+	{"pairs", required_argument, NULL, 0},
+	{"max-length", required_argument, NULL, 0},
+	{"seed", required_argument, NULL, 0},
+	{"max-reports", required_argument, NULL, 0},
+	{"threads", required_argument, NULL, 't'},
+	{"help", no_argument, NULL, 'h'},
+	{NULL, 0, NULL, 0}
+};
+
+static const char* help_message =
+	"Usage: check_linear_gap_smith_waterman [OPTION]...\n"
+	"Align random and adversarial query and read pairs with every alignment kernel and\n"
+	"report the scores, coordinates and alignment strings that differ from the reference\n"
+	"linear_gap_smith_waterman() and trace_linear_gap_smith_waterman(). The exit status\n"
+	"is 1 if any kernel differs from the reference.\n"
+	"\n"
+	"  --pairs=INT                 number of query and read pairs (default value is\n"
+	"                              4096)\n"
+	"  --max-length=INT            maximum length of the queries and reads (default\n"
+	"                              value is 200)\n"
+	"  --seed=INT                  seed of the generator (default value is 1)\n"
+	"  --max-reports=INT           number of mismatches printed in full (default value\n"
+	"                              is 10)\n"
+	"  -t, --threads=INT           number of threads of the threaded batch aligner\n"
+	"                              (default value is 4)\n"
+	"  -h, --help                  print this help message and exit\n";
+
+typedef struct check_options {
+	size_t pair_count;
+	size_t max_length;
+	uint64_t seed;
+	size_t max_report_count;
+	size_t thread_count;
+} check_options;
+
+/*
+	check_kind is the shape of the sequences of a case, the kinds are generated in turn so that every kind is checked by
+	a run of CHECK_KIND_COUNT cases or more.
+*/
+typedef enum check_kind {
+	CHECK_RANDOM,
+	CHECK_RELATED,
+	CHECK_AMBIGUOUS,
+	CHECK_SINGLE_BASE,
+	CHECK_ALL_N,
+	CHECK_HOMOPOLYMER,
+	CHECK_TANDEM_REPEAT,
+	CHECK_EMPTY_READ,
+	CHECK_ZERO_GAP,
+	CHECK_LARGE_SCORES,
+	CHECK_KIND_COUNT
+} check_kind;
+
+static const char* check_kind_names[CHECK_KIND_COUNT] = {
+	"random", "related", "ambiguous bases", "single base", "all N", "homopolymer", "tandem repeat", "empty read",
+	"zero gap penalty", "large scores"
+};
+
+/*
+	check_result is an alignment of a kernel, 'aligned' is false if the kernel found no alignment (a read of length 0). The
+	alignment strings are owned by the kernel.
+*/
+typedef struct check_result {
+	bool aligned;
+	int64_t score;
+	size_t query_start;
+	size_t query_stop;
+	size_t read_start;
+	size_t read_stop;
+	char* query_alignment;
+	char* read_alignment;
+} check_result;
+
+/*
+	check_case is a query and its 'read_count' reads, stored null terminated in 'reads' at 'read_offsets', with the
+	scoring of the case and the 'expected' alignments of the reference.
+*/
+typedef struct check_case {
+	check_kind kind;
+	char* query;
+	size_t query_length;
+	char* reads;
+	size_t read_offsets[CHECK_CASE_READS];
+	size_t read_lengths[CHECK_CASE_READS];
+	size_t read_count;
+	int64_t (*get_substitution_matrix_value)(char a, char b);
+	int64_t gap_penalty;
+	check_result expected[CHECK_CASE_READS];
+	char* expected_alignments;
+} check_case;
+
+/*
+	check_kernel is the time spent by an alignment kernel on 'pair_count' pairs of 'cell_count' scoring matrix cells and
+	the number of pairs aligned differently from the reference.
+*/
+typedef struct check_kernel {
+	const char* name;
+	size_t pair_count;
+	uint64_t cell_count;
+	double seconds;
+	size_t mismatch_count;
+} check_kernel;
+
+/*
+	Scale of the substitution scores and gap penalty of the CHECK_LARGE_SCORES cases, chosen so that the best score of the
+	longest pairs is close to INT64_MAX.
+*/
+static int64_t score_scale = 1;
+
+static size_t reported_mismatch_count = 0;
+
+//SplitMix64 generator, the same seed always generates the same pairs
+static uint64_t next_random(uint64_t* state) {
+	*state = (*state) + UINT64_C(0x9e3779b97f4a7c15);
+
+	uint64_t value = *state;
+	value = (value ^ (value >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+	value = (value ^ (value >> 27)) * UINT64_C(0x94d049bb133111eb);
+	return value ^ (value >> 31);
+}
+
+//uniformly distributed value in [minimum, maximum]
+static size_t next_length(uint64_t* state, size_t minimum, size_t maximum) {
+	return minimum + (size_t)(next_random(state) % (maximum - minimum + 1));
+}
+
+static char next_base(uint64_t* state) {
+	return "ACGT"[next_random(state) & 3];
+}
+
+static double elapsed_seconds(struct timespec* start_time) {
+	struct timespec end_time;
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+	return (double)(end_time.tv_sec - start_time->tv_sec) + ((double)(end_time.tv_nsec - start_time->tv_nsec) * 0.000000001);
+}
+
+//EDNAFULL substitution scores multiplied by 'score_scale'
+static int64_t get_scaled_nuc_4_4_value(char a, char b) {
+	return get_nuc_4_4_value(a, b) * score_scale;
+}
+
+/*
+	void generate_sequence(check_kind kind, uint64_t* state, char* sequence, size_t length, char homopolymer_base)
+
+	generate_sequence() writes 'length' characters of the shape of 'kind' to 'sequence', 'homopolymer_base' is the base of the
+	runs of a CHECK_HOMOPOLYMER sequence (and the first base of the repeated unit of a CHECK_TANDEM_REPEAT sequence).
+*/
+static void generate_sequence(check_kind kind, uint64_t* state, char* sequence, size_t length, char homopolymer_base) {
+	//IUPAC ambiguity codes, lowercase bases and a character outside of the substitution matrix
+	static const char* ambiguous_bases = "ACGTNRYKMSWBDHVacgtn*";
+	char unit[4];
+	size_t unit_length = next_length(state, 2, 4);
+
+	unit[0] = homopolymer_base;
+	for (size_t i = 1; i < unit_length; i++) {
+		unit[i] = next_base(state);
+	}
+
+	for (size_t i = 0; i < length; i++) {
+		switch (kind) {
+			case CHECK_AMBIGUOUS:
+				sequence[i] = ambiguous_bases[next_random(state) % strlen(ambiguous_bases)];
+				break;
+			case CHECK_ALL_N:
+				sequence[i] = 'N';
+				break;
+			case CHECK_HOMOPOLYMER:
+				//a few other bases break the runs
+				sequence[i] = ((next_random(state) % 32) == 0) ? next_base(state) : homopolymer_base;
+				break;
+			case CHECK_TANDEM_REPEAT:
+				sequence[i] = unit[i % unit_length];
+				break;
+			default:
+				sequence[i] = next_base(state);
+				break;
+		}
+	}
+	sequence[length] = '\0';
+	return;
+}
+
+/*
+	size_t mutate_window(uint64_t* state, char* query, size_t query_length, char* read, size_t max_length)
+
+	mutate_window() writes a random window of 'query' with 5% substitutions and 2% insertions and deletions to 'read', at
+	most 'max_length' characters. The function returns the length of the read.
+*/
+static size_t mutate_window(uint64_t* state, char* query, size_t query_length, char* read, size_t max_length) {
+	size_t start = next_length(state, 0, query_length - 1);
+	size_t stop = next_length(state, start, query_length - 1);
+	size_t length = 0;
+
+	for (size_t i = start; (i <= stop) && (length < max_length); i++) {
+		uint64_t event = next_random(state) % 100;
+		if (event < 5) {
+			read[length] = next_base(state);
+			length++;
+		}
+		else if (event < 6) {
+			//deletion
+			continue;
+		}
+		else if (event < 7) {
+			read[length] = next_base(state);
+			length++;
+			if (length < max_length) {
+				read[length] = query[i];
+				length++;
+			}
+		}
+		else {
+			read[length] = query[i];
+			length++;
+		}
+	}
+
+	//a read deleted entirely keeps the first base of its window
+	if (length == 0) {
+		read[0] = query[start];
+		length = 1;
+	}
+	read[length] = '\0';
+	return length;
+}
+
+/*
+	void generate_case(check_options* options, uint64_t* state, check_kind kind, check_case* pairs)
+
+	generate_case() generates the query and reads of a case of 'kind' into the buffers of 'pairs', allocated for sequences
+	of 'options->max_length' characters.
+*/
+static void generate_case(check_options* options, uint64_t* state, check_kind kind, check_case* pairs) {
+	static const int64_t gap_penalties[] = {16, 16, 16, 1, 5, 100};
+	char homopolymer_base = next_base(state);
+
+	pairs->kind = kind;
+	pairs->get_substitution_matrix_value = get_nuc_4_4_value;
+	pairs->gap_penalty = gap_penalties[next_random(state) % (sizeof(gap_penalties) / sizeof(gap_penalties[0]))];
+	if (kind == CHECK_ZERO_GAP) {
+		pairs->gap_penalty = 0;
+	}
+	else if (kind == CHECK_LARGE_SCORES) {
+		pairs->get_substitution_matrix_value = get_scaled_nuc_4_4_value;
+		pairs->gap_penalty = 16 * score_scale;
+	}
+
+	//the homopolymers and the all N sequences are as long as possible
+	bool longest = (kind == CHECK_HOMOPOLYMER) || (kind == CHECK_ALL_N) || (kind == CHECK_LARGE_SCORES);
+	pairs->query_length = longest ? options->max_length : next_length(state, 1, options->max_length);
+	if ((kind == CHECK_SINGLE_BASE) && ((next_random(state) & 1) == 0)) {
+		pairs->query_length = 1;
+	}
+	generate_sequence(kind, state, pairs->query, pairs->query_length, homopolymer_base);
+
+	size_t offset = 0;
+	pairs->read_count = CHECK_CASE_READS;
+	for (size_t i = 0; i < pairs->read_count; i++) {
+		char* read = pairs->reads + offset;
+		size_t read_length;
+
+		switch (kind) {
+			case CHECK_RELATED:
+			case CHECK_TANDEM_REPEAT:
+			case CHECK_ZERO_GAP:
+			case CHECK_LARGE_SCORES:
+				read_length = mutate_window(state, pairs->query, pairs->query_length, read, options->max_length);
+				break;
+			case CHECK_SINGLE_BASE:
+				read_length = (pairs->query_length == 1) ? next_length(state, 1, options->max_length) : 1;
+				generate_sequence(CHECK_RANDOM, state, read, read_length, homopolymer_base);
+				break;
+			case CHECK_EMPTY_READ:
+				//every other read is empty
+				read_length = ((i & 1) == 0) ? 0 : next_length(state, 1, options->max_length);
+				generate_sequence(CHECK_RANDOM, state, read, read_length, homopolymer_base);
+				break;
+			case CHECK_ALL_N:
+				//half of the reads are not all N
+				read_length = next_length(state, 1, options->max_length);
+				generate_sequence(((i & 1) == 0) ? CHECK_ALL_N : CHECK_AMBIGUOUS, state, read, read_length, homopolymer_base);
+				break;
+			default:
+				read_length = next_length(state, 1, options->max_length);
+				generate_sequence(kind, state, read, read_length, homopolymer_base);
+				break;
+		}
+
+		pairs->read_offsets[i] = offset;
+		pairs->read_lengths[i] = read_length;
+		offset = offset + read_length + 1;
+	}
+	return;
+}
+
+/*
+	void align_reference(check_case* pairs, int64_t* scores, check_kernel* kernel)
+
+	align_reference() assigns the alignments of linear_gap_smith_waterman(), best_linear_gap_smith_waterman_score_indices() and
+	trace_linear_gap_smith_waterman() to 'pairs->expected', a read of length 0 has no alignment. 'scores' has room for the
+	scoring matrix of the longest pair.
+*/
+static void align_reference(check_case* pairs, int64_t* scores, check_kernel* kernel) {
+	struct timespec start_time;
+	size_t alignment_offset = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+	for (size_t i = 0; i < pairs->read_count; i++) {
+		check_result* expected = &(pairs->expected[i]);
+		char* read = pairs->reads + pairs->read_offsets[i];
+		size_t x;
+		size_t y;
+
+		memset(expected, 0, sizeof(check_result));
+		if (pairs->read_lengths[i] == 0) {
+			continue;
+		}
+
+		linear_gap_smith_waterman(pairs->query, read, scores, pairs->get_substitution_matrix_value, pairs->gap_penalty);
+		expected->aligned = best_linear_gap_smith_waterman_score_indices(pairs->query_length, pairs->read_lengths[i], scores, &x, &y);
+		expected->score = scores[(x * pairs->read_lengths[i]) + y];
+		expected->query_stop = x;
+		expected->read_stop = y;
+
+		//the alignment strings of the reads follow each other, each as long as the query and read together
+		expected->query_alignment = pairs->expected_alignments + alignment_offset;
+		expected->read_alignment = expected->query_alignment + pairs->query_length + pairs->read_lengths[i] + 1;
+		alignment_offset = alignment_offset + (2 * (pairs->query_length + pairs->read_lengths[i] + 1));
+
+		trace_linear_gap_smith_waterman(pairs->query, read, scores, expected->query_alignment, expected->read_alignment, &x, &y,
+						pairs->get_substitution_matrix_value, pairs->gap_penalty);
+		expected->query_start = x;
+		expected->read_start = y;
+
+		kernel->cell_count = kernel->cell_count + ((uint64_t)pairs->query_length * pairs->read_lengths[i]);
+	}
+	kernel->seconds = kernel->seconds + elapsed_seconds(&start_time);
+	kernel->pair_count = kernel->pair_count + pairs->read_count;
+	return;
+}
+
+static void print_sequence(const char* name, char* sequence, size_t length) {
+	if (length <= CHECK_PRINT_LENGTH) {
+		printf("  %-16s%s\n", name, sequence);
+	}
+	else {
+		printf("  %-16s%.*s... (%zu characters)\n", name, CHECK_PRINT_LENGTH, sequence, length);
+	}
+	return;
+}
+
+static void print_result(const char* name, check_result* result) {
+	if (!result->aligned) {
+		printf("  %-16sno alignment\n", name);
+		return;
+	}
+	printf("  %-16sscore %" PRId64 ", query %zu-%zu, read %zu-%zu\n", name, result->score, result->query_start, result->query_stop,
+			result->read_start, result->read_stop);
+	//no alignment strings without a traceback
+	if (result->query_alignment[0] != '\0') {
+		print_sequence("", result->query_alignment, strlen(result->query_alignment));
+		print_sequence("", result->read_alignment, strlen(result->read_alignment));
+	}
+	return;
+}
+
+/*
+	void compare_result(check_options* options, check_case* pairs, size_t read_index, check_result* result, bool traced, check_kernel* kernel)
+
+	compare_result() counts a mismatch of 'kernel' if 'result' differs from the expected alignment of read 'read_index' and
+	prints the first 'options->max_report_count' mismatches. The alignment of a kernel that did not trace back ('traced' is
+	false) is expected to have the best score, its stop indices as start indices and empty alignment strings.
+*/
+static void compare_result(check_options* options, check_case* pairs, size_t read_index, check_result* result, bool traced, check_kernel* kernel) {
+	check_result expected = pairs->expected[read_index];
+	if (expected.aligned && (!traced)) {
+		expected.query_start = expected.query_stop;
+		expected.read_start = expected.read_stop;
+		expected.query_alignment = "";
+		expected.read_alignment = "";
+	}
+
+	bool matched = (result->aligned == expected.aligned);
+	if (matched && expected.aligned) {
+		matched = (result->score == expected.score)
+				&& (result->query_start == expected.query_start) && (result->query_stop == expected.query_stop)
+				&& (result->read_start == expected.read_start) && (result->read_stop == expected.read_stop)
+				&& (strcmp(result->query_alignment, expected.query_alignment) == 0)
+				&& (strcmp(result->read_alignment, expected.read_alignment) == 0);
+	}
+	if (matched) {
+		return;
+	}
+
+	kernel->mismatch_count++;
+	if (reported_mismatch_count >= options->max_report_count) {
+		return;
+	}
+	reported_mismatch_count++;
+
+	printf("Mismatch of %s (%s case, gap penalty %" PRId64 ", read %zu):\n", kernel->name, check_kind_names[pairs->kind], pairs->gap_penalty, read_index);
+	print_sequence("query", pairs->query, pairs->query_length);
+	print_sequence("read", (pairs->reads + pairs->read_offsets[read_index]), pairs->read_lengths[read_index]);
+	print_result("expected", &expected);
+	print_result("found", result);
+	printf("\n");
+	return;
+}
+
+/*
+	bool check_aligner(check_options* options, check_case* pairs, gqss_aligner* aligner, int64_t traceback_cutoff, check_kernel* kernel)
+
+	check_aligner() aligns the reads of 'pairs' with 'aligner' and compares the alignments to the reference. The function
+	returns false if memory could not be allocated.
+*/
+static bool check_aligner(check_options* options, check_case* pairs, gqss_aligner* aligner, int64_t traceback_cutoff, check_kernel* kernel) {
+	gqss_alignment_result alignment;
+	check_result result;
+	struct timespec start_time;
+
+	for (size_t i = 0; i < pairs->read_count; i++) {
+		char* read = pairs->reads + pairs->read_offsets[i];
+
+		clock_gettime(CLOCK_MONOTONIC, &start_time);
+		if (traceback_cutoff == INT64_MIN) {
+			result.aligned = gqss_aligner_align(aligner, read, pairs->read_lengths[i], &alignment);
+		}
+		else {
+			result.aligned = gqss_aligner_align_cutoff(aligner, read, pairs->read_lengths[i], traceback_cutoff, &alignment);
+		}
+		kernel->seconds = kernel->seconds + elapsed_seconds(&start_time);
+
+		if ((!result.aligned) && (pairs->read_lengths[i] > 0)) {
+			return false;
+		}
+		if (result.aligned) {
+			result.score = alignment.score;
+			result.query_start = alignment.query_start;
+			result.query_stop = alignment.query_stop;
+			result.read_start = alignment.read_start;
+			result.read_stop = alignment.read_stop;
+			result.query_alignment = alignment.query_alignment;
+			result.read_alignment = alignment.read_alignment;
+		}
+		compare_result(options, pairs, i, &result, (traceback_cutoff != INT64_MAX), kernel);
+		kernel->cell_count = kernel->cell_count + ((uint64_t)pairs->query_length * pairs->read_lengths[i]);
+	}
+	kernel->pair_count = kernel->pair_count + pairs->read_count;
+	return true;
+}
+
+/*
+	bool check_batch_aligner(check_options* options, check_case* pairs, gqss_batch_aligner* batch_aligner, int64_t traceback_cutoff, gqss_batch_result* results, check_kernel* kernel)
+
+	check_batch_aligner() aligns the reads of 'pairs' as a single batch of 'batch_aligner' and compares the alignments to the
+	reference, a read of length 0 is expected to have a score of -1. The function returns false if an alignment failed.
+*/
+static bool check_batch_aligner(check_options* options, check_case* pairs, gqss_batch_aligner* batch_aligner, int64_t traceback_cutoff, gqss_batch_result* results, check_kernel* kernel) {
+	check_result result;
+	struct timespec start_time;
+
+	bool aligned;
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+	if (traceback_cutoff == INT64_MIN) {
+		aligned = gqss_batch_aligner_align(batch_aligner, pairs->reads, pairs->read_offsets, pairs->read_lengths, pairs->read_count, results);
+	}
+	else {
+		aligned = gqss_batch_aligner_align_cutoff(batch_aligner, pairs->reads, pairs->read_offsets, pairs->read_lengths, pairs->read_count, traceback_cutoff, results);
+	}
+	kernel->seconds = kernel->seconds + elapsed_seconds(&start_time);
+	if (!aligned) {
+		return false;
+	}
+
+	for (size_t i = 0; i < pairs->read_count; i++) {
+		result.aligned = (pairs->read_lengths[i] > 0);
+		result.score = results->scores[i];
+		result.query_start = results->query_starts[i];
+		result.query_stop = results->query_stops[i];
+		result.read_start = results->read_starts[i];
+		result.read_stop = results->read_stops[i];
+		result.query_alignment = results->query_alignments + results->alignment_offsets[i];
+		result.read_alignment = results->read_alignments + results->alignment_offsets[i];
+
+		//a read of length 0 has no alignment, but a score and alignment strings all the same
+		if ((!result.aligned) && ((result.score != -1) || (result.query_alignment[0] != '\0') || (result.read_alignment[0] != '\0'))) {
+			result.aligned = true;
+		}
+		compare_result(options, pairs, i, &result, (traceback_cutoff != INT64_MAX), kernel);
+		kernel->cell_count = kernel->cell_count + ((uint64_t)pairs->query_length * pairs->read_lengths[i]);
+	}
+	kernel->pair_count = kernel->pair_count + pairs->read_count;
+	return true;
+}
+
+static void free_shared_profile(int64_t** profile) {
+	if (profile != NULL) {
+		for (size_t c = 0; c < 256; c++) {
+			free(profile[c]);
+		}
+	}
+	free(profile);
+	return;
+}
+
+/*
+	int64_t** create_shared_profile(check_case* pairs)
+
+	create_shared_profile() returns the query profile rows of every character of the substitution matrix, like the rows of a
+	gqss_query_index, for gqss_aligner_create_with_profile(). The function returns a NULL pointer if memory could not be
+	allocated.
+*/
+static int64_t** create_shared_profile(check_case* pairs) {
+	int64_t** profile = (int64_t **)calloc(256, sizeof(int64_t *));
+	if (profile == NULL) {
+		return NULL;
+	}
+
+	//characters from 90 have no substitution value, their rows are left to the aligner
+	for (size_t c = 0; c < 90; c++) {
+		profile[c] = (int64_t *)malloc(pairs->query_length * sizeof(int64_t));
+		if (profile[c] == NULL) {
+			free_shared_profile(profile);
+			return NULL;
+		}
+		for (size_t i = 0; i < pairs->query_length; i++) {
+			profile[c][i] = pairs->get_substitution_matrix_value(pairs->query[i], (char)c);
+		}
+	}
+	return profile;
+}
+
+/*
+	bool check_case_kernels(check_options* options, check_case* pairs, gqss_thread_pool* pool, gqss_batch_result* results, check_kernel* kernels)
+
+	check_case_kernels() aligns the reads of 'pairs' with every kernel after the reference 'kernels[0]'. The function returns
+	false if memory could not be allocated or an alignment failed.
+*/
+static bool check_case_kernels(check_options* options, check_case* pairs, gqss_thread_pool* pool, gqss_batch_result* results, check_kernel* kernels) {
+	int64_t** shared_profile = create_shared_profile(pairs);
+	gqss_aligner* aligner = gqss_aligner_create(pairs->query, pairs->query_length, pairs->get_substitution_matrix_value, pairs->gap_penalty);
+	gqss_aligner* profile_aligner = NULL;
+	gqss_batch_aligner* batch_aligner = NULL;
+	gqss_batch_aligner* threaded_batch_aligner = NULL;
+
+	if (shared_profile != NULL) {
+		profile_aligner = gqss_aligner_create_with_profile(pairs->query, pairs->query_length, pairs->get_substitution_matrix_value, pairs->gap_penalty, shared_profile);
+	}
+	if (aligner != NULL) {
+		batch_aligner = gqss_batch_aligner_create(aligner, NULL);
+		threaded_batch_aligner = gqss_batch_aligner_create(aligner, pool);
+	}
+
+	bool checked = (profile_aligner != NULL) && (batch_aligner != NULL) && (threaded_batch_aligner != NULL);
+	checked = checked && check_aligner(options, pairs, aligner, INT64_MIN, &kernels[1]);
+	checked = checked && check_aligner(options, pairs, aligner, INT64_MAX, &kernels[2]);
+	checked = checked && check_aligner(options, pairs, profile_aligner, INT64_MIN, &kernels[3]);
+	checked = checked && check_batch_aligner(options, pairs, batch_aligner, INT64_MIN, results, &kernels[4]);
+	checked = checked && check_batch_aligner(options, pairs, batch_aligner, INT64_MAX, results, &kernels[5]);
+	checked = checked && check_batch_aligner(options, pairs, threaded_batch_aligner, INT64_MIN, results, &kernels[6]);
+
+	gqss_batch_aligner_destroy(threaded_batch_aligner);
+	gqss_batch_aligner_destroy(batch_aligner);
+	gqss_aligner_destroy(profile_aligner);
+	gqss_aligner_destroy(aligner);
+	free_shared_profile(shared_profile);
+	return checked;
+}
+
+/*
+	bool check_kernels(check_options* options, check_kernel* kernels)
+
+	check_kernels() generates the cases of 'options->pair_count' pairs and checks every kernel of 'kernels' against the
+	reference. The function returns false if memory could not be allocated or an alignment failed.
+*/
+static bool check_kernels(check_options* options, check_kernel* kernels) {
+	check_case pairs;
+	gqss_batch_result results;
+	uint64_t state = options->seed;
+
+	size_t max_length = options->max_length;
+	pairs.query = (char *)malloc((max_length + 1) * sizeof(char));
+	pairs.reads = (char *)malloc(CHECK_CASE_READS * (max_length + 1) * sizeof(char));
+	pairs.expected_alignments = (char *)malloc(CHECK_CASE_READS * 2 * ((2 * max_length) + 1) * sizeof(char));
+	int64_t* scores = (int64_t *)malloc(max_length * max_length * sizeof(int64_t));
+	gqss_thread_pool* pool = gqss_thread_pool_create(options->thread_count);
+	gqss_batch_result_init(&results);
+
+	bool checked = (pairs.query != NULL) && (pairs.reads != NULL) && (pairs.expected_alignments != NULL) && (scores != NULL) && (pool != NULL);
+	if (!checked) {
+		perror("check_kernels(): failed to allocate the pairs");
+	}
+
+	size_t case_count = (options->pair_count + CHECK_CASE_READS - 1) / CHECK_CASE_READS;
+	for (size_t i = 0; checked && (i < case_count); i++) {
+		generate_case(options, &state, (check_kind)(i % CHECK_KIND_COUNT), &pairs);
+		align_reference(&pairs, scores, &kernels[0]);
+		checked = check_case_kernels(options, &pairs, pool, &results, kernels);
+	}
+
+	//a query of length 0 has no aligner
+	gqss_aligner* empty_aligner = gqss_aligner_create("", 0, get_nuc_4_4_value, 16);
+	if (empty_aligner != NULL) {
+		printf("Mismatch of %s: an aligner was created for a query of length 0\n\n", kernels[1].name);
+		kernels[1].mismatch_count++;
+		gqss_aligner_destroy(empty_aligner);
+	}
+
+	gqss_batch_result_free(&results);
+	gqss_thread_pool_destroy(pool);
+	free(scores);
+	free(pairs.expected_alignments);
+	free(pairs.reads);
+	free(pairs.query);
+	return checked;
+}
+
+static void print_kernel(check_kernel* kernel) {
+	double pairs_per_second = (kernel->seconds > 0) ? ((double)kernel->pair_count / kernel->seconds) : 0;
+	double gcups = (kernel->seconds > 0) ? ((double)kernel->cell_count / kernel->seconds * 0.000000001) : 0;
+	printf("%-32s%10zu%12zu%12.3lf%14.0lf%10.3lf\n", kernel->name, kernel->pair_count, kernel->mismatch_count, kernel->seconds, pairs_per_second, gcups);
+	return;
+}
+
+/*
+	int parse_check_options(int argc, char* argv[], check_options* options)
+
+	parse_check_options() parses the application's given arguments. The function returns 0 when no problems were
+	encountered during parsing and 1 on failure.
+*/
+static int parse_check_options(int argc, char* argv[], check_options* options) {
+	int getopt_index = 0;
+	int c;
+
+	options->pair_count = 4096;
+	options->max_length = 200;
+	options->seed = 1;
+	options->max_report_count = 10;
+	options->thread_count = 4;
+
+	while ((c = getopt_long(argc, argv, "t:h", getopt_long_options, &getopt_index)) != -1) {
+		bool parsed = true;
+		switch (c) {
+			case 0:
+				if (strcmp(getopt_long_options[getopt_index].name, "pairs") == 0) {
+					parsed = (sscanf(optarg, "%zu", &options->pair_count) == 1) && (options->pair_count > 0);
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "max-length") == 0) {
+					parsed = (sscanf(optarg, "%zu", &options->max_length) == 1) && (options->max_length > 0);
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "seed") == 0) {
+					parsed = (sscanf(optarg, "%" SCNu64, &options->seed) == 1);
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "max-reports") == 0) {
+					parsed = (sscanf(optarg, "%zu", &options->max_report_count) == 1);
+				}
+				if (!parsed) {
+					printf("check_linear_gap_smith_waterman: option --%s: invalid value '%s'.\n", getopt_long_options[getopt_index].name, optarg);
+				}
+				break;
+			case 't':
+				parsed = (sscanf(optarg, "%zu", &options->thread_count) == 1) && (options->thread_count > 0);
+				if (!parsed) {
+					printf("check_linear_gap_smith_waterman: option -t, --threads: expected a positive integer.\n");
+				}
+				break;
+			case 'h':
+				printf("%s", help_message);
+				exit(0);
+			default:
+				parsed = false;
+				break;
+		}
+
+		if (!parsed) {
+			printf("Try 'check_linear_gap_smith_waterman --help' for more information.\n");
+			return 1;
+		}
+	}
+
+	if (optind < argc) {
+		printf("check_linear_gap_smith_waterman: unexpected argument '%s'.\n", argv[optind]);
+		printf("Try 'check_linear_gap_smith_waterman --help' for more information.\n");
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, char* argv[]) {
+	check_options options;
+
+	if (parse_check_options(argc, argv, &options) != 0) {
+		return 1;
+	}
+
+	/*
+		The best score of a pair is at most 5 (the largest EDNAFULL score) times the length of the shorter sequence and the
+		gap penalty of the large scores is 16 times the scale, both stay below INT64_MAX.
+	*/
+	score_scale = INT64_MAX / (6 * ((int64_t)options.max_length + 2));
+
+	check_kernel kernels[CHECK_KERNEL_COUNT] = {
+		{"reference", 0, 0, 0, 0},
+		{"aligner", 0, 0, 0, 0},
+		{"aligner scores only", 0, 0, 0, 0},
+		{"aligner shared profile", 0, 0, 0, 0},
+		{"batch aligner", 0, 0, 0, 0},
+		{"batch aligner scores only", 0, 0, 0, 0},
+		{"batch aligner threads", 0, 0, 0, 0}
+	};
+
+	if (!check_kernels(&options, kernels)) {
+		printf("error: the check failed!\n");
+		return 1;
+	}
+
+	size_t mismatch_count = 0;
+	for (size_t i = 0; i < CHECK_KERNEL_COUNT; i++) {
+		mismatch_count = mismatch_count + kernels[i].mismatch_count;
+	}
+
+	printf("%zu pairs of up to %zu characters, seed %" PRIu64 ", %zu threads\n\n", kernels[0].pair_count, options.max_length, options.seed, options.thread_count);
+	printf("%-32s%10s%12s%12s%14s%10s\n", "Kernel", "Pairs", "Mismatches", "Seconds", "Pairs/Second", "GCUPS");
+	for (size_t i = 0; i < CHECK_KERNEL_COUNT; i++) {
+		print_kernel(&kernels[i]);
+	}
+
+	if (mismatch_count > 0) {
+		printf("\n%zu alignments differ from the reference\n", mismatch_count);
+		return 1;
+	}
+	printf("\nEvery kernel matches the reference\n");
+	return 0;
+}
@@ -20,265 +20,244 @@
 
 #include "ednafull_linear_smith_waterman.h"
 
+#include <pthread.h>
+
 static const struct option getopt_long_options[] = {
 	{"query", required_argument, NULL, 'q'},
 	{"gap-penalty", required_argument, NULL, 'P'},
+	{"threads", required_argument, NULL, 't'},
 	{"type", required_argument, NULL, 0},
+	{"serve", required_argument, NULL, 0},
+	{"shard", required_argument, NULL, 0},
+	{"checkpoint-interval", required_argument, NULL, 0},
+	{"resume", no_argument, NULL, 0},
+	{"follow", no_argument, NULL, 0},
+	{"follow-timeout", required_argument, NULL, 0},
+	{"follow-sentinel", required_argument, NULL, 0},
+	{"output", required_argument, NULL, 'o'},
+	{"input-list", required_argument, NULL, 0},
+	{"matched-out", required_argument, NULL, 0},
+	{"unmatched-out", required_argument, NULL, 0},
+	{"min-score", required_argument, NULL, 0},
+	{"summary-only", no_argument, NULL, 0},
+	{"stats", no_argument, NULL, 0},
+	{"report", required_argument, NULL, 0},
+	{"coverage", required_argument, NULL, 0},
+	{"top-k", required_argument, NULL, 0},
+	{"max-hits", required_argument, NULL, 0},
+	{"sample-fraction", required_argument, NULL, 0},
+	{"sample-count", required_argument, NULL, 0},
+	{"sample-every", required_argument, NULL, 0},
+	{"seed", required_argument, NULL, 0},
+	{"demux", required_argument, NULL, 0},
+	{"max-open-files", required_argument, NULL, 0},
+	{"mate", required_argument, NULL, 0},
+	{"interleaved", no_argument, NULL, 0},
+	{"max-fragment-length", required_argument, NULL, 0},
+	{"parallel-files", required_argument, NULL, 0},
 	{"help", no_argument, NULL, 'h'},
 	{"version", no_argument, NULL, 'v'},
 	{ NULL, 0, NULL, 0}
 };
 
+static const struct option getopt_long_index_options[] = {
+	{"query", required_argument, NULL, 'q'},
+	{"help", no_argument, NULL, 'h'},
+	{ NULL, 0, NULL, 0}
+};
+
+static const struct option getopt_long_index_fastq_options[] = {
+	{"stride", required_argument, NULL, 'n'},
+	{"help", no_argument, NULL, 'h'},
+	{ NULL, 0, NULL, 0}
+};
+
 static const char VERSION_STRING[42] = "ednafull_linear_smith_waterman 1.0.0\n";
 
 static const char HELP_STRING[] = (
-	"Usage: ednafull_linear_smith_waterman [OPTIONS...] [FASTQ FILE]\n"
+	"Usage: ednafull_linear_smith_waterman [OPTIONS...] [FASTQ FILE]...\n"
+	"  or:  ednafull_linear_smith_waterman [OPTIONS...] -\n"
+	"  or:  ednafull_linear_smith_waterman [OPTIONS...] --serve=SOCKET\n"
+	"  or:  ednafull_linear_smith_waterman index -q FILE INDEX_FILE\n"
+	"  or:  ednafull_linear_smith_waterman merge OUTPUT SHARD_FILE...\n"
+	"  or:  ednafull_linear_smith_waterman index-fastq [-n STRIDE] FASTQ_FILE\n"
 	"Run the Smith-Waterman algorithm with linear gap penalty and the EDNAFULL\n"
 	"substitution matrix on the given sequences found in the FASTA and FASTQ files.\n\n"
 	"Examples:\n"
 	"  ednafull_linear_smith_waterman -q gene.fasta reads.fastq\n"
 	"  ednafull_linear_smith_waterman -q gene.fasta -P 10 reads.fastq\n"
 	"  ednafull_linear_smith_waterman -q gene.fasta --type=pair reads.fastq\n"
+	"  ednafull_linear_smith_waterman -q gene.fasta -t 8 reads.fastq\n"
+	"  ednafull_linear_smith_waterman -q gene1.fasta -q gene2.fasta --serve=gqss.sock\n"
+	"  ednafull_linear_smith_waterman index -q gene.fasta gene.gqssidx\n"
+	"  ednafull_linear_smith_waterman -q gene.gqssidx reads.fastq\n"
+	"  ednafull_linear_smith_waterman -q gene.fasta --shard=2/4 reads.fastq\n"
+	"  ednafull_linear_smith_waterman merge reads.fastq.sw.tsv reads.fastq.sw.tsv.shard-*\n"
+	"  ednafull_linear_smith_waterman index-fastq reads.fastq\n"
+	"  ednafull_linear_smith_waterman -q gene.fasta --resume reads.fastq\n"
+	"  ednafull_linear_smith_waterman -q gene.fasta --follow --follow-sentinel=run.done reads.fastq\n"
+	"  ednafull_linear_smith_waterman -q gene.fasta -t 16 lane1.fastq lane2.fastq lane3.fastq\n"
+	"  ednafull_linear_smith_waterman -q gene.fasta -t 16 --input-list=lanes.txt\n"
+	"  ednafull_linear_smith_waterman -q gene.fasta --mate=reads_R2.fastq reads_R1.fastq\n"
+	"  ednafull_linear_smith_waterman -q gene.fasta --type=none --matched-out=hits.fastq reads.fastq\n"
+	"  ednafull_linear_smith_waterman -q panel.fasta --demux=bins reads.fastq\n"
+	"  ednafull_linear_smith_waterman -q gene.fasta --summary-only -t 8 reads.fastq\n"
+	"  ednafull_linear_smith_waterman -q gene.fasta --top-k=100 reads.fastq\n"
+	"  zcat reads.fastq.gz | ednafull_linear_smith_waterman -q gene.fasta - | cut -f 1,2\n"
 	"\n"
 	"Options:\n"
-	"  -q, --query=FILE            specify query sequence (FASTA format)\n"
+	"  -q, --query=FILE            specify query sequence (FASTA format or a query\n"
+	"                              index file ending in .gqssidx)\n"
 	"  -P, --gap-penalty=INT       specify linear gap penalty (default value is 16)\n"
-	"  --type=TYPE                 specify output format: 'tsv' (default) or 'pair'\n"
+	"  -t, --threads=INT           specify number of alignment threads (default value is 1)\n"
+	"  --type=TYPE                 specify output format: 'tsv' (default), 'pair' or\n"
+	"                              'none' (only --matched-out and --unmatched-out)\n"
+	"  --shard=i/N                 only align the records starting in the i-th of N\n"
+	"                              byte ranges of the FASTQ file (1 <= i <= N), or the\n"
+	"                              i-th of N equal record ranges if the FASTQ file has\n"
+	"                              an index (see index-fastq)\n"
+	"  --checkpoint-interval=INT   write a checkpoint every INT sequences (default value\n"
+	"                              is 65536, 0 disables checkpoints)\n"
+	"  --resume                    continue an interrupted run from its last checkpoint\n"
+	"  --follow                    align the records appended to a FASTQ file that is\n"
+	"                              still being written until --follow-sentinel exists\n"
+	"                              or no data is appended for --follow-timeout seconds\n"
+	"  --follow-timeout=SECONDS    end --follow after SECONDS without appended data\n"
+	"                              (default value is 600, 0 waits for the sentinel)\n"
+	"  --follow-sentinel=FILE      end --follow once FILE exists\n"
+	"  --matched-out=FILE          write the FASTQ records scoring at least --min-score\n"
+	"                              against the query or its reverse complement to FILE\n"
+	"  --unmatched-out=FILE        write the other FASTQ records to FILE\n"
+	"  --min-score=INT             minimum score of a matched record (default value is\n"
+	"                              100)\n"
+	"  --summary-only              only write the number of hits (scoring at least\n"
+	"                              --min-score), a score histogram and the coverage of\n"
+	"                              the query by the hits to a '.sw.summary.json' file\n"
+	"  --stats                     print the time spent parsing, encoding, aligning,\n"
+	"                              tracing back, counting mismatches, formatting and\n"
+	"                              writing, the cells computed, reads/s, GCUPS and the\n"
+	"                              utilisation of every thread at the end of the run\n"
+	"  --report=FILE               write the --stats counters, input sizes, peak memory\n"
+	"                              and aligner kernel of the run to the JSON file FILE\n"
+	"  --coverage=FILE             write the depth of coverage, mismatches, deletions\n"
+	"                              and insertions of the hits at every query position\n"
+	"                              to the TSV file FILE\n"
+	"  --top-k=K                   only write the TSV rows of the K best scoring\n"
+	"                              sequences (of all FASTQ files, -o is required for\n"
+	"                              several files) to a '.sw.top.tsv' file\n"
+	"  --max-hits=N                stop reading and aligning once N sequences scored at\n"
+	"                              least --min-score (in all FASTQ files together)\n"
+	"  --sample-fraction=F         only align a random fraction F (0 < F <= 1) of the\n"
+	"                              FASTQ records\n"
+	"  --sample-count=N            only align N FASTQ records chosen at random from\n"
+	"                              each FASTQ file (reservoir sampling)\n"
+	"  --sample-every=K            only align every K-th FASTQ record\n"
+	"  --seed=INT                  seed of --sample-fraction and --sample-count\n"
+	"                              (default value is 0)\n"
+	"  --demux=DIR                 write each FASTQ record to DIR/ID.fastq of the query\n"
+	"                              sequence ID it scores best against (every sequence\n"
+	"                              of the -q FASTA files is a query), or to\n"
+	"                              DIR/unassigned.fastq below --min-score\n"
+	"  --max-open-files=INT        keep at most INT --demux files open (default value\n"
+	"                              is 256)\n"
+	"  --mate=FILE                 align paired-end reads, with the second mates (R2) in\n"
+	"                              FILE and the first mates (R1) in the FASTQ file, and\n"
+	"                              write one pair record per pair ('.sw.pairs.tsv')\n"
+	"  --interleaved               align paired-end reads whose mates alternate in the\n"
+	"                              FASTQ file, written like with --mate\n"
+	"  --max-fragment-length=INT   maximum fragment length of a proper pair (default\n"
+	"                              value is 1000)\n"
+	"  --input-list=FILE           also align the FASTQ files listed in FILE, one file\n"
+	"                              name per line\n"
+	"  --parallel-files=INT        align INT of several FASTQ files at the same time\n"
+	"                              (default value is the number of threads)\n"
+	"  -o, --output=FILE           write the results to FILE instead of the FASTQ file\n"
+	"                              name with a '.sw.tsv' or '.sw.pair' extension, '-'\n"
+	"                              is the standard output (default if the FASTQ file\n"
+	"                              is '-', the standard input)\n"
+	"  --serve=SOCKET              load the queries once and align jobs received on the\n"
+	"                              Unix domain socket SOCKET (see README.md)\n"
 	"  -h, --help                  print this help and exit\n"
 	"  --version                   print version information and exit\n"
 	);
 
-/* 
-	EDNAFULL_NUC_4_4 is actually 90x90 size array.
-
-	The dimensions of array were chosen based on the value of 'Y' (89).
-*/
-static const int64_t EDNAFULL_NUC_4_4[8100] = {
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 5, -4, -4, -1, 0, 0, -4, -1, 0, 0, -4, 0, 1, -2, 0, 0, 0, 1, -4, -4, 0, -1, 1, 0, -4,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -4, -1, -1, -2, 0, 0, -1, -2, 0, 0, -1, 0, -3, -1, 0, 0, 0, -3, -1, -1, 0, -2, -3, 0, -1,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -4, -1, 5, -4, 0, 0, -4, -1, 0, 0, -4, 0, 1, -2, 0, 0, 0, -4, 1, -4, 0, -1, -4, 0, 1,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -1, -2, -4, -1, 0, 0, -1, -2, 0, 0, -1, 0, -3, -1, 0, 0, 0, -1, -3, -1, 0, -2, -1, 0, -3,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -4, -1, -4, -1, 0, 0, 5, -4, 0, 0, 1, 0, -4, -2, 0, 0, 0, 1, 1, -4, 0, -1, -4, 0, -4,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -1, -2, -1, -2, 0, 0, -4, -1, 0, 0, -3, 0, -1, -1, 0, 0, 0, -3, -3, -1, 0, -2, -1, 0, -1,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -4, -1, -4, -1, 0, 0, 1, -3, 0, 0, -1, 0, -4, -1, 0, 0, 0, -2, -2, 1, 0, -3, -2, 0, -2,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, -3, 1, -3, 0, 0, -4, -1, 0, 0, -4, 0, -1, -1, 0, 0, 0, -2, -2, -4, 0, -1, -2, 0, -2,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -2, -1, -2, -1, 0, 0, -2, -1, 0, 0, -1, 0, -1, -1, 0, 0, 0, -1, -1, -2, 0, -1, -1, 0, -1,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, -3, -4, -1, 0, 0, 1, -3, 0, 0, -2, 0, -2, -1, 0, 0, 0, -1, -2, -4, 0, -1, -2, 0, -4,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -4, -1, 1, -3, 0, 0, 1, -3, 0, 0, -2, 0, -2, -1, 0, 0, 0, -2, -1, -4, 0, -1, -4, 0, -2,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -4, -1, -4, -1, 0, 0, -4, -1, 0, 0, 1, 0, -4, -2, 0, 0, 0, -4, -4, 5, 0, -4, 1, 0, 1,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -1, -2, -1, -2, 0, 0, -1, -2, 0, 0, -3, 0, -1, -1, 0, 0, 0, -1, -1, -4, 0, -1, -3, 0, -3,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, -3, -4, -1, 0, 0, -4, -1, 0, 0, -2, 0, -2, -1, 0, 0, 0, -2, -4, 1, 0, -3, -1, 0, -2,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -4, -1, 1, -3, 0, 0, -4, -1, 0, 0, -2, 0, -2, -1, 0, 0, 0, -4, -2, 1, 0, -3, -2, 0, -1,
-};
-
 /*
-	char complement_dna_base(char base)
-
-	complement_dna_base() returns the complement of a given base if possible.
-	Otherwise, the function returns the null character.
-*/
-static char complement_dna_base(char base) {
-	switch (base) {
-		case 'A':
-			return 'T';
-		case 'a':
-			return 't';
-		case 'B':
-			return 'V';
-		case 'b':
-			return 'v';
-		case 'C':
-			return 'G';
-		case 'c':
-			return 'g';
-		case 'D':
-			return 'H';
-		case 'd':
-			return 'h';
-		case 'G':
-			return 'C';
-		case 'g':
-			return 'c';
-		case 'H':
-			return 'D';
-		case 'h':
-			return 'd';
-		case 'M':
-			return 'K';
-		case 'm':
-			return 'k';
-		case 'N':
-			return 'N';
-		case 'n':
-			return 'n';
-		case 'S':
-			return 'S';
-		case 's':
-			return 's';
-		case 'T':
-			return 'A';
-		case 't':
-			return 'a';
-		case 'U':
-			return 'A';
-		case 'u':
-			return 'a';
-		case 'V':
-			return 'B';
-		case 'v':
-			return 'b';
-		case 'W':
-			return 'W';
-		case 'w':
-			return 'w';
-		case 'Y':
-			return 'R';
-		case 'y':
-			return 'r';
-		default:
-			printf("error: complement_dna_base(): found unexpected base, %c!\n", base);
-			return '\0';
-	}
-}
-
-/*
-	char* get_reverse_complement(char* sequence)
-
-	get_reverse_complement() returns the reverse complement of a string in a newly allocated C string.
-*/
-static char* get_reverse_complement(char* sequence) {
-	if (sequence == NULL) {
-		return NULL;
-	}
-	size_t sequence_length = strlen(sequence);
+	gqss_aligner* create_ednafull_aligner(char* sequence, int64_t gap_penalty)
 
-	//allocate a C string with the same size as 'sequence'
-	char* reverse_complement_sequence = (char *)malloc((sequence_length + 1) * sizeof(char));
-	reverse_complement_sequence[sequence_length] = '\0';
+	create_ednafull_aligner() returns a new aligner context for 'sequence' using the EDNAFULL substitution matrix and
+	the linear gap penalty 'gap_penalty'. The application exits if the aligner could not be created.
+*/
+static gqss_aligner* create_ednafull_aligner(char* sequence, int64_t gap_penalty) {
+	gqss_aligner* aligner = gqss_aligner_create(sequence, strlen(sequence), get_nuc_4_4_value, gap_penalty);
+	if (aligner == NULL) {
+		printf("error: create_ednafull_aligner(): failed to create aligner!\n");
 
-	for (size_t i = 0; i < sequence_length; i++) {
-		reverse_complement_sequence[(sequence_length - 1) - i] = complement_dna_base(sequence[i]);
+		//immediately exit
+		exit(1);
 	}
-
-	return reverse_complement_sequence;
+	return aligner;
 }
 
 /*
-	int64_t get_nuc_4_4_value(char a, char b)
+	gqss_batch_aligner* create_ednafull_batch_aligner(gqss_aligner* aligner, gqss_thread_pool* pool)
 
-	int64_t get_nuc_4_4_value(char a, char b) return the value of the 2 bases according to the EDNAFULL substitution matrix.
+	create_ednafull_batch_aligner() returns a new batch aligner for 'aligner' that runs on 'pool'. The application exits
+	if the batch aligner could not be created.
 */
-int64_t get_nuc_4_4_value(char a, char b) {
-	size_t index = (size_t)(a) + (90 * (size_t)b);
-	return EDNAFULL_NUC_4_4[index];
+static gqss_batch_aligner* create_ednafull_batch_aligner(gqss_aligner* aligner, gqss_thread_pool* pool) {
+	gqss_batch_aligner* batch_aligner = gqss_batch_aligner_create(aligner, pool);
+	if (batch_aligner == NULL) {
+		printf("error: create_ednafull_batch_aligner(): failed to create batch aligner!\n");
+
+		//immediately exit
+		exit(1);
+	}
+	return batch_aligner;
 }
 
 /*
-	int64_t get_linear_gap_smith_waterman_score(char* seq_X, char* seq_Y, char** trace_X, char** trace_Y, size_t* start_X, size_t* start_Y, size_t* stop_X, size_t* stop_Y, int64_t gap_penalty)
+	void load_ednafull_query(ednafull_query* query, char* identifier, char* sequence, int64_t gap_penalty, gqss_thread_pool* pool)
 
-	get_linear_gap_smith_waterman_score() executes the Smith-Waterman algorithm with linear gap penalty 'gap_penalty' and returns the best score in the matrix.
-	The function also sets 'trace_X' and 'trace_Y' to newly allocated C strings that contain the alignment strings. In addition, the indices of the substring are stored into
-	'start_X', 'start_Y', 'stop_X', and 'stop_Y'.
+	load_ednafull_query() computes the reverse complement of the query sequence and creates the aligners of the query and
+	its reverse complement. 'query' takes ownership of the 'identifier' and 'sequence' allocations.
 */
-int64_t get_linear_gap_smith_waterman_score(char* seq_X, char* seq_Y, char** trace_X, char** trace_Y, size_t* start_X, size_t* start_Y, size_t* stop_X, size_t* stop_Y, int64_t gap_penalty) {
-	int64_t score;
-	int64_t* Z = (int64_t *)malloc(strlen(seq_X) * strlen(seq_Y) * sizeof(int64_t));
-
-	linear_gap_smith_waterman(seq_X, seq_Y, Z, get_nuc_4_4_value, gap_penalty);
-
-	assert(best_linear_gap_smith_waterman_score_indices(strlen(seq_X), strlen(seq_Y), Z, stop_X, stop_Y));
+void load_ednafull_query(ednafull_query* query, char* identifier, char* sequence, int64_t gap_penalty, gqss_thread_pool* pool) {
+	query->identifier = identifier;
+	query->sequence = sequence;
+	query->index = NULL;
 
-	//assign initial indices for traceback to 'start_X' and 'start_Y'
-	*start_X = *stop_X;
-	*start_Y = *stop_Y;
-
-	//allocate alignment strings, this function will not free these allocations
-	*trace_X = (char *)malloc(((*stop_X) + (*stop_Y) + 3) * sizeof(char));
-	*trace_Y = (char *)malloc(((*stop_X) + (*stop_Y) + 3) * sizeof(char));
+	query->reverse_complement_sequence = get_reverse_complement(sequence);
+	if (query->reverse_complement_sequence == NULL) {
+		//immediately exit
+		exit(1);
+	}
 
-	trace_linear_gap_smith_waterman(seq_X, seq_Y, Z, *trace_X, *trace_Y, start_X, start_Y, get_nuc_4_4_value, gap_penalty);
+	query->aligner = create_ednafull_aligner(query->sequence, gap_penalty);
+	query->reverse_complement_aligner = create_ednafull_aligner(query->reverse_complement_sequence, gap_penalty);
 
-	score = Z[((*stop_X) * strlen(seq_Y)) + *stop_Y];
+	query->batch_aligner = create_ednafull_batch_aligner(query->aligner, pool);
+	query->reverse_complement_batch_aligner = create_ednafull_batch_aligner(query->reverse_complement_aligner, pool);
+	return;
+}
 
-	//free allocations
-	free(Z);
+/*
+	void free_ednafull_query(ednafull_query* query)
 
-	return score;
+	free_ednafull_query() frees the aligners and C strings of the query.
+*/
+void free_ednafull_query(ednafull_query* query) {
+	gqss_batch_aligner_destroy(query->batch_aligner);
+	gqss_batch_aligner_destroy(query->reverse_complement_batch_aligner);
+	gqss_aligner_destroy(query->aligner);
+	gqss_aligner_destroy(query->reverse_complement_aligner);
+
+	//the aligners borrowed the profiles of the mapped index file
+	gqss_query_index_close(query->index);
+
+	free(query->reverse_complement_sequence);
+	free(query->sequence);
+	free(query->identifier);
+	return;
 }
 
 /*
@@ -293,304 +272,281 @@ static double compute_time_elapsed(struct timespec* t1, struct timespec* t2) {
 }
 
 /*
-	count_mismatches(char* trace_X, char* trace_Y, uint64_t* identical, uint64_t* gaps_X, uint64_t* gaps_Y, uint64_t* mismatches)
+	void print_progress(struct timespec* start_time, uint64_t sequence_count)
 
-	count_mismatches() counts the number of mismatches and gaps found between the 2 given sequences ('trace_X' and 'trace_Y'). The
-	resulting number of mismatches found is assigned to 'mismatches'. In addition, the number of gaps corresponding to 'trace_X' and
-	'trace_Y' are assigned to 'gaps_X' and 'gaps_Y' respectively.
+	print_progress() prints the number of seconds elapsed since 'start_time' and the number of sequences parsed.
 */
-static void count_mismatches(char* trace_X, char* trace_Y, uint64_t* identical, uint64_t* gaps_X, uint64_t* gaps_Y, uint64_t* mismatches) {
-	assert((trace_X != NULL) && (trace_Y != NULL));
-	assert(strlen(trace_X) == strlen(trace_Y));
+static void print_progress(struct timespec* start_time, uint64_t sequence_count) {
+	struct timespec current_time;
 
-	*identical = 0;
-	*gaps_X = 0;
-	*gaps_Y = 0;
-	*mismatches = 0;
+	clock_gettime(CLOCK_MONOTONIC, &current_time);
+	printf("[%11.2lf seconds]: %" PRIu64 " sequences parsed\n", compute_time_elapsed(start_time, &current_time), sequence_count);
+	return;
+}
 
-	for (size_t i = 0; i < strlen(trace_X); i++) {
-		if (trace_X[i] == trace_Y[i]) {
-			if (trace_X[i] == '-') {
-				//both bases in 'trace_X' in 'trace_Y' are gaps
-				*gaps_X = (*gaps_X) + 1;
-				*gaps_Y = (*gaps_Y) + 1;
+/*
+	void print_batch_progress(struct timespec* start_time, gqss_alignment_batch* batch)
 
-				*mismatches = (*mismatches) + 1;
-			}
-			else {
-				*identical = (*identical) + 1;
-			}
-		}
-		else {
-			if (trace_X[i] == '-') {
-				*gaps_X = (*gaps_X) + 1;
-			}
-			else if (trace_Y[i] == '-') {
-				*gaps_Y = (*gaps_Y) + 1;
-			}
-			
-			*mismatches = (*mismatches) + 1;
+	print_batch_progress() prints a checkpoint for every (1024 / 4) = 256 sequences found in 'batch'.
+*/
+static void print_batch_progress(struct timespec* start_time, gqss_alignment_batch* batch) {
+	for (size_t i = 0; i < batch->count; i++) {
+		uint64_t sequence_count = batch->records[i].record_index + 1;
+		if (!(sequence_count & 0xff)) {
+			print_progress(start_time, sequence_count);
 		}
 	}
+	return;
+}
+
+/*
+	void get_alignment_quality(gqss_fastq_record* record, gqss_batch_result* results, size_t i, char** quality, size_t* quality_length)
+
+	get_alignment_quality() assigns the section of the FASTQ phred scores corresponding to alignment 'i' of 'results'.
+
+	Note: the length of the phred scores <= alignment length due to possible gap insertions in alignment.
+*/
+static void get_alignment_quality(gqss_fastq_record* record, gqss_batch_result* results, size_t i, char** quality, size_t* quality_length) {
+	*quality = record->quality;
+	*quality_length = 0;
+
+	if ((results->scores[i] < 0) || (results->read_starts[i] >= record->quality_length)) {
+		//nothing was aligned or the quality scores line is too short
+		return;
+	}
 
+	*quality = record->quality + results->read_starts[i];
+	*quality_length = (results->read_stops[i] - results->read_starts[i]) + 1;
+	if (results->read_stops[i] >= record->quality_length) {
+		*quality_length = record->quality_length - results->read_starts[i];
+	}
 	return;
 }
 
 /*
-	void handle_fastq_tsv(char* fastq_filename, char* fastq_data, char* query_sequence_identifier, char* query_sequence, int64_t gap_penalty)
+	bool write_tsv_batch_rows(FILE* file_fd, char* query_sequence_identifier, int64_t gap_penalty, gqss_alignment_batch* batch)
 
-	handle_fastq_tsv() parses the FASTQ file and writes the results in a tab delimited values file format (TSV).
+	write_tsv_batch_rows() writes a row for the query alignment and a row for the reverse complement query alignment of every
+	record of 'batch' to 'file_fd'. The function returns false if writing to 'file_fd' failed.
 */
-void handle_fastq_tsv(char* fastq_filename, char* fastq_data, char* query_sequence_identifier, char* query_sequence, int64_t gap_penalty) {
-	assert(fastq_filename != NULL);
+bool write_tsv_batch_rows(FILE* file_fd, char* query_sequence_identifier, int64_t gap_penalty, gqss_alignment_batch* batch) {
+	char* quality;
+	size_t quality_length;
+
+	for (size_t i = 0; i < batch->count; i++) {
+		gqss_fastq_record* record = &(batch->records[i]);
+		gqss_batch_result* forward = batch->forward;
+		gqss_batch_result* reverse_complement = batch->reverse_complement;
+
+		get_alignment_quality(record, forward, i, &quality, &quality_length);
+		write_int_linear_gap_penalty_tsv_alignment(file_fd, "", query_sequence_identifier, record->identifier, record->identifier_length, "NUC4.4",
+									forward->scores[i], gap_penalty,
+									(forward->query_alignments + forward->alignment_offsets[i]),
+									(forward->read_alignments + forward->alignment_offsets[i]),
+									(forward->alignment_offsets[i + 1] - forward->alignment_offsets[i] - 1),
+									quality, quality_length);
+
+		get_alignment_quality(record, reverse_complement, i, &quality, &quality_length);
+		write_int_linear_gap_penalty_tsv_alignment(file_fd, "Reverse_Complement_", query_sequence_identifier, record->identifier, record->identifier_length, "NUC4.4",
+									reverse_complement->scores[i], gap_penalty,
+									(reverse_complement->query_alignments + reverse_complement->alignment_offsets[i]),
+									(reverse_complement->read_alignments + reverse_complement->alignment_offsets[i]),
+									(reverse_complement->alignment_offsets[i + 1] - reverse_complement->alignment_offsets[i] - 1),
+									quality, quality_length);
+		if(ferror(file_fd)) {
+			return false;
+		}
+	}
+
+	return true;
+}
 
-	size_t total_bytes = strlen(fastq_data);
-	size_t current_index = 0;
+typedef struct tsv_writer {
+	FILE* file_fd;
+	ednafull_checkpoint* checkpoint;
+	char* query_sequence_identifier;
+	int64_t gap_penalty;
+	bool show_progress;
+	struct timespec start_time;
+	ednafull_stats* stats;
+	bool failed;
+} tsv_writer;
 
-	uint64_t line_count = 0;
-	size_t last_newline = 0;
-	size_t current_line_length = 0;
+/*
+	bool write_tsv_batch(gqss_alignment_batch* batch, void* user_data)
 
-	char* sequence_id = NULL;
-	char* sequence = NULL;
-	char* phred_scores = NULL;
+	write_tsv_batch() writes the rows of every record of 'batch' to the TSV file. If writing failed, 'failed' is set and the
+	stream is stopped.
+*/
+static bool write_tsv_batch(gqss_alignment_batch* batch, void* user_data) {
+	tsv_writer* writer = (tsv_writer *)user_data;
 
-	char* sequence_alignment;
-	char* query_sequence_alignment;
-	char* alignment_phred_scores = NULL;
-	size_t alignment_phred_scores_length;
+	uint64_t start_nanoseconds = (writer->stats != NULL) ? get_ednafull_stats_clock() : 0;
 
-	char* reverse_complement_sequence = get_reverse_complement(query_sequence);
+	if (!write_tsv_batch_rows(writer->file_fd, writer->query_sequence_identifier, writer->gap_penalty, batch)) {
+		perror("write_tsv_batch(): fprintf(): error");
 
-	int64_t smith_waterman_score;
-	int64_t reverse_complement_smith_waterman_score;
+		writer->failed = true;
+		return false;
+	}
+
+	if (writer->stats != NULL) {
+		start_nanoseconds = add_ednafull_stage_time(writer->stats, EDNAFULL_STAGE_FORMAT, start_nanoseconds);
+	}
+
+	//flush the file stream
+	fflush(writer->file_fd);
+
+	if (writer->stats != NULL) {
+		add_ednafull_stage_time(writer->stats, EDNAFULL_STAGE_WRITE, start_nanoseconds);
+	}
+
+	if (!update_checkpoint(writer->checkpoint, batch)) {
+		writer->failed = true;
+		return false;
+	}
 
-	size_t query_sequence_start;
-	size_t query_sequence_stop;
-	size_t sequence_start;
-	size_t sequence_stop;
+	if (writer->show_progress) {
+		print_batch_progress(&writer->start_time, batch);
+	}
+	return true;
+}
+
+/*
+	char* get_output_filename(ednafull_options* options, char* extension)
 
-	uint64_t identicals;
-	uint64_t gaps_X;
-	uint64_t gaps_Y;
-	uint64_t mismatches;
+	get_output_filename() returns a newly allocated output file name made of the FASTQ file name and 'extension', or a copy of
+	the -o, --output file name. A shard appends its 1-based shard index and the shard count (zero padded, so that the shard
+	files sort in input order). The standard output "-" is returned unchanged.
+*/
+char* get_output_filename(ednafull_options* options, char* extension) {
+	char shard_suffix[64] = "";
+	if (options->shard_count > 1) {
+		int width = snprintf(NULL, 0, "%zu", options->shard_count);
+		snprintf(shard_suffix, sizeof(shard_suffix), ".shard-%0*zu-of-%zu", width, options->shard_index, options->shard_count);
+	}
+
+	char* base_filename = options->fastq_filename;
+	if (options->output_filename != NULL) {
+		base_filename = options->output_filename;
+		extension = "";
+	}
 
-	//keep track of FASTQ format row as a variable
-	size_t sequence_row;
+	if (strcmp(base_filename, EDNAFULL_STANDARD_STREAM) == 0) {
+		shard_suffix[0] = '\0';
+	}
 
-	char* new_filename = (char *)malloc((strlen(fastq_filename) + 8) * sizeof(char));
+	size_t filename_length = strlen(base_filename) + strlen(extension) + strlen(shard_suffix);
+	char* new_filename = (char *)malloc((filename_length + 1) * sizeof(char));
 	if (new_filename == NULL) {
-		perror("handle_fastq_tsv(): malloc(): error");
+		perror("get_output_filename(): malloc(): error");
 
 		//immediately exit
 		exit(1);
 	}
 
-	//determine new .tsv filename from FASTQ file name
-	memcpy((new_filename + strlen(fastq_filename)), ".sw.tsv", (8 * sizeof(char)));
-	memcpy(new_filename, fastq_filename, (strlen(fastq_filename) * sizeof(char)));
+	//determine new filename from FASTQ file name
+	snprintf(new_filename, (filename_length + 1), "%s%s%s", base_filename, extension, shard_suffix);
+	return new_filename;
+}
 
-	printf("Writing tab separated values to \"%s\"\n", new_filename);
+/*
+	uint64_t handle_fastq_tsv(ednafull_options* options, ednafull_input* input, ednafull_query* query)
 
-	FILE* file_fd = fopen(new_filename, "wb");
-	if (file_fd == NULL) {
-		perror("handle_fastq_tsv(): fopen(): error");
+	handle_fastq_tsv() parses the FASTQ data and writes the results in a tab delimited values file format (TSV). Only the first
+	shard writes the column descriptions, so that the shard files can be concatenated. The function returns the number of
+	sequences parsed, 'options->status' is set if the TSV file could not be written.
+*/
+uint64_t handle_fastq_tsv(ednafull_options* options, ednafull_input* input, ednafull_query* query) {
+	assert(options->fastq_filename != NULL);
 
-		//immediately exit
-		exit(2);
-	}
+	ednafull_checkpoint checkpoint;
+
+	tsv_writer writer;
+	writer.checkpoint = &checkpoint;
+	writer.show_progress = options->show_progress;
+	writer.stats = options->stats;
+	writer.query_sequence_identifier = query->identifier;
+	writer.gap_penalty = options->gap_penalty;
+	writer.failed = false;
+
+	char* new_filename = get_output_filename(options, ".sw.tsv");
+
+	printf("Writing tab separated values to \"%s\"\n", new_filename);
+
+	writer.file_fd = open_checkpointed_output(&checkpoint, options, query, new_filename, input->length);
 
 	//free filename string allocation
 	free(new_filename);
 
-	//start measuring time between sequences
-	struct timespec start_time;
-	struct timespec current_time;
-	double time_elapsed;
+	if (writer.file_fd == NULL) {
+		return 0;
+	}
 
-	assert(clock_gettime(CLOCK_MONOTONIC, &start_time) == 0);
+	//start measuring time between sequences
+	clock_gettime(CLOCK_MONOTONIC, &writer.start_time);
 
 	//write the .tsv header (column descriptions) to file
-	fprintf(file_fd, "%s", "Reference Sequence Identifier\tSequence Identifier\tSmith-Waterman Score\tLinear Gap Penalty\tSubstitution Matrix\tAlignment Length\tAlignment Identities\tAlignment Gaps\tAlignment Mismatches\tReference Sequence Alignment\tSequence Alignment\tSequence Alignment Base Quality\n");
-	if(ferror(file_fd)) {
+	if ((options->shard_index == 1) && (!checkpoint.resumed)) {
+		write_tsv_alignment_header(writer.file_fd);
+	}
+	uint64_t sequence_count = 0;
+	if(ferror(writer.file_fd)) {
 		perror("handle_fastq_tsv(): fprintf(): error");
-
-		fclose(file_fd);
-
-		//immediately exit
-		exit(2);
+		writer.failed = true;
+	}
+	else {
+		sequence_count = align_ednafull_input(input, options, query, &checkpoint, write_tsv_batch, &writer);
 	}
 
-	while (current_index < total_bytes) {
-		if (fastq_data[current_index] == '\n') {
-			line_count++;
-			current_line_length = current_index - last_newline;
-			last_newline = current_index + 1;
-
-			sequence_row = line_count % 4;
-			if (sequence_row == 1) {
-				//FASTQ sequence identifier
-				sequence_id = extract_line(fastq_data, current_index, current_line_length);
-			}
-			else if (sequence_row == 2) {
-				//FASTQ sequence
-				sequence = extract_line(fastq_data, current_index, current_line_length);
-			}
-			else if (sequence_row == 0) {
-				//FASTQ quality scores
-				phred_scores = extract_line(fastq_data, current_index, current_line_length);
-
-				//run Smith-Waterman algorithm with linear gap
-				smith_waterman_score = get_linear_gap_smith_waterman_score(query_sequence, sequence, &sequence_alignment, &query_sequence_alignment, &query_sequence_start, &sequence_start, &query_sequence_stop, &sequence_stop, gap_penalty);
-
-				/*
-					Copy the specific section of the FASTQ phred scores corresponding to the alignment.
-					
-					Note: strlen(alignment_phred_scores) <= strlen(sequence_alignment) due to possible gap insertions in alignment.
-				*/
-				alignment_phred_scores_length = (sequence_stop - sequence_start) + 1;
-				alignment_phred_scores = (char *)malloc((alignment_phred_scores_length + 1) * sizeof(char));
-				if (alignment_phred_scores == NULL) {
-					perror("handle_fastq_tsv(): malloc(): error");
-			
-					//immediately exit
-					exit(1);
-				}
-				alignment_phred_scores[alignment_phred_scores_length] = '\0';
-			
-				memcpy(alignment_phred_scores, (phred_scores + sequence_start), (alignment_phred_scores_length * sizeof(char)));
-				
-
-				//count the number of mismatches and gaps found between 'sequence_alignment' and 'query_sequence_alignment'
-				count_mismatches(sequence_alignment, query_sequence_alignment, &identicals, &gaps_X, &gaps_Y, &mismatches);
-
-				//format the row output before writing to file
-				fprintf(file_fd, "%s\t%s\t%lld\t%lld\t%s\t%llu\t%llu\t%llu\t%llu\t%s\t%s\t%s\n",
-								(query_sequence_identifier + 1),
-								sequence_id,
-								smith_waterman_score,
-								gap_penalty,
-								"NUC4.4",
-								strlen(sequence_alignment),
-								identicals,
-								(gaps_X + gaps_Y),
-								mismatches,
-								sequence_alignment,
-								query_sequence_alignment,
-								alignment_phred_scores);
-				if(ferror(file_fd)) {
-					perror("handle_fastq_tsv(): fprintf(): error");
-			
-					fclose(file_fd);
-			
-					//immediately exit
-					exit(2);
-				}
-
-				//flush the file stream
-				fflush(file_fd);
-
-				//free sequence alignment string allocations
-				free(alignment_phred_scores);
-				free(sequence_alignment);
-				free(query_sequence_alignment);
-
-				//prevent double free() calls by assigning freed memory pointers to NULL
-				alignment_phred_scores = NULL;
-
-				//compute the reverse complement sequence alignment
-				reverse_complement_smith_waterman_score = get_linear_gap_smith_waterman_score(reverse_complement_sequence, sequence, &sequence_alignment, &query_sequence_alignment, &query_sequence_start, &sequence_start, &query_sequence_stop, &sequence_stop, gap_penalty);
-
-				/*
-					Copy the specific section of the FASTQ phred scores corresponding to the alignment.
-					
-					Note: strlen(alignment_phred_scores) <= strlen(sequence_alignment) due to possible gap insertions in alignment.
-				*/
-				alignment_phred_scores_length = (sequence_stop - sequence_start) + 1;
-				alignment_phred_scores = (char *)malloc((alignment_phred_scores_length + 1) * sizeof(char));
-				if (alignment_phred_scores == NULL) {
-					perror("handle_fastq_tsv(): malloc(): error");
-				
-					//immediately exit
-					exit(1);
-				}
-				alignment_phred_scores[alignment_phred_scores_length] = '\0';
-				
-				memcpy(alignment_phred_scores, (phred_scores + sequence_start), (alignment_phred_scores_length * sizeof(char)));
-				
-				//count the number of mismatches and gaps found between 'sequence_alignment' and 'query_sequence_alignment'
-				count_mismatches(sequence_alignment, query_sequence_alignment, &identicals, &gaps_X, &gaps_Y, &mismatches);
-
-				//format the row output before writing to file
-				fprintf(file_fd, "Reverse_Complement_%s\t%s\t%lld\t%lld\t%s\t%llu\t%llu\t%llu\t%llu\t%s\t%s\t%s\n",
-								(query_sequence_identifier + 1),
-								sequence_id,
-								smith_waterman_score,
-								gap_penalty,
-								"NUC4.4",
-								strlen(sequence_alignment),
-								identicals,
-								(gaps_X + gaps_Y),
-								mismatches,
-								sequence_alignment,
-								query_sequence_alignment,
-								alignment_phred_scores);
-				if(ferror(file_fd)) {
-					perror("handle_fastq_tsv(): fprintf(): error");
-			
-					fclose(file_fd);
-				
-					//immediately exit
-					exit(2);
-				}
-
-				//flush the file stream
-				fflush(file_fd);
-
-				//free sequence alignment string allocations
-				free(alignment_phred_scores);
-				free(sequence_alignment);
-				free(query_sequence_alignment);
-
-				//prevent double free() calls by assigning freed memory pointers to NULL
-				alignment_phred_scores = NULL;
-
-				//free memory allocations until next sequence
-				free(phred_scores);
-				free(sequence);
-				free(sequence_id);
-
-				//don't call free() twice
-				phred_scores = NULL;
-				sequence = NULL;
-				sequence_id = NULL;
-
-				if (!(line_count & 0x03ff)) {
-					//checkpoint after (1024 / 4) = 256 sequences
-					assert(clock_gettime(CLOCK_MONOTONIC, &current_time) == 0);
-					time_elapsed = compute_time_elapsed(&start_time, &current_time);
-		
-					printf("[%11.2lf seconds]: %lld sequences parsed\n", time_elapsed, line_count >> 2);
-				}
-			}
-			//else {}//ignore the third line
-		}
-		current_index++;
+	if (writer.failed) {
+		options->status = 2;
 	}
 
 	//close file descriptor
-	fclose(file_fd);
+	fclose(writer.file_fd);
 
-	//free C string allocations
-	free(reverse_complement_sequence);
+	//the output is complete, a checkpoint is no longer needed
+	finish_checkpoint(&checkpoint, (options->status == 0));
 
 	//checkpoint after finishing parsing
-	assert(clock_gettime(CLOCK_MONOTONIC, &current_time) == 0);
-	time_elapsed = compute_time_elapsed(&start_time, &current_time);
-	
-	printf("[%11.2lf seconds]: %lld sequences parsed\n", time_elapsed, line_count >> 2);
+	if (writer.show_progress) {
+		print_progress(&writer.start_time, sequence_count);
+	}
 
-	return;
+	return sequence_count;
+}
+/*
+	bool report_batch(gqss_alignment_batch* batch, void* user_data)
+
+	report_batch() prints the progress of 'batch' for the --type=none output, 'user_data' is the start time.
+*/
+static bool report_batch(gqss_alignment_batch* batch, void* user_data) {
+	print_batch_progress((struct timespec *)user_data, batch);
+	return true;
+}
+
+/*
+	uint64_t handle_fastq_none(ednafull_options* options, ednafull_input* input, ednafull_query* query)
+
+	handle_fastq_none() aligns the FASTQ data without writing the alignments, only the --matched-out and --unmatched-out
+	FASTQ files are written. The function returns the number of sequences parsed.
+*/
+static uint64_t handle_fastq_none(ednafull_options* options, ednafull_input* input, ednafull_query* query) {
+	struct timespec start_time;
+
+	//no output file, no checkpoint
+	ednafull_checkpoint checkpoint;
+	memset(&checkpoint, 0, sizeof(ednafull_checkpoint));
+
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+	uint64_t sequence_count = align_ednafull_input(input, options, query, &checkpoint, (options->show_progress ? report_batch : NULL), &start_time);
+
+	if (options->show_progress) {
+		print_progress(&start_time, sequence_count);
+	}
+	return sequence_count;
 }
 
 /*
@@ -641,272 +597,602 @@ static char * get_first_string_token_space_delimited(char* s) {
 	}
 }
 
+typedef struct pair_writer {
+	FILE* file_fd;
+	ednafull_checkpoint* checkpoint;
+	char* query_sequence_identifier;
+	char* reverse_complement_query_sequence_identifier;
+	int64_t gap_penalty;
+	bool show_progress;
+	struct timespec start_time;
+	ednafull_stats* stats;
+	bool failed;
+
+	//null terminated copy of the current FASTQ sequence identifier
+	char* sequence_identifier;
+	size_t sequence_identifier_capacity;
+} pair_writer;
+
 /*
-	void handle_fastq_pair(char* fastq_filename, char* fastq_data, char* query_sequence_identifier, char* query_sequence, int64_t gap_penalty)
+	bool write_pair_alignment(FILE* file_fd, char* alignment_pair)
 
-	handle_fastq_pair() parses the FASTQ file and writes the results in a pair-wise sequence format (pair).
+	write_pair_alignment() writes the pair-wise sequence alignment to file and frees the 'alignment_pair' C string. The
+	function returns false if writing failed.
 */
-void handle_fastq_pair(char* fastq_filename, char* fastq_data, char* query_sequence_identifier, char* query_sequence, int64_t gap_penalty) {
-	assert(fastq_filename != NULL);
+static bool write_pair_alignment(FILE* file_fd, char* alignment_pair) {
+	if (alignment_pair == NULL) {
+		printf("error: write_pair_alignment(): failed to format pair-wise sequence alignment!\n");
+
+		fclose(file_fd);
 
-	size_t total_bytes = strlen(fastq_data);
-	size_t current_index = 0;
+		//immediately exit
+		exit(1);
+	}
 
-	uint64_t line_count = 0;
-	size_t last_newline = 0;
-	size_t current_line_length = 0;
+	fprintf(file_fd, "%s", alignment_pair);
 
-	char* sequence_id = NULL;
-	char* sequence = NULL;
-	char* phred_scores = NULL;
+	//free pair-wise sequence alignment C string allocation
+	free(alignment_pair);
 
-	char* sequence_alignment;
-	char* query_sequence_alignment;
-	char* alignment_phred_scores = NULL;
-	size_t alignment_phred_scores_length;
+	if(ferror(file_fd)) {
+		perror("write_pair_alignment(): fprintf(): error");
+		return false;
+	}
+	return true;
+}
 
-	char* reverse_complement_sequence = get_reverse_complement(query_sequence);
+/*
+	bool write_pair_batch(gqss_alignment_batch* batch, void* user_data)
 
-	int64_t smith_waterman_score;
-	int64_t reverse_complement_smith_waterman_score;
+	write_pair_batch() writes the pair-wise alignment of the query and of the reverse complement query for every record
+	of 'batch' to the pair file. If writing failed, 'failed' is set and the stream is stopped.
+*/
+static bool write_pair_batch(gqss_alignment_batch* batch, void* user_data) {
+	pair_writer* writer = (pair_writer *)user_data;
 
-	size_t query_sequence_start;
-	size_t query_sequence_stop;
-	size_t sequence_start;
-	size_t sequence_stop;
+	uint64_t start_nanoseconds = (writer->stats != NULL) ? get_ednafull_stats_clock() : 0;
 
-	//keep track of FASTQ format row as a variable
-	size_t sequence_row;
+	for (size_t i = 0; i < batch->count; i++) {
+		gqss_fastq_record* record = &(batch->records[i]);
+		gqss_batch_result* forward = batch->forward;
+		gqss_batch_result* reverse_complement = batch->reverse_complement;
 
-	char* new_filename = (char *)malloc((strlen(fastq_filename) + 8) * sizeof(char));
-	if (new_filename == NULL) {
-		perror("handle_fastq_pair(): malloc(): error");
+		if (record->identifier_length >= writer->sequence_identifier_capacity) {
+			char* sequence_identifier = (char *)realloc(writer->sequence_identifier, (record->identifier_length + 1) * sizeof(char));
+			if (sequence_identifier == NULL) {
+				perror("write_pair_batch(): realloc(): error");
 
-		//immediately exit
-		exit(1);
+				//immediately exit
+				exit(1);
+			}
+			writer->sequence_identifier = sequence_identifier;
+			writer->sequence_identifier_capacity = record->identifier_length + 1;
+		}
+		memcpy(writer->sequence_identifier, record->identifier, (record->identifier_length * sizeof(char)));
+		writer->sequence_identifier[record->identifier_length] = '\0';
+
+		if ((!write_pair_alignment(writer->file_fd, generate_int_linear_gap_penalty_pair_alignment("ednafull_linear_smith_waterman", "NUC.4.4",
+										writer->query_sequence_identifier, writer->sequence_identifier,
+										(forward->read_alignments + forward->alignment_offsets[i]),
+										(forward->query_alignments + forward->alignment_offsets[i]),
+										forward->scores[i], writer->gap_penalty)))
+				|| (!write_pair_alignment(writer->file_fd, generate_int_linear_gap_penalty_pair_alignment("ednafull_linear_smith_waterman", "NUC.4.4",
+										writer->reverse_complement_query_sequence_identifier, writer->sequence_identifier,
+										(reverse_complement->read_alignments + reverse_complement->alignment_offsets[i]),
+										(reverse_complement->query_alignments + reverse_complement->alignment_offsets[i]),
+										reverse_complement->scores[i], writer->gap_penalty)))) {
+			writer->failed = true;
+			return false;
+		}
+	}
+
+	if (writer->stats != NULL) {
+		start_nanoseconds = add_ednafull_stage_time(writer->stats, EDNAFULL_STAGE_FORMAT, start_nanoseconds);
 	}
 
-	//determine new .tsv filename from FASTQ file name
-	memcpy((new_filename + strlen(fastq_filename)), ".sw.pair", (9 * sizeof(char)));
-	memcpy(new_filename, fastq_filename, (strlen(fastq_filename) * sizeof(char)));
+	//flush the file stream
+	fflush(writer->file_fd);
 
-	printf("Writing pair-wise sequence alignments to \"%s\"\n", new_filename);
+	if (writer->stats != NULL) {
+		add_ednafull_stage_time(writer->stats, EDNAFULL_STAGE_WRITE, start_nanoseconds);
+	}
 
-	FILE* file_fd = fopen(new_filename, "wb");
-	if (file_fd == NULL) {
-		perror("handle_fastq_pair(): fopen(): error");
+	if (!update_checkpoint(writer->checkpoint, batch)) {
+		writer->failed = true;
+		return false;
+	}
 
-		//immediately exit
-		exit(2);
+	if (writer->show_progress) {
+		print_batch_progress(&writer->start_time, batch);
 	}
+	return true;
+}
+
+/*
+	uint64_t handle_fastq_pair(ednafull_options* options, ednafull_input* input, ednafull_query* query)
+
+	handle_fastq_pair() parses the FASTQ data and writes the results in the EMBOSS pair format. The function returns the number
+	of sequences parsed, 'options->status' is set if the pair file could not be written.
+*/
+uint64_t handle_fastq_pair(ednafull_options* options, ednafull_input* input, ednafull_query* query) {
+	assert(options->fastq_filename != NULL);
+
+	ednafull_checkpoint checkpoint;
+
+	pair_writer writer;
+	writer.checkpoint = &checkpoint;
+	writer.show_progress = options->show_progress;
+	writer.stats = options->stats;
+	writer.query_sequence_identifier = query->identifier;
+	writer.gap_penalty = options->gap_penalty;
+	writer.sequence_identifier = NULL;
+	writer.sequence_identifier_capacity = 0;
+	writer.failed = false;
+
+	char* new_filename = get_output_filename(options, ".sw.pair");
+
+	printf("Writing pair-wise sequence alignments to \"%s\"\n", new_filename);
+
+	writer.file_fd = open_checkpointed_output(&checkpoint, options, query, new_filename, input->length);
 
 	//free filename string allocation
 	free(new_filename);
 
-	//start measuring time between sequences
-	struct timespec start_time;
-	struct timespec current_time;
-	double time_elapsed;
-
-	char* alignment_pair = NULL;
+	if (writer.file_fd == NULL) {
+		return 0;
+	}
 
-	char* query_sequence_id_token = get_first_string_token_space_delimited(query_sequence_identifier);
-	assert(query_sequence_id_token != NULL);
+	char* query_sequence_id_token = get_first_string_token_space_delimited(query->identifier);
+	if (query_sequence_id_token == NULL) {
+		//immediately exit
+		exit(1);
+	}
 
 	size_t reverse_complement_query_sequence_identifier_length = 19 + strlen(query_sequence_id_token);
-	char* reverse_complement_query_sequence_identifier = (char *)malloc((20 + strlen(query_sequence_id_token)) * sizeof(char));
-	if (reverse_complement_query_sequence_identifier == NULL) {
+	writer.reverse_complement_query_sequence_identifier = (char *)malloc((20 + strlen(query_sequence_id_token)) * sizeof(char));
+	if (writer.reverse_complement_query_sequence_identifier == NULL) {
 		perror("handle_fastq_pair(): malloc(): error");
 
 		//immediately exit
 		exit(1);
 	}
 
-	memcpy(reverse_complement_query_sequence_identifier, ">Reverse_Complement_", (20 * sizeof(char)));
-	memcpy(reverse_complement_query_sequence_identifier + 20, (query_sequence_id_token + 1), ((strlen(query_sequence_id_token) - 1) * sizeof(char)));
-	reverse_complement_query_sequence_identifier[reverse_complement_query_sequence_identifier_length] = '\0';
+	memcpy(writer.reverse_complement_query_sequence_identifier, ">Reverse_Complement_", (20 * sizeof(char)));
+	memcpy(writer.reverse_complement_query_sequence_identifier + 20, (query_sequence_id_token + 1), ((strlen(query_sequence_id_token) - 1) * sizeof(char)));
+	writer.reverse_complement_query_sequence_identifier[reverse_complement_query_sequence_identifier_length] = '\0';
 
 	//free query sequence identifier token string allocation
 	free(query_sequence_id_token);
 
-	assert(clock_gettime(CLOCK_MONOTONIC, &start_time) == 0);
-
-	while (current_index < total_bytes) {
-		if (fastq_data[current_index] == '\n') {
-			line_count++;
-			current_line_length = current_index - last_newline;
-			last_newline = current_index + 1;
+	//start measuring time between sequences
+	clock_gettime(CLOCK_MONOTONIC, &writer.start_time);
 
-			sequence_row = line_count % 4;
-			if (sequence_row == 1) {
-				//FASTQ sequence identifier
-				sequence_id = extract_line(fastq_data, current_index, current_line_length);
-			}
-			else if (sequence_row == 2) {
-				//FASTQ sequence
-				sequence = extract_line(fastq_data, current_index, current_line_length);
-			}
-			else if (sequence_row == 0) {
-				//FASTQ quality scores
-				phred_scores = extract_line(fastq_data, current_index, current_line_length);
-
-				//run Smith-Waterman algorithm with linear gap
-				smith_waterman_score = get_linear_gap_smith_waterman_score(query_sequence, sequence, &sequence_alignment, &query_sequence_alignment, &query_sequence_start, &sequence_start, &query_sequence_stop, &sequence_stop, gap_penalty);
-
-				//format the sequence alignment output before writing to file
-				alignment_pair = generate_int_linear_gap_penalty_pair_alignment("ednafull_linear_smith_waterman", "NUC.4.4", query_sequence_identifier, sequence_id, query_sequence_alignment, sequence_alignment, smith_waterman_score, gap_penalty);
-
-				fprintf(file_fd, "%s", alignment_pair);
-				if(ferror(file_fd)) {
-					perror("handle_fastq_pair(): fprintf(): error");
-			
-					fclose(file_fd);
-			
-					//immediately exit
-					exit(2);
-				}
-
-				//free pair-wise sequence alignment C string allocation
-				free(alignment_pair);
-
-				//flush the file stream
-				fflush(file_fd);
-
-				//free sequence alignment string allocations
-				free(sequence_alignment);
-				free(query_sequence_alignment);
-
-				//prevent double free() calls by assigning freed memory pointers to NULL
-				alignment_pair = NULL;
-				sequence_alignment = NULL;
-				query_sequence_alignment = NULL;
-
-				//compute the reverse complement sequence alignment
-				reverse_complement_smith_waterman_score = get_linear_gap_smith_waterman_score(reverse_complement_sequence, sequence, &sequence_alignment, &query_sequence_alignment, &query_sequence_start, &sequence_start, &query_sequence_stop, &sequence_stop, gap_penalty);
-
-				//format the sequence alignment output before writing to file
-				alignment_pair = generate_int_linear_gap_penalty_pair_alignment("ednafull_linear_smith_waterman", "NUC.4.4", reverse_complement_query_sequence_identifier, sequence_id, query_sequence_alignment, sequence_alignment, reverse_complement_smith_waterman_score, gap_penalty);
-
-				fprintf(file_fd, "%s", alignment_pair);
-				if(ferror(file_fd)) {
-					perror("handle_fastq_pair(): fprintf(): error");
-			
-					fclose(file_fd);
-				
-					//immediately exit
-					exit(2);
-				}
-
-				//flush the file stream
-				fflush(file_fd);
-
-				//free pair-wise sequence alignment C string allocation
-				free(alignment_pair);
-
-				//free sequence alignment string allocations
-				free(sequence_alignment);
-				free(query_sequence_alignment);
-
-				//prevent double free() calls by assigning freed memory pointers to NULL
-				alignment_pair = NULL;
-				sequence_alignment = NULL;
-				query_sequence_alignment = NULL;
-
-				//free memory allocations until next sequence
-				free(phred_scores);
-				free(sequence);
-				free(sequence_id);
-
-				//don't call free() twice
-				phred_scores = NULL;
-				sequence = NULL;
-				sequence_id = NULL;
-
-				if (!(line_count & 0x03ff)) {
-					//checkpoint after (1024 / 4) = 256 sequences
-					assert(clock_gettime(CLOCK_MONOTONIC, &current_time) == 0);
-					time_elapsed = compute_time_elapsed(&start_time, &current_time);
-		
-					printf("[%11.2lf seconds]: %lld sequences parsed\n", time_elapsed, line_count >> 2);
-				}
-			}
-			//else {}//ignore the third line
-		}
-		current_index++;
+	uint64_t sequence_count = align_ednafull_input(input, options, query, &checkpoint, write_pair_batch, &writer);
+	if (writer.failed) {
+		options->status = 2;
 	}
 
 	//close file descriptor
-	fclose(file_fd);
+	fclose(writer.file_fd);
+
+	//the output is complete, a checkpoint is no longer needed
+	finish_checkpoint(&checkpoint, (options->status == 0));
 
 	//free C string allocations
-	free(reverse_complement_sequence);
-	free(reverse_complement_query_sequence_identifier);
+	free(writer.sequence_identifier);
+	free(writer.reverse_complement_query_sequence_identifier);
 
 	//checkpoint after finishing parsing
-	assert(clock_gettime(CLOCK_MONOTONIC, &current_time) == 0);
-	time_elapsed = compute_time_elapsed(&start_time, &current_time);
-	
-	printf("[%11.2lf seconds]: %lld sequences parsed\n", time_elapsed, line_count >> 2);
+	if (writer.show_progress) {
+		print_progress(&writer.start_time, sequence_count);
+	}
 
-	return;
+	return sequence_count;
+}
+
+/*
+	bool is_regular_file(char* filename)
+
+	is_regular_file() checks if 'filename' is a regular file, which can be mapped into memory.
+*/
+static bool is_regular_file(char* filename) {
+	struct stat file_stat;
+	return (stat(filename, &file_stat) == 0) && S_ISREG(file_stat.st_mode);
+}
+
+/*
+	bool is_fastq_filename(char* filename)
+
+	is_fastq_filename() checks the file name extension ".fq" or ".fastq" of a regular file. The standard input, pipes and
+	devices are accepted with any name.
+*/
+static bool is_fastq_filename(char* filename) {
+	struct stat fastq_stat;
+
+	if (strcmp(filename, EDNAFULL_STANDARD_STREAM) == 0) {
+		return true;
+	}
+	if ((stat(filename, &fastq_stat) == 0) && (!S_ISREG(fastq_stat.st_mode))) {
+		return true;
+	}
+	return (strstr(filename, ".fq") != NULL) || (strstr(filename, ".fastq") != NULL);
+}
+
+/*
+	bool add_fastq_filenames(ednafull_options* options, char** arguments, size_t argument_count)
+
+	add_fastq_filenames() assigns the FASTQ file names given as arguments, followed by the ones listed in the --input-list
+	file (one file name per line, empty lines are skipped), to 'options'. The function returns false if the list file could
+	not be read.
+*/
+static bool add_fastq_filenames(ednafull_options* options, char** arguments, size_t argument_count) {
+	size_t list_length = 0;
+	size_t line_count = 0;
+
+	if (options->input_list_filename != NULL) {
+		options->input_list_data = read_file(options->input_list_filename);
+		if (options->input_list_data == NULL) {
+			printf("ednafull_linear_smith_waterman: option --input-list: failed to read \"%s\".\n", options->input_list_filename);
+			return false;
+		}
+
+		//the last line may lack a newline character
+		list_length = strlen(options->input_list_data);
+		for (size_t i = 0; i < list_length; i++) {
+			if (options->input_list_data[i] == '\n') {
+				line_count++;
+			}
+		}
+		line_count++;
+	}
+
+	options->fastq_filenames = (char **)malloc((argument_count + line_count) * sizeof(char *));
+	if (options->fastq_filenames == NULL) {
+		perror("add_fastq_filenames(): malloc(): error");
+		return false;
+	}
+
+	for (size_t i = 0; i < argument_count; i++) {
+		options->fastq_filenames[options->fastq_count] = arguments[i];
+		options->fastq_count++;
+	}
+
+	//split the list into null terminated lines in place
+	char* line = options->input_list_data;
+	for (size_t i = 0; i < line_count; i++) {
+		char* line_end = strchr(line, '\n');
+		if (line_end != NULL) {
+			*line_end = '\0';
+		}
+
+		size_t line_length = strlen(line);
+		if ((line_length > 0) && (line[line_length - 1] == '\r')) {
+			line[line_length - 1] = '\0';
+			line_length--;
+		}
+
+		if (line_length > 0) {
+			options->fastq_filenames[options->fastq_count] = line;
+			options->fastq_count++;
+		}
+
+		if (line_end == NULL) {
+			break;
+		}
+		line = line_end + 1;
+	}
+	return true;
 }
 
 /*
-	parse_ednafull_linear_smith_waterman_options(int argc, char* argv[], char** query_sequence, char** sequence, int64_t* gap_penalty)
+	parse_ednafull_linear_smith_waterman_options(int argc, char* argv[], ednafull_options* options)
 
 	parse_ednafull_linear_smith_waterman_options() parses the application's given arguments. This function returns 0 when no
 	problems were encountered during parsing. Otherwise, parse_ednafull_linear_smith_waterman_options() returns 1 on failure.
 */
-static int parse_ednafull_linear_smith_waterman_options(int argc, char* argv[], char** query_sequence, char** sequence, int64_t* gap_penalty, unsigned int* output_flag) {
+static int parse_ednafull_linear_smith_waterman_options(int argc, char* argv[], ednafull_options* options) {
 	int getopt_index = 0;
 	int c;
 
-	*query_sequence = NULL;
-	*sequence = NULL;
-
-	while ((c = getopt_long(argc, argv, "q:P:hv", getopt_long_options, &getopt_index)) != -1) {
+	options->query_count = 0;
+	options->fastq_filename = NULL;
+	options->socket_filename = NULL;
+	options->gap_penalty = 16;
+	options->output_flag = OUTPUT_TSV;
+	options->thread_count = 1;
+	options->shard_index = 1;
+	options->shard_count = 1;
+	options->checkpoint_interval = EDNAFULL_CHECKPOINT_INTERVAL;
+	options->resume = false;
+	options->follow = false;
+	options->follow_timeout = EDNAFULL_FOLLOW_TIMEOUT;
+	options->follow_sentinel = NULL;
+	options->output_filename = NULL;
+	options->standard_output = NULL;
+	options->fastq_filenames = NULL;
+	options->fastq_count = 0;
+	options->input_list_filename = NULL;
+	options->input_list_data = NULL;
+	options->parallel_files = 0;
+	options->show_progress = true;
+	options->mate_filename = NULL;
+	options->interleaved = false;
+	options->max_fragment_length = EDNAFULL_MAX_FRAGMENT_LENGTH;
+	options->matched_filename = NULL;
+	options->unmatched_filename = NULL;
+	options->min_score = EDNAFULL_MIN_SCORE;
+	options->demux_directory = NULL;
+	options->max_open_files = EDNAFULL_DEMUX_MAX_OPEN_FILES;
+	options->coverage_filename = NULL;
+	options->top_k = 0;
+	options->top_k_heap = NULL;
+	options->max_hits = 0;
+	options->hit_limit = NULL;
+	options->stopped = false;
+	options->status = 0;
+	options->sample_fraction = 1.0;
+	options->sample_count = 0;
+	options->sample_every = 0;
+	options->sample_seed = 0;
+	options->stats = NULL;
+	options->stats_enabled = false;
+	options->report_filename = NULL;
+
+	while ((c = getopt_long(argc, argv, "q:P:t:o:hv", getopt_long_options, &getopt_index)) != -1) {
 		switch (c) {
 			case 0:
-				if (strcmp(getopt_long_options[getopt_index].name, "type") == 0) {
-					if (strcmp(optarg, "tsv") == 0) {
-						*output_flag = OUTPUT_TSV;
+				if (strcmp(getopt_long_options[getopt_index].name, "serve") == 0) {
+					//check if socket file name is an empty string
+					if (strlen(optarg) == 0) {
+						printf("ednafull_linear_smith_waterman: option --serve: socket file name cannot be an empty string.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
 					}
-					else if (strcmp(optarg, "pair") == 0) {
-						*output_flag = OUTPUT_PAIR;
+					options->socket_filename = optarg;
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "shard") == 0) {
+					char shard_end;
+					if ((sscanf(optarg, "%zu/%zu%c", &options->shard_index, &options->shard_count, &shard_end) != 2)
+							|| (options->shard_index == 0) || (options->shard_index > options->shard_count)) {
+						printf("ednafull_linear_smith_waterman: option --shard: expected i/N with 1 <= i <= N.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
 					}
-					else {
-						printf("ednafull_linear_smith_waterman: option --type: valid types are 'tsv' and 'pair'.\n");
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "checkpoint-interval") == 0) {
+					if (sscanf(optarg, "%" SCNu64, &options->checkpoint_interval) != 1) {
+						printf("ednafull_linear_smith_waterman: option --checkpoint-interval: could not parse the given integer parameter.\n");
 						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
 						return 1;
 					}
 				}
-				break;
-			case 'q':
-				//check if query file name is an empty string
-				if (strlen(optarg) == 0) {
-					printf("ednafull_linear_smith_waterman: option -q, --query: FASTA query file name cannot be an empty string.\n");
-					printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
-					return 1;
+				else if (strcmp(getopt_long_options[getopt_index].name, "resume") == 0) {
+					options->resume = true;
 				}
-				//assign filename
-				*query_sequence = optarg;
-				break;
-			case 'h':
-				printf("%s", HELP_STRING);
-				exit(0);
-				break;
-			case 'v':
-				printf("%s", VERSION_STRING);
-				exit(0);
-				break;
-			case 'P':
+				else if (strcmp(getopt_long_options[getopt_index].name, "input-list") == 0) {
+					//check if list file name is an empty string
+					if (strlen(optarg) == 0) {
+						printf("ednafull_linear_smith_waterman: option --input-list: list file name cannot be an empty string.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+					}
+					options->input_list_filename = optarg;
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "parallel-files") == 0) {
+					if ((sscanf(optarg, "%zu", &options->parallel_files) != 1) || (options->parallel_files == 0)) {
+						printf("ednafull_linear_smith_waterman: option --parallel-files: expected a positive integer.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+					}
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "mate") == 0) {
+					//check if mate file name is an empty string
+					if (strlen(optarg) == 0) {
+						printf("ednafull_linear_smith_waterman: option --mate: mate FASTQ file name cannot be an empty string.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+					}
+					options->mate_filename = optarg;
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "interleaved") == 0) {
+					options->interleaved = true;
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "max-fragment-length") == 0) {
+					if ((sscanf(optarg, "%zu", &options->max_fragment_length) != 1) || (options->max_fragment_length == 0)) {
+						printf("ednafull_linear_smith_waterman: option --max-fragment-length: expected a positive integer.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+					}
+				}
+				else if ((strcmp(getopt_long_options[getopt_index].name, "matched-out") == 0)
+						|| (strcmp(getopt_long_options[getopt_index].name, "unmatched-out") == 0)) {
+					//check if FASTQ output file name is an empty string
+					if (strlen(optarg) == 0) {
+						printf("ednafull_linear_smith_waterman: option --%s: FASTQ file name cannot be an empty string.\n", getopt_long_options[getopt_index].name);
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+					}
+					if (getopt_long_options[getopt_index].name[0] == 'm') {
+						options->matched_filename = optarg;
+					}
+					else {
+						options->unmatched_filename = optarg;
+					}
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "min-score") == 0) {
+					if (sscanf(optarg, "%" SCNd64, &options->min_score) != 1) {
+						printf("ednafull_linear_smith_waterman: option --min-score: could not parse the given integer parameter.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+					}
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "summary-only") == 0) {
+					options->output_flag = OUTPUT_SUMMARY;
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "stats") == 0) {
+					options->stats_enabled = true;
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "report") == 0) {
+					//check if report file name is an empty string
+					if (strlen(optarg) == 0) {
+						printf("ednafull_linear_smith_waterman: option --report: report file name cannot be an empty string.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+					}
+					options->report_filename = optarg;
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "coverage") == 0) {
+					//check if coverage file name is an empty string
+					if (strlen(optarg) == 0) {
+						printf("ednafull_linear_smith_waterman: option --coverage: coverage file name cannot be an empty string.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+					}
+					options->coverage_filename = optarg;
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "top-k") == 0) {
+					if ((sscanf(optarg, "%zu", &options->top_k) != 1) || (options->top_k == 0)) {
+						printf("ednafull_linear_smith_waterman: option --top-k: expected a positive integer.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+					}
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "max-hits") == 0) {
+					if ((sscanf(optarg, "%" SCNu64, &options->max_hits) != 1) || (options->max_hits == 0)) {
+						printf("ednafull_linear_smith_waterman: option --max-hits: expected a positive integer.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+					}
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "sample-fraction") == 0) {
+					if ((sscanf(optarg, "%lf", &options->sample_fraction) != 1) || (!(options->sample_fraction > 0.0)) || (options->sample_fraction > 1.0)) {
+						printf("ednafull_linear_smith_waterman: option --sample-fraction: expected a fraction F with 0 < F <= 1.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+					}
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "sample-count") == 0) {
+					if ((sscanf(optarg, "%" SCNu64, &options->sample_count) != 1) || (options->sample_count == 0)) {
+						printf("ednafull_linear_smith_waterman: option --sample-count: expected a positive integer.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+					}
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "sample-every") == 0) {
+					if ((sscanf(optarg, "%" SCNu64, &options->sample_every) != 1) || (options->sample_every == 0)) {
+						printf("ednafull_linear_smith_waterman: option --sample-every: expected a positive integer.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+					}
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "seed") == 0) {
+					if (sscanf(optarg, "%" SCNu64, &options->sample_seed) != 1) {
+						printf("ednafull_linear_smith_waterman: option --seed: could not parse the given integer parameter.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+					}
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "demux") == 0) {
+					//check if directory name is an empty string
+					if (strlen(optarg) == 0) {
+						printf("ednafull_linear_smith_waterman: option --demux: directory name cannot be an empty string.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+					}
+					options->demux_directory = optarg;
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "max-open-files") == 0) {
+					if ((sscanf(optarg, "%zu", &options->max_open_files) != 1) || (options->max_open_files == 0)) {
+						printf("ednafull_linear_smith_waterman: option --max-open-files: expected a positive integer.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+					}
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "follow") == 0) {
+					options->follow = true;
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "follow-timeout") == 0) {
+					if (sscanf(optarg, "%u", &options->follow_timeout) != 1) {
+						printf("ednafull_linear_smith_waterman: option --follow-timeout: could not parse the given integer parameter.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+					}
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "follow-sentinel") == 0) {
+					//check if sentinel file name is an empty string
+					if (strlen(optarg) == 0) {
+						printf("ednafull_linear_smith_waterman: option --follow-sentinel: sentinel file name cannot be an empty string.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+					}
+					options->follow_sentinel = optarg;
+				}
+				else if (strcmp(getopt_long_options[getopt_index].name, "type") == 0) {
+					if (strcmp(optarg, "tsv") == 0) {
+						options->output_flag = OUTPUT_TSV;
+					}
+					else if (strcmp(optarg, "pair") == 0) {
+						options->output_flag = OUTPUT_PAIR;
+					}
+					else if (strcmp(optarg, "none") == 0) {
+						options->output_flag = OUTPUT_NONE;
+					}
+					else {
+						printf("ednafull_linear_smith_waterman: option --type: valid types are 'tsv', 'pair' and 'none'.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+					}
+				}
+				break;
+			case 'q':
+				//check if query file name is an empty string
+				if (strlen(optarg) == 0) {
+					printf("ednafull_linear_smith_waterman: option -q, --query: FASTA query file name cannot be an empty string.\n");
+					printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+					return 1;
+				}
+				if (options->query_count == EDNAFULL_MAX_QUERIES) {
+					printf("ednafull_linear_smith_waterman: option -q, --query: at most %d query files can be given.\n", EDNAFULL_MAX_QUERIES);
+					printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+					return 1;
+				}
+				//assign filename
+				options->query_filenames[options->query_count] = optarg;
+				options->query_count++;
+				break;
+			case 'o':
+				//check if output file name is an empty string
+				if (strlen(optarg) == 0) {
+					printf("ednafull_linear_smith_waterman: option -o, --output: output file name cannot be an empty string.\n");
+					printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+					return 1;
+				}
+				options->output_filename = optarg;
+				break;
+			case 'h':
+				printf("%s", HELP_STRING);
+				exit(0);
+				break;
+			case 'v':
+				printf("%s", VERSION_STRING);
+				exit(0);
+				break;
+			case 'P':
 				//assign given gap penalty
-				if (sscanf(optarg, "%lld", gap_penalty) == EOF) {
+				if (sscanf(optarg, "%" SCNd64, &options->gap_penalty) != 1) {
 					printf("ednafull_linear_smith_waterman: option -P, --gap-penalty: could not parse the given integer parameter.");
 					printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
 					return 1;
 				}
 				break;
+			case 't':
+				//assign given number of worker threads
+				if ((sscanf(optarg, "%zu", &options->thread_count) != 1) || (options->thread_count == 0)) {
+					printf("ednafull_linear_smith_waterman: option -t, --threads: expected a positive integer.\n");
+					printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+					return 1;
+				}
+				break;
 			case '?':
 				switch (optopt) {
 					case 'q':
@@ -919,6 +1205,16 @@ static int parse_ednafull_linear_smith_waterman_options(int argc, char* argv[],
 						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
 						return 1;
 						break;
+					case 't':
+						printf("ednafull_linear_smith_waterman: option -t, --threads: missing number of threads parameter.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+						break;
+					case 'o':
+						printf("ednafull_linear_smith_waterman: option -o, --output: missing output file name parameter.\n");
+						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+						return 1;
+						break;
 					default:
 						printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
 						return 1;
@@ -933,78 +1229,1204 @@ static int parse_ednafull_linear_smith_waterman_options(int argc, char* argv[],
 		}
 	}
 
-	if (*query_sequence == NULL) {
+	if (options->query_count == 0) {
 		printf("ednafull_linear_smith_waterman: expected query sequence file!\n");
 		printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
 		return 1;
 	}
-	
-	if (argc - optind == 1) {
 
-		if ((strstr(argv[optind], ".fq") == NULL) && (strstr(argv[optind], ".fastq") == NULL)) {
-			printf("ednafull_linear_smith_waterman: could not find expected FASTQ file!\n");
+	if (options->socket_filename != NULL) {
+		//the server receives the FASTQ data from its clients
+		if ((options->shard_count > 1) || (options->demux_directory != NULL) || options->stats_enabled || (options->report_filename != NULL)) {
+			printf("ednafull_linear_smith_waterman: options --shard, --demux, --stats and --report cannot be combined with --serve.\n");
 			printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
 			return 1;
 		}
-		*sequence = argv[optind];
+
+		//every job is written as TSV rows of all its records, the options of a run's outputs and records do not apply
+		bool sampled = (options->sample_fraction < 1.0) || (options->sample_count > 0) || (options->sample_every > 0);
+		if ((options->output_flag != OUTPUT_TSV) || (options->top_k > 0) || (options->max_hits > 0) || sampled
+				|| (options->matched_filename != NULL) || (options->unmatched_filename != NULL) || (options->coverage_filename != NULL)
+				|| options->resume || options->follow || (options->output_filename != NULL) || (options->input_list_filename != NULL)
+				|| (options->mate_filename != NULL) || options->interleaved) {
+			printf("ednafull_linear_smith_waterman: options --type=pair/none, --summary-only, --top-k, --max-hits, --sample-*, --matched-out, --unmatched-out, --coverage, --resume, --follow, -o, --input-list, --mate and --interleaved cannot be combined with --serve.\n");
+			printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+			return 1;
+		}
+		if (argc - optind != 0) {
+			printf("ednafull_linear_smith_waterman: option --serve: found unexpected FASTQ file argument!\n");
+			printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+			return 1;
+		}
+		return 0;
 	}
-	else {
+
+	if (options->follow && (options->shard_count > 1)) {
+		printf("ednafull_linear_smith_waterman: option --shard cannot be combined with --follow.\n");
+		printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+		return 1;
+	}
+
+	if (options->follow && (options->follow_timeout == 0) && (options->follow_sentinel == NULL)) {
+		printf("ednafull_linear_smith_waterman: option --follow: expected --follow-sentinel or a --follow-timeout.\n");
+		printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+		return 1;
+	}
+
+	if ((options->query_count > 1) && (options->demux_directory == NULL)) {
+		printf("ednafull_linear_smith_waterman: option -q, --query: multiple query files are only supported with --serve and --demux.\n");
+		printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+		return 1;
+	}
+	
+	if (!add_fastq_filenames(options, (argv + optind), (size_t)(argc - optind))) {
+		return 1;
+	}
+
+	if (options->fastq_count == 0) {
 		printf("ednafull_linear_smith_waterman: found unexpected number of arguments!\n");
 		printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
 		return 1;
 	}
 
-	return 0;
-}
+	for (size_t i = 0; i < options->fastq_count; i++) {
+		if (!is_fastq_filename(options->fastq_filenames[i])) {
+			printf("ednafull_linear_smith_waterman: could not find expected FASTQ file!\n");
+			printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+			return 1;
+		}
 
-int main(int argc, char* argv[]) {
-	int64_t gap_penalty = 16;
-	char* sequence_filename;
-	char* query_sequence_filename;
-	unsigned int output_flag;
+		if ((options->fastq_count > 1) && (strcmp(options->fastq_filenames[i], EDNAFULL_STANDARD_STREAM) == 0)) {
+			printf("ednafull_linear_smith_waterman: the standard input cannot be combined with other FASTQ files.\n");
+			printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+			return 1;
+		}
+	}
+	options->fastq_filename = options->fastq_filenames[0];
 
-	int parse_status = parse_ednafull_linear_smith_waterman_options(argc, argv, &query_sequence_filename, &sequence_filename, &gap_penalty, &output_flag);
-	
-	if (parse_status == 0) {
-		char* fasta_sequence_identifier;
-		char* query;
-		char* fasta_data = read_file(query_sequence_filename);
-		size_t fasta_bytes_parsed = extract_fasta_sequence(fasta_data, &fasta_sequence_identifier, &query);
-		if (query == NULL) {
-			printf("error: failed to read FASTA query sequence!\n");
-
-			free(fasta_data);
-			free(fasta_sequence_identifier);
+	if (options->fastq_count > 1) {
+		//every FASTQ file has its own output file, except for the best records of all files
+		if ((options->top_k > 0) && (options->output_filename == NULL)) {
+			printf("ednafull_linear_smith_waterman: option --top-k: expected -o, --output for several FASTQ files.\n");
+			printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+			return 1;
+		}
+		if ((options->output_filename != NULL) && (options->top_k == 0)) {
+			printf("ednafull_linear_smith_waterman: option -o, --output: expected a single FASTQ file.\n");
+			printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
 			return 1;
 		}
 
-		printf("Query Sequence Identifier: %s\n", (fasta_sequence_identifier + 1));
+		//the progress of a file is printed once it is complete
+		options->show_progress = false;
+	}
 
-		char* data = read_file(sequence_filename);
-		if (output_flag == OUTPUT_TSV) {
-			handle_fastq_tsv(sequence_filename, data, fasta_sequence_identifier, query, gap_penalty);
+	if ((options->mate_filename != NULL) || options->interleaved) {
+		//mates are paired by their order in the input
+		if ((options->mate_filename != NULL) && options->interleaved) {
+			printf("ednafull_linear_smith_waterman: options --mate and --interleaved cannot be combined.\n");
+			printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+			return 1;
 		}
-		else if (output_flag == OUTPUT_PAIR) {
-			handle_fastq_pair(sequence_filename, data, fasta_sequence_identifier, query, gap_penalty);
+		if ((options->fastq_count > 1) || (options->shard_count > 1) || options->resume || (options->output_flag != OUTPUT_TSV)) {
+			printf("ednafull_linear_smith_waterman: paired-end reads need a single FASTQ file without --shard, --resume or --type=pair.\n");
+			printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+			return 1;
 		}
-		else {
-			printf("error: no output type found!\n");
+		if ((options->mate_filename != NULL) && ((!is_regular_file(options->fastq_filename)) || (!is_regular_file(options->mate_filename)) || options->follow)) {
+			printf("ednafull_linear_smith_waterman: option --mate: expected regular FASTQ files (without --follow).\n");
+			printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+			return 1;
+		}
+	}
 
-			//free allocations
-			free(data);
-			free(query);
-			free(fasta_data);
-			free(fasta_sequence_identifier);
+	if ((options->top_k > 0) && ((options->shard_count > 1) || options->resume || (options->output_flag != OUTPUT_TSV)
+			|| (options->mate_filename != NULL) || options->interleaved || (options->demux_directory != NULL) || (options->coverage_filename != NULL))) {
+		//the records are aligned without their alignments, only the best records are aligned again
+		printf("ednafull_linear_smith_waterman: option --top-k cannot be combined with --shard, --resume, --type, --summary-only, paired-end reads, --demux or --coverage.\n");
+		printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+		return 1;
+	}
+
+	if ((options->max_hits > 0) && (options->resume || (options->top_k > 0) || (options->mate_filename != NULL) || options->interleaved
+			|| (options->demux_directory != NULL))) {
+		//the hits are counted from the start of the input, against the first query, and a batch may end between two mates
+		printf("ednafull_linear_smith_waterman: option --max-hits cannot be combined with --resume, --top-k, paired-end reads or --demux.\n");
+		printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+		return 1;
+	}
+
+	size_t sample_option_count = ((options->sample_fraction < 1.0) ? 1 : 0) + ((options->sample_count > 0) ? 1 : 0) + ((options->sample_every > 0) ? 1 : 0);
+	if (sample_option_count > 1) {
+		printf("ednafull_linear_smith_waterman: options --sample-fraction, --sample-count and --sample-every cannot be combined.\n");
+		printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+		return 1;
+	}
+	if ((sample_option_count > 0) && ((options->mate_filename != NULL) || options->interleaved)) {
+		//the mates of a pair would be sampled independently
+		printf("ednafull_linear_smith_waterman: the --sample-* options cannot be combined with paired-end reads.\n");
+		printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+		return 1;
+	}
+	if (options->sample_count > 0) {
+		//the records are counted and chosen before the alignment starts
+		bool mapped = (options->shard_count == 1) && (!options->resume) && (!options->follow);
+		for (size_t i = 0; mapped && (i < options->fastq_count); i++) {
+			mapped = is_regular_file(options->fastq_filenames[i]);
+		}
+		if (!mapped) {
+			printf("ednafull_linear_smith_waterman: option --sample-count: expected regular FASTQ files (without --shard, --resume or --follow).\n");
+			printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+			return 1;
+		}
+	}
+
+	if ((options->output_flag == OUTPUT_SUMMARY) && ((options->shard_count > 1) || options->resume)) {
+		//the summary is written at the end of a run and cannot be merged
+		printf("ednafull_linear_smith_waterman: option --summary-only cannot be combined with --shard or --resume.\n");
+		printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+		return 1;
+	}
+
+	if ((options->coverage_filename != NULL) && ((options->fastq_count > 1) || options->resume || (options->mate_filename != NULL))) {
+		//the pileup of a run is written once the run is complete
+		printf("ednafull_linear_smith_waterman: option --coverage: expected a single FASTQ file without --resume or --mate.\n");
+		printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+		return 1;
+	}
 
+	if (options->demux_directory != NULL) {
+		//the demultiplexed FASTQ files replace the alignment output and are not checkpointed
+		if ((options->fastq_count > 1) || (options->shard_count > 1) || options->resume || (options->mate_filename != NULL) || options->interleaved
+				|| (options->matched_filename != NULL) || (options->unmatched_filename != NULL)
+				|| (options->output_filename != NULL) || (options->output_flag != OUTPUT_TSV)) {
+			printf("ednafull_linear_smith_waterman: option --demux: expected a single FASTQ file without --shard, --resume, paired-end reads or other outputs.\n");
+			printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
 			return 1;
 		}
+	}
 
-		//free allocations
-		free(data);
-		free(query);
-		free(fasta_data);
-		free(fasta_sequence_identifier);
+	if ((options->matched_filename != NULL) || (options->unmatched_filename != NULL)) {
+		//the FASTQ outputs are not checkpointed and name a single file
+		if ((options->fastq_count > 1) || options->resume || (options->mate_filename != NULL) || options->interleaved) {
+			printf("ednafull_linear_smith_waterman: options --matched-out and --unmatched-out need a single FASTQ file without --resume or paired-end reads.\n");
+			printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+			return 1;
+		}
+	}
+	else if (options->output_flag == OUTPUT_NONE) {
+		printf("ednafull_linear_smith_waterman: option --type=none: expected --matched-out or --unmatched-out.\n");
+		printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+		return 1;
+	}
+
+	if (options->parallel_files == 0) {
+		options->parallel_files = options->thread_count;
+	}
+	if (options->parallel_files > options->fastq_count) {
+		options->parallel_files = options->fastq_count;
+	}
+
+	if (strcmp(options->fastq_filename, EDNAFULL_STANDARD_STREAM) == 0) {
+		if (options->output_filename == NULL) {
+			options->output_filename = EDNAFULL_STANDARD_STREAM;
+		}
+
+		if ((options->shard_count > 1) || options->resume || options->follow) {
+			printf("ednafull_linear_smith_waterman: options --shard, --resume and --follow need a FASTQ file, not the standard input.\n");
+			printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+			return 1;
+		}
+	}
+
+	if ((options->output_filename != NULL) && (strcmp(options->output_filename, EDNAFULL_STANDARD_STREAM) == 0) && options->resume) {
+		printf("ednafull_linear_smith_waterman: option --resume: cannot resume writing to the standard output.\n");
+		printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+		return 1;
+	}
+
+	return 0;
+}
+
+//ednafull_query_list is the growing array of the queries loaded from the -q files
+typedef struct ednafull_query_list {
+	ednafull_query* queries;
+	size_t count;
+	size_t capacity;
+} ednafull_query_list;
+
+/*
+	ednafull_query* add_ednafull_query(ednafull_query_list* list)
+
+	add_ednafull_query() returns the next unused query of 'list', the caller loads it and increments the count. The
+	application exits if memory could not be allocated.
+*/
+static ednafull_query* add_ednafull_query(ednafull_query_list* list) {
+	if (list->count == list->capacity) {
+		size_t capacity = (list->capacity == 0) ? 16 : (2 * list->capacity);
+		ednafull_query* queries = (ednafull_query *)realloc(list->queries, capacity * sizeof(ednafull_query));
+		if (queries == NULL) {
+			perror("add_ednafull_query(): realloc(): error");
+
+			//immediately exit
+			exit(1);
+		}
+		list->queries = queries;
+		list->capacity = capacity;
+	}
+	return &(list->queries[list->count]);
+}
+
+/*
+	bool load_ednafull_query_file(ednafull_query_list* list, char* query_filename, bool all_sequences, int64_t gap_penalty, gqss_thread_pool* pool)
+
+	load_ednafull_query_file() reads the first sequence of the FASTA file 'query_filename', or every sequence if 'all_sequences'
+	is true, and adds it to 'list'. The function returns false if the FASTA file could not be read.
+*/
+static bool load_ednafull_query_file(ednafull_query_list* list, char* query_filename, bool all_sequences, int64_t gap_penalty, gqss_thread_pool* pool) {
+	char* fasta_sequence_identifier;
+	char* query_sequence;
+	char* fasta_data = read_file(query_filename);
+	if (fasta_data == NULL) {
+		printf("error: failed to read FASTA query file!\n");
+		return false;
 	}
 
+	size_t first_query = list->count;
+	size_t fasta_offset = 0;
+	do {
+		//extract_fasta_sequence() returns the index after the extracted sequence
+		size_t sequence_end = extract_fasta_sequence((fasta_data + fasta_offset), &fasta_sequence_identifier, &query_sequence);
+		fasta_offset = fasta_offset + sequence_end;
+
+		if (query_sequence == NULL) {
+			free(fasta_sequence_identifier);
+			break;
+		}
+
+		if (!all_sequences) {
+			printf("Query Sequence Identifier: %s\n", (fasta_sequence_identifier + 1));
+		}
+
+		load_ednafull_query(add_ednafull_query(list), fasta_sequence_identifier, query_sequence, gap_penalty, pool);
+		list->count++;
+	} while (all_sequences && (fasta_data[fasta_offset] != '\0'));
+
+	//free FASTA file allocation, the identifiers and sequences are copies
+	free(fasta_data);
+
+	if (list->count == first_query) {
+		printf("error: failed to read FASTA query sequence!\n");
+		return false;
+	}
+
+	if (all_sequences) {
+		printf("Query Sequences: %zu from %s\n", (list->count - first_query), query_filename);
+	}
+	return true;
+}
+
+/*
+	char* copy_string(char* s)
+
+	copy_string() returns a newly allocated copy of the C string 's'. The application exits if memory could not be allocated.
+*/
+static char* copy_string(char* s) {
+	char* copy = (char *)malloc((strlen(s) + 1) * sizeof(char));
+	if (copy == NULL) {
+		perror("copy_string(): malloc(): error");
+
+		//immediately exit
+		exit(1);
+	}
+	memcpy(copy, s, ((strlen(s) + 1) * sizeof(char)));
+	return copy;
+}
+
+/*
+	bool load_ednafull_query_index_file(ednafull_query* query, char* index_filename, int64_t gap_penalty, gqss_thread_pool* pool)
+
+	load_ednafull_query_index_file() maps the query index file 'index_filename' and creates aligners that share the profiles of
+	the mapped file. The function returns false if the file is not an EDNAFULL query index.
+*/
+static bool load_ednafull_query_index_file(ednafull_query* query, char* index_filename, int64_t gap_penalty, gqss_thread_pool* pool) {
+	query->index = gqss_query_index_open(index_filename);
+	if (query->index == NULL) {
+		printf("error: failed to read query index file!\n");
+		return false;
+	}
+
+	if (strcmp(gqss_query_index_substitution_matrix_name(query->index), "NUC4.4") != 0) {
+		printf("error: query index file was not created with the EDNAFULL substitution matrix!\n");
+
+		gqss_query_index_close(query->index);
+		return false;
+	}
+
+	query->identifier = copy_string(gqss_query_index_identifier(query->index));
+	query->sequence = copy_string(gqss_query_index_sequence(query->index, GQSS_QUERY_INDEX_FORWARD));
+	query->reverse_complement_sequence = copy_string(gqss_query_index_sequence(query->index, GQSS_QUERY_INDEX_REVERSE_COMPLEMENT));
+
+	printf("Query Sequence Identifier: %s\n", (query->identifier + 1));
+
+	query->aligner = gqss_query_index_create_aligner(query->index, GQSS_QUERY_INDEX_FORWARD, get_nuc_4_4_value, gap_penalty);
+	query->reverse_complement_aligner = gqss_query_index_create_aligner(query->index, GQSS_QUERY_INDEX_REVERSE_COMPLEMENT, get_nuc_4_4_value, gap_penalty);
+	if ((query->aligner == NULL) || (query->reverse_complement_aligner == NULL)) {
+		printf("error: load_ednafull_query_index_file(): failed to create aligner!\n");
+
+		//immediately exit
+		exit(1);
+	}
+
+	query->batch_aligner = create_ednafull_batch_aligner(query->aligner, pool);
+	query->reverse_complement_batch_aligner = create_ednafull_batch_aligner(query->reverse_complement_aligner, pool);
+	return true;
+}
+
+/*
+	int run_index_command(int argc, char* argv[])
+
+	run_index_command() implements 'ednafull_linear_smith_waterman index -q FILE INDEX_FILE', it writes the query, its reverse
+	complement and their EDNAFULL profiles to INDEX_FILE. The function returns the exit status of the application.
+*/
+static int run_index_command(int argc, char* argv[]) {
+	int getopt_index = 0;
+	int c;
+
+	char* query_filename = NULL;
+
+	while ((c = getopt_long(argc, argv, "q:h", getopt_long_index_options, &getopt_index)) != -1) {
+		switch (c) {
+			case 'q':
+				query_filename = optarg;
+				break;
+			case 'h':
+				printf("%s", HELP_STRING);
+				exit(0);
+				break;
+			default:
+				printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+				return 1;
+				break;
+		}
+	}
+
+	if ((query_filename == NULL) || (strlen(query_filename) == 0) || (argc - optind != 1)) {
+		printf("ednafull_linear_smith_waterman: index: expected '-q FILE INDEX_FILE'!\n");
+		printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+		return 1;
+	}
+
+	char* fasta_sequence_identifier;
+	char* query_sequence;
+	char* fasta_data = read_file(query_filename);
+	if (fasta_data == NULL) {
+		printf("error: failed to read FASTA query file!\n");
+		return 1;
+	}
+	extract_fasta_sequence(fasta_data, &fasta_sequence_identifier, &query_sequence);
+
+	//free FASTA file allocation, the identifier and sequence are copies
+	free(fasta_data);
+
+	if (query_sequence == NULL) {
+		printf("error: failed to read FASTA query sequence!\n");
+
+		free(fasta_sequence_identifier);
+		return 1;
+	}
+
+	char* reverse_complement_sequence = get_reverse_complement(query_sequence);
+	if (reverse_complement_sequence == NULL) {
+		free(query_sequence);
+		free(fasta_sequence_identifier);
+		return 1;
+	}
+
+	printf("Writing query index to \"%s\"\n", argv[optind]);
+
+	bool written = gqss_query_index_write(argv[optind], fasta_sequence_identifier, query_sequence, reverse_complement_sequence, get_nuc_4_4_value, "NUC4.4");
+
+	//free allocations
+	free(reverse_complement_sequence);
+	free(query_sequence);
+	free(fasta_sequence_identifier);
+
+	return written ? 0 : 2;
+}
+
+/*
+	int run_merge_command(int argc, char* argv[])
+
+	run_merge_command() implements 'ednafull_linear_smith_waterman merge OUTPUT SHARD_FILE...', it concatenates the shard output
+	files in the given order. The function returns the exit status of the application.
+*/
+static int run_merge_command(int argc, char* argv[]) {
+	if (argc < 3) {
+		printf("ednafull_linear_smith_waterman: merge: expected 'OUTPUT SHARD_FILE...'!\n");
+		printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+		return 1;
+	}
+
+	char* buffer = (char *)malloc(EDNAFULL_MERGE_BUFFER_SIZE * sizeof(char));
+	if (buffer == NULL) {
+		perror("run_merge_command(): malloc(): error");
+		return 1;
+	}
+
+	printf("Merging %d shard files into \"%s\"\n", (argc - 2), argv[1]);
+
+	FILE* output_fd = fopen(argv[1], "wb");
+	if (output_fd == NULL) {
+		perror("run_merge_command(): fopen(): error");
+
+		free(buffer);
+		return 2;
+	}
+
+	for (int i = 2; i < argc; i++) {
+		FILE* shard_fd = fopen(argv[i], "rb");
+		if (shard_fd == NULL) {
+			perror("run_merge_command(): fopen(): error");
+
+			fclose(output_fd);
+			free(buffer);
+			return 2;
+		}
+
+		size_t bytes_read;
+		while ((bytes_read = fread(buffer, sizeof(char), EDNAFULL_MERGE_BUFFER_SIZE, shard_fd)) > 0) {
+			if (fwrite(buffer, sizeof(char), bytes_read, output_fd) != bytes_read) {
+				perror("run_merge_command(): fwrite(): error");
+
+				fclose(shard_fd);
+				fclose(output_fd);
+				free(buffer);
+				return 2;
+			}
+		}
+
+		if (ferror(shard_fd)) {
+			perror("run_merge_command(): fread(): error");
+
+			fclose(shard_fd);
+			fclose(output_fd);
+			free(buffer);
+			return 2;
+		}
+		fclose(shard_fd);
+	}
+
+	free(buffer);
+	if (fclose(output_fd) != 0) {
+		perror("run_merge_command(): fclose(): error");
+		return 2;
+	}
+	return 0;
+}
+
+/*
+	char* get_fastq_index_filename(char* fastq_filename)
+
+	get_fastq_index_filename() returns a newly allocated file name of the FASTQ index written next to 'fastq_filename'.
+*/
+static char* get_fastq_index_filename(char* fastq_filename) {
+	size_t filename_length = strlen(fastq_filename) + strlen(GQSS_FASTQ_INDEX_EXTENSION);
+	char* index_filename = (char *)malloc((filename_length + 1) * sizeof(char));
+	if (index_filename == NULL) {
+		perror("get_fastq_index_filename(): malloc(): error");
+
+		//immediately exit
+		exit(1);
+	}
+	snprintf(index_filename, (filename_length + 1), "%s%s", fastq_filename, GQSS_FASTQ_INDEX_EXTENSION);
+	return index_filename;
+}
+
+/*
+	gqss_fastq_index* open_fastq_index(char* fastq_filename, char* data, size_t length)
+
+	open_fastq_index() maps the FASTQ index written next to 'fastq_filename'. The function returns a NULL pointer if there is
+	no index or if the index was built for different FASTQ data (of a different size or other first or last records).
+*/
+static gqss_fastq_index* open_fastq_index(char* fastq_filename, char* data, size_t length) {
+	char* index_filename = get_fastq_index_filename(fastq_filename);
+
+	gqss_fastq_index* index = gqss_fastq_index_open(index_filename);
+	if ((index != NULL) && (!gqss_fastq_index_matches(index, data, length))) {
+		printf("warning: ignoring stale FASTQ index \"%s\"\n", index_filename);
+
+		gqss_fastq_index_close(index);
+		index = NULL;
+	}
+
+	free(index_filename);
+	return index;
+}
+
+/*
+	int run_index_fastq_command(int argc, char* argv[])
+
+	run_index_fastq_command() implements 'ednafull_linear_smith_waterman index-fastq [-n STRIDE] FASTQ_FILE', it writes the
+	offset of every STRIDE-th record to the FASTQ index file next to FASTQ_FILE. The function returns the exit status of
+	the application.
+*/
+static int run_index_fastq_command(int argc, char* argv[]) {
+	int getopt_index = 0;
+	int c;
+
+	uint64_t stride = EDNAFULL_FASTQ_INDEX_STRIDE;
+
+	while ((c = getopt_long(argc, argv, "n:h", getopt_long_index_fastq_options, &getopt_index)) != -1) {
+		switch (c) {
+			case 'n':
+				if ((sscanf(optarg, "%" SCNu64, &stride) != 1) || (stride == 0)) {
+					printf("ednafull_linear_smith_waterman: index-fastq: option -n, --stride: expected a positive integer.\n");
+					printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+					return 1;
+				}
+				break;
+			case 'h':
+				printf("%s", HELP_STRING);
+				exit(0);
+				break;
+			default:
+				printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+				return 1;
+				break;
+		}
+	}
+
+	if (argc - optind != 1) {
+		printf("ednafull_linear_smith_waterman: index-fastq: expected '[-n STRIDE] FASTQ_FILE'!\n");
+		printf("Try 'ednafull_linear_smith_waterman --help' for more information.\n");
+		return 1;
+	}
+
+	size_t length;
+	char* data = map_file(argv[optind], &length);
+	if (data == NULL) {
+		printf("error: failed to read FASTQ file!\n");
+		return 1;
+	}
+
+	char* index_filename = get_fastq_index_filename(argv[optind]);
+
+	printf("Writing FASTQ index to \"%s\"\n", index_filename);
+
+	bool written = gqss_fastq_index_write(index_filename, data, length, stride);
+
+	//free allocations
+	free(index_filename);
+	unmap_file(data, length);
+
+	return written ? 0 : 2;
+}
+
+/*
+	size_t get_shard_offset(size_t length, size_t shard, size_t shard_count)
+
+	get_shard_offset() returns where shard 'shard' (0-based) of 'shard_count' equally sized ranges of 'length' bytes or records
+	starts.
+*/
+static size_t get_shard_offset(size_t length, size_t shard, size_t shard_count) {
+	return ((length / shard_count) * shard) + (((length % shard_count) * shard) / shard_count);
+}
+
+/*
+	bool get_indexed_shard_range(gqss_fastq_index* index, char* data, size_t length, ednafull_options* options, size_t* shard_start, size_t* shard_end)
+
+	get_indexed_shard_range() assigns the byte range of the records of the shard of 'options' found through 'index' to
+	'shard_start' and 'shard_end'. The boundaries of every shard are checked, not only the two of this shard, so that all
+	shards of a run agree to use the index or to fall back to byte ranges. The function returns false if a boundary is not
+	the start of a record.
+*/
+static bool get_indexed_shard_range(gqss_fastq_index* index, char* data, size_t length, ednafull_options* options, size_t* shard_start, size_t* shard_end) {
+	uint64_t record_count = gqss_fastq_index_record_count(index);
+
+	for (size_t i = 0; i <= options->shard_count; i++) {
+		size_t offset;
+		if (!gqss_fastq_index_seek(index, data, length, get_shard_offset(record_count, i, options->shard_count), &offset)) {
+			return false;
+		}
+
+		if (i == (options->shard_index - 1)) {
+			*shard_start = offset;
+		}
+		if (i == options->shard_index) {
+			*shard_end = offset;
+		}
+	}
+	return true;
+}
+
+/*
+	bool redirect_standard_output(ednafull_options* options)
+
+	redirect_standard_output() keeps a stream of the standard output for the results and sends the progress messages printed
+	to the standard output to the standard error instead. The function returns false on failure.
+*/
+static bool redirect_standard_output(ednafull_options* options) {
+	fflush(stdout);
+
+	int output_fd = dup(STDOUT_FILENO);
+	if (output_fd < 0) {
+		perror("redirect_standard_output(): dup(): error");
+		return false;
+	}
+
+	options->standard_output = fdopen(output_fd, "wb");
+	if (options->standard_output == NULL) {
+		perror("redirect_standard_output(): fdopen(): error");
+
+		close(output_fd);
+		return false;
+	}
+
+	//a pipe is written with the small default buffer of a non-regular file otherwise
+	setvbuf(options->standard_output, NULL, _IOFBF, EDNAFULL_WRITE_BUFFER_SIZE);
+
+	if (dup2(STDERR_FILENO, STDOUT_FILENO) < 0) {
+		perror("redirect_standard_output(): dup2(): error");
+		return false;
+	}
+	return true;
+}
+
+/*
+	uint64_t handle_fastq_input(ednafull_options* options, ednafull_input* input, ednafull_query* queries, size_t query_count)
+
+	handle_fastq_input() aligns 'input' against the first query of 'queries' (or every query with --demux) and writes the
+	results in the output format of 'options'. The function returns the number of sequences (or pairs of interleaved mates)
+	parsed.
+*/
+static uint64_t handle_fastq_input(ednafull_options* options, ednafull_input* input, ednafull_query* queries, size_t query_count) {
+	ednafull_query* query = &queries[0];
+
+	if (options->demux_directory != NULL) {
+		return handle_fastq_demux(options, input, queries, query_count);
+	}
+	if (options->interleaved) {
+		return handle_fastq_paired(options, input, NULL, query);
+	}
+	if (options->output_flag == OUTPUT_NONE) {
+		return handle_fastq_none(options, input, query);
+	}
+	if (options->output_flag == OUTPUT_SUMMARY) {
+		return handle_fastq_summary(options, input, query);
+	}
+	if (options->top_k > 0) {
+		return handle_fastq_top_k(options, input, query);
+	}
+	if (options->output_flag == OUTPUT_PAIR) {
+		return handle_fastq_pair(options, input, query);
+	}
+	return handle_fastq_tsv(options, input, query);
+}
+
+/*
+	int align_fastq_mate_files(ednafull_options* options, ednafull_query* query, uint64_t* pair_count)
+
+	align_fastq_mate_files() aligns the paired-end reads of the FASTQ files 'options->fastq_filename' (R1) and
+	'options->mate_filename' (R2) against 'query' and assigns the number of pairs to 'pair_count'. The function returns the
+	exit status, 1 if a FASTQ file could not be read.
+*/
+static int align_fastq_mate_files(ednafull_options* options, ednafull_query* query, uint64_t* pair_count) {
+	ednafull_input first_input;
+	ednafull_input second_input;
+
+	first_input.data = map_file(options->fastq_filename, &first_input.length);
+	first_input.fd = -1;
+	second_input.data = map_file(options->mate_filename, &second_input.length);
+	second_input.fd = -1;
+
+	int status = 0;
+	if ((first_input.data == NULL) || (second_input.data == NULL)) {
+		printf("error: failed to read the mate FASTQ files!\n");
+		status = 1;
+	}
+	else {
+		*pair_count = handle_fastq_paired(options, &first_input, &second_input, query);
+	}
+
+	//unmap FASTQ files
+	unmap_file(first_input.data, first_input.length);
+	unmap_file(second_input.data, second_input.length);
+	return status;
+}
+
+/*
+	int align_fastq_file(ednafull_options* options, ednafull_query* queries, size_t query_count, uint64_t* sequence_count)
+
+	align_fastq_file() aligns the FASTQ file 'options->fastq_filename' (or its shard) against 'queries' (see
+	handle_fastq_input()) and assigns the number of sequences parsed to 'sequence_count'. The function returns the exit status,
+	1 if the FASTQ file could not be read or the exit status of a failure while aligning it ('options->status').
+*/
+static int align_fastq_file(ednafull_options* options, ednafull_query* queries, size_t query_count, uint64_t* sequence_count) {
+	int status = 0;
+
+	*sequence_count = 0;
+
+	if (options->mate_filename != NULL) {
+		status = align_fastq_mate_files(options, &queries[0], sequence_count);
+	}
+	else if (strcmp(options->fastq_filename, EDNAFULL_STANDARD_STREAM) == 0) {
+		ednafull_input input;
+		input.data = NULL;
+		input.length = 0;
+		input.fd = STDIN_FILENO;
+
+		*sequence_count = handle_fastq_input(options, &input, queries, query_count);
+	}
+	else if (options->follow || (!is_regular_file(options->fastq_filename))) {
+		//a file that is still being written, a pipe or a device is read in chunks instead of being mapped
+		ednafull_input input;
+		input.data = NULL;
+		input.length = 0;
+		input.fd = open(options->fastq_filename, O_RDONLY);
+		if (input.fd < 0) {
+			perror("error: failed to open FASTQ file");
+			status = 1;
+		}
+		else {
+			*sequence_count = handle_fastq_input(options, &input, queries, query_count);
+
+			//close FASTQ file
+			close(input.fd);
+		}
+	}
+	else {
+		size_t length;
+		char* data = map_file(options->fastq_filename, &length);
+		if (data == NULL) {
+			printf("error: failed to read FASTQ file!\n");
+			status = 1;
+		}
+		else {
+			size_t shard_start = 0;
+			size_t shard_end = length;
+
+			if (options->shard_count > 1) {
+				//with a FASTQ index, the shards get equal numbers of records
+				bool indexed = false;
+				gqss_fastq_index* fastq_index = open_fastq_index(options->fastq_filename, data, length);
+				if (fastq_index != NULL) {
+					indexed = get_indexed_shard_range(fastq_index, data, length, options, &shard_start, &shard_end);
+					if (!indexed) {
+						printf("warning: the FASTQ index does not match \"%s\", sharding by byte ranges\n", options->fastq_filename);
+					}
+
+					gqss_fastq_index_close(fastq_index);
+				}
+				if (!indexed) {
+					/*
+						A shard processes the records starting in its byte range, both ends are moved to the next record
+						start so that neighboring shards agree on the boundary.
+					*/
+					shard_start = find_fastq_record_start(data, length, get_shard_offset(length, (options->shard_index - 1), options->shard_count));
+					shard_end = find_fastq_record_start(data, length, get_shard_offset(length, options->shard_index, options->shard_count));
+				}
+			}
+
+			ednafull_input input;
+			input.data = data + shard_start;
+			input.length = shard_end - shard_start;
+			input.fd = -1;
+
+			*sequence_count = handle_fastq_input(options, &input, queries, query_count);
+		}
+
+		//unmap FASTQ file
+		unmap_file(data, length);
+	}
+
+	if (status == 0) {
+		status = options->status;
+	}
+	return status;
+}
+
+typedef struct ednafull_file_stats {
+	uint64_t sequence_count;
+	double seconds;
+	int status;
+	bool skipped;
+	bool stopped;
+} ednafull_file_stats;
+
+/*
+	ednafull_file_scheduler hands out the FASTQ files of a run to the threads aligning them. All threads share the query's
+	batch aligners and thus the thread pool, so that records of different files are aligned at the same time. With --top-k,
+	every file has its own heap of best records ('top_k_heaps'), merged once all files were aligned.
+*/
+typedef struct ednafull_file_scheduler {
+	ednafull_options* options;
+	ednafull_query* query;
+	ednafull_file_stats* stats;
+	ednafull_top_k* top_k_heaps;
+	size_t next_file;
+	pthread_mutex_t mutex;
+} ednafull_file_scheduler;
+
+/*
+	void remove_skipped_output(ednafull_options* options)
+
+	remove_skipped_output() removes the output file of the FASTQ file of 'options', which was skipped by --max-hits, so that
+	the output of an earlier run is not mistaken for the output of this run.
+*/
+static void remove_skipped_output(ednafull_options* options) {
+	char* extension = ".sw.tsv";
+	if (options->output_flag == OUTPUT_NONE) {
+		//only the --matched-out and --unmatched-out files of a single FASTQ file
+		return;
+	}
+	else if (options->output_flag == OUTPUT_SUMMARY) {
+		extension = ".sw.summary.json";
+	}
+	else if (options->output_flag == OUTPUT_PAIR) {
+		extension = ".sw.pair";
+	}
+
+	char* filename = get_output_filename(options, extension);
+	if ((unlink(filename) != 0) && (errno != ENOENT)) {
+		perror("remove_skipped_output(): unlink(): error");
+	}
+	free(filename);
+	return;
+}
+
+/*
+	void* run_file_worker(void* argument)
+
+	run_file_worker() aligns the next FASTQ file of the ednafull_file_scheduler 'argument' until every file was taken.
+*/
+static void* run_file_worker(void* argument) {
+	ednafull_file_scheduler* scheduler = (ednafull_file_scheduler *)argument;
+	struct timespec start_time;
+	struct timespec end_time;
+
+	for (;;) {
+		pthread_mutex_lock(&scheduler->mutex);
+		size_t file = scheduler->next_file;
+		scheduler->next_file++;
+		pthread_mutex_unlock(&scheduler->mutex);
+
+		if (file >= scheduler->options->fastq_count) {
+			break;
+		}
+
+		//a copy of the options names the file for the output file name and checkpoint
+		ednafull_options file_options = *(scheduler->options);
+		file_options.fastq_filename = scheduler->options->fastq_filenames[file];
+		if (scheduler->top_k_heaps != NULL) {
+			file_options.top_k_heap = &(scheduler->top_k_heaps[file]);
+		}
+
+		ednafull_file_stats* stats = &(scheduler->stats[file]);
+
+		//the remaining files are not read once --max-hits was reached
+		if ((scheduler->options->hit_limit != NULL) && ednafull_hit_limit_reached(scheduler->options->hit_limit)) {
+			remove_skipped_output(&file_options);
+			stats->skipped = true;
+			if (file_options.stats != NULL) {
+				set_ednafull_file_stopped(file_options.stats, file, true);
+			}
+			continue;
+		}
+
+		clock_gettime(CLOCK_MONOTONIC, &start_time);
+		stats->status = align_fastq_file(&file_options, scheduler->query, 1, &stats->sequence_count);
+		clock_gettime(CLOCK_MONOTONIC, &end_time);
+		stats->stopped = file_options.stopped;
+		if (file_options.stats != NULL) {
+			set_ednafull_file_stopped(file_options.stats, file, stats->stopped);
+		}
+
+		stats->seconds = compute_time_elapsed(&start_time, &end_time);
+		printf("[%11.2lf seconds]: %s: %" PRIu64 " sequences parsed\n", stats->seconds, file_options.fastq_filename, stats->sequence_count);
+	}
+	return NULL;
+}
+
+//status of a FASTQ file in the summary of the files of a run
+static char* get_file_status(ednafull_file_stats* stats) {
+	if (stats->status != 0) {
+		return "failed";
+	}
+	if (stats->skipped) {
+		return "skipped";
+	}
+	if (stats->stopped) {
+		return "stopped";
+	}
+	return "ok";
+}
+
+/*
+	void print_file_summary(ednafull_options* options, ednafull_file_stats* stats, double seconds)
+
+	print_file_summary() prints the number of sequences, seconds and sequences per second of every FASTQ file and their total.
+*/
+static void print_file_summary(ednafull_options* options, ednafull_file_stats* stats, double seconds) {
+	uint64_t total_sequence_count = 0;
+
+	printf("\nFASTQ File\tSequences\tSeconds\tSequences/Second\tStatus\n");
+	for (size_t i = 0; i < options->fastq_count; i++) {
+		double sequences_per_second = (stats[i].seconds > 0) ? ((double)stats[i].sequence_count / stats[i].seconds) : 0;
+		printf("%s\t%" PRIu64 "\t%.2lf\t%.0lf\t%s\n", options->fastq_filenames[i], stats[i].sequence_count, stats[i].seconds,
+				sequences_per_second, get_file_status(&stats[i]));
+
+		total_sequence_count = total_sequence_count + stats[i].sequence_count;
+	}
+
+	double sequences_per_second = (seconds > 0) ? ((double)total_sequence_count / seconds) : 0;
+	printf("Total (%zu files)\t%" PRIu64 "\t%.2lf\t%.0lf\n", options->fastq_count, total_sequence_count, seconds, sequences_per_second);
+	return;
+}
+
+/*
+	int align_fastq_files(ednafull_options* options, ednafull_query* query)
+
+	align_fastq_files() aligns every FASTQ file of 'options' against 'query', 'options->parallel_files' files at a time, and
+	prints a summary of the files. The function returns the exit status of the first FASTQ file that could not be aligned, or
+	of writing the --top-k file.
+*/
+static int align_fastq_files(ednafull_options* options, ednafull_query* query) {
+	struct timespec start_time;
+	struct timespec end_time;
+
+	ednafull_file_scheduler scheduler;
+	scheduler.options = options;
+	scheduler.query = query;
+	scheduler.next_file = 0;
+	scheduler.top_k_heaps = NULL;
+	scheduler.stats = (ednafull_file_stats *)calloc(options->fastq_count, sizeof(ednafull_file_stats));
+	if (scheduler.stats == NULL) {
+		perror("align_fastq_files(): calloc(): error");
+		return 1;
+	}
+
+	if (options->top_k > 0) {
+		scheduler.top_k_heaps = (ednafull_top_k *)calloc(options->fastq_count, sizeof(ednafull_top_k));
+		if (scheduler.top_k_heaps == NULL) {
+			perror("align_fastq_files(): calloc(): error");
+
+			free(scheduler.stats);
+			return 1;
+		}
+		for (size_t i = 0; i < options->fastq_count; i++) {
+			if (!init_ednafull_top_k(&scheduler.top_k_heaps[i], options->top_k, i)) {
+				for (size_t j = 0; j < i; j++) {
+					free_ednafull_top_k(&scheduler.top_k_heaps[j]);
+				}
+				free(scheduler.top_k_heaps);
+				free(scheduler.stats);
+				return 1;
+			}
+		}
+	}
+	if (pthread_mutex_init(&scheduler.mutex, NULL) != 0) {
+		free(scheduler.stats);
+		return 1;
+	}
+
+	pthread_t* threads = (pthread_t *)malloc(options->parallel_files * sizeof(pthread_t));
+	if (threads == NULL) {
+		perror("align_fastq_files(): malloc(): error");
+
+		pthread_mutex_destroy(&scheduler.mutex);
+		free(scheduler.stats);
+		return 1;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+	//the calling thread aligns files as well
+	size_t thread_count = 0;
+	while (thread_count + 1 < options->parallel_files) {
+		if (pthread_create(&threads[thread_count], NULL, run_file_worker, &scheduler) != 0) {
+			printf("warning: align_fastq_files(): aligning %zu instead of %zu files at a time\n", (thread_count + 1), options->parallel_files);
+			break;
+		}
+		thread_count++;
+	}
+
+	run_file_worker(&scheduler);
+
+	for (size_t i = 0; i < thread_count; i++) {
+		pthread_join(threads[i], NULL);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+
+	print_file_summary(options, scheduler.stats, compute_time_elapsed(&start_time, &end_time));
+
+	int status = 0;
+	for (size_t i = 0; (i < options->fastq_count) && (status == 0); i++) {
+		status = scheduler.stats[i].status;
+	}
+
+	if (scheduler.top_k_heaps != NULL) {
+		int top_k_status = write_top_k(options, scheduler.top_k_heaps, options->fastq_count, query);
+		if (status == 0) {
+			status = top_k_status;
+		}
+
+		for (size_t i = 0; i < options->fastq_count; i++) {
+			free_ednafull_top_k(&scheduler.top_k_heaps[i]);
+		}
+		free(scheduler.top_k_heaps);
+	}
+
+	free(threads);
+	pthread_mutex_destroy(&scheduler.mutex);
+	free(scheduler.stats);
+	return status;
+}
+
+int main(int argc, char* argv[]) {
+	ednafull_options options;
+
+	if ((argc > 1) && (strcmp(argv[1], "index") == 0)) {
+		return run_index_command(argc - 1, argv + 1);
+	}
+	if ((argc > 1) && (strcmp(argv[1], "index-fastq") == 0)) {
+		return run_index_fastq_command(argc - 1, argv + 1);
+	}
+	if ((argc > 1) && (strcmp(argv[1], "merge") == 0)) {
+		return run_merge_command(argc - 1, argv + 1);
+	}
+
+	int parse_status = parse_ednafull_linear_smith_waterman_options(argc, argv, &options);
+
+	//the results are written to the standard output, every message printed from here on to the standard error
+	if ((parse_status == 0) && (options.output_filename != NULL) && (strcmp(options.output_filename, EDNAFULL_STANDARD_STREAM) == 0)
+			&& (!redirect_standard_output(&options))) {
+		parse_status = 1;
+	}
+	
+	if (parse_status == 0) {
+		/*
+			A single thread aligns on the calling thread without a pool, unless several files or clients are aligned at the
+			same time: their alignments are then serialized by a pool of one worker.
+		*/
+		gqss_thread_pool* pool = NULL;
+		if ((options.thread_count > 1) || (options.parallel_files > 1) || (options.socket_filename != NULL)) {
+			pool = gqss_thread_pool_create(options.thread_count);
+			if (pool == NULL) {
+				printf("error: failed to start %zu worker threads!\n", options.thread_count);
+				return 1;
+			}
+		}
+
+		//with --demux, every sequence of a FASTA file is a query
+		ednafull_query_list query_list;
+		memset(&query_list, 0, sizeof(ednafull_query_list));
+
+		for (size_t i = 0; i < options.query_count; i++) {
+			char* query_filename = options.query_filenames[i];
+			size_t query_filename_length = strlen(query_filename);
+
+			bool loaded;
+			if ((query_filename_length >= 8) && (strcmp(query_filename + query_filename_length - 8, ".gqssidx") == 0)) {
+				loaded = load_ednafull_query_index_file(add_ednafull_query(&query_list), query_filename, options.gap_penalty, pool);
+				if (loaded) {
+					query_list.count++;
+				}
+			}
+			else {
+				loaded = load_ednafull_query_file(&query_list, query_filename, (options.demux_directory != NULL), options.gap_penalty, pool);
+			}
+
+			if (!loaded) {
+				parse_status = 1;
+				break;
+			}
+		}
+
+		ednafull_hit_limit hit_limit;
+		if ((parse_status == 0) && (options.max_hits > 0) && (options.socket_filename == NULL)) {
+			if (!init_ednafull_hit_limit(&hit_limit, options.max_hits, options.min_score, &query_list.queries[0])) {
+				return 1;
+			}
+			options.hit_limit = &hit_limit;
+		}
+
+		//the counters of the aligners are summed over the worker aligners once the run is complete
+		ednafull_stats stats;
+		if ((parse_status == 0) && (options.stats_enabled || (options.report_filename != NULL))) {
+			if (!init_ednafull_stats(&stats, options.fastq_count)) {
+				return 1;
+			}
+			enable_ednafull_query_stats(query_list.queries, query_list.count);
+			options.stats = &stats;
+		}
+
+		if (parse_status == 0) {
+			if (options.socket_filename != NULL) {
+				parse_status = run_ednafull_server(options.socket_filename, query_list.queries, query_list.count, options.gap_penalty);
+			}
+			else if (options.fastq_count == 1) {
+				options.fastq_filename = options.fastq_filenames[0];
+
+				uint64_t sequence_count;
+				ednafull_top_k top_k_heap;
+				if ((options.top_k > 0) && (!init_ednafull_top_k(&top_k_heap, options.top_k, 0))) {
+					parse_status = 1;
+				}
+				else {
+					if (options.top_k > 0) {
+						options.top_k_heap = &top_k_heap;
+					}
+
+					parse_status = align_fastq_file(&options, query_list.queries, query_list.count, &sequence_count);
+					if (options.stats != NULL) {
+						set_ednafull_file_stopped(&stats, 0, options.stopped);
+					}
+
+					if (options.top_k > 0) {
+						if (parse_status == 0) {
+							parse_status = write_top_k(&options, &top_k_heap, 1, &query_list.queries[0]);
+						}
+						free_ednafull_top_k(&top_k_heap);
+					}
+				}
+			}
+			else {
+				parse_status = align_fastq_files(&options, &query_list.queries[0]);
+			}
+		}
+
+		if (options.hit_limit != NULL) {
+			if (parse_status == 0) {
+				print_hit_limit_summary(&hit_limit);
+			}
+			free_ednafull_hit_limit(&hit_limit);
+		}
+
+		if (options.stats != NULL) {
+			if ((parse_status == 0) && options.stats_enabled) {
+				print_ednafull_stats(&stats, query_list.queries, query_list.count);
+			}
+			if (options.report_filename != NULL) {
+				//the report of a failed run is written as well, with its exit status
+				if ((!save_ednafull_report(&stats, &options, query_list.queries, query_list.count, parse_status)) && (parse_status == 0)) {
+					parse_status = 2;
+				}
+			}
+			free_ednafull_stats(&stats);
+		}
+
+		//free allocations
+		for (size_t i = 0; i < query_list.count; i++) {
+			free_ednafull_query(&query_list.queries[i]);
+		}
+		free(query_list.queries);
+		gqss_thread_pool_destroy(pool);
+	}
+
+	free(options.fastq_filenames);
+	free(options.input_list_data);
+
 	return parse_status;
 }
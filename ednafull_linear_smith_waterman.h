@@ -22,8 +22,12 @@
 #define EDNAFULL_LINEAR_SMITH_WATERMAN_H
 
 #include "linear_gap_smith_waterman.h"
+#include "gqss_ednafull.h"
 #include "gqss_file_io.h"
 #include "gqss_alignment_format.h"
+#include "gqss_alignment_stream.h"
+#include "gqss_query_index.h"
+#include "gqss_fastq_index.h"
 
 #include <stdint.h>
 #include <inttypes.h>
@@ -33,13 +37,430 @@
 
 #include <stdbool.h>
 #include <time.h>
+#include <errno.h>
 
 #include <unistd.h>
 #include <getopt.h>
+#include <sys/uio.h>
 
 typedef enum ednafull_output_flags_enum {
 	OUTPUT_TSV  = 0,
-	OUTPUT_PAIR = 1
+	OUTPUT_PAIR = 1,
+	OUTPUT_NONE = 2,
+	OUTPUT_SUMMARY = 3
 } ednafull_output_flags;
 
+//number of FASTQ records aligned per batch
+#define EDNAFULL_BATCH_SIZE 1024
+
+//default number of records between two offsets of a FASTQ index
+#define EDNAFULL_FASTQ_INDEX_STRIDE 1024
+
+//default number of records between two checkpoints
+#define EDNAFULL_CHECKPOINT_INTERVAL 65536
+
+//file name extension of the checkpoint file written next to an output file
+#define EDNAFULL_CHECKPOINT_EXTENSION ".checkpoint"
+
+//file name of the standard input (FASTQ file) or the standard output (-o, --output)
+#define EDNAFULL_STANDARD_STREAM "-"
+
+//size of the chunks read from a FASTQ file descriptor
+#define EDNAFULL_READ_BUFFER_SIZE (1 << 20)
+
+//size of the buffer of the results written to the standard output
+#define EDNAFULL_WRITE_BUFFER_SIZE (1 << 20)
+
+//milliseconds between two checks for data appended to a followed FASTQ file
+#define EDNAFULL_FOLLOW_POLL_INTERVAL_MS 250
+
+//default number of seconds without appended data that end --follow
+#define EDNAFULL_FOLLOW_TIMEOUT 600
+
+//default minimum score of a read written to --matched-out
+#define EDNAFULL_MIN_SCORE 100
+
+//size of the copy buffer of the merge command
+#define EDNAFULL_MERGE_BUFFER_SIZE (1 << 20)
+
+//maximum number of -q, --query options
+#define EDNAFULL_MAX_QUERIES 64
+
+//width of the score ranges counted by the --summary-only score histogram
+#define EDNAFULL_SUMMARY_SCORE_BIN_WIDTH 10
+
+//default maximum fragment length of a proper pair of paired-end reads
+#define EDNAFULL_MAX_FRAGMENT_LENGTH 1000
+
+//default number of FASTQ files of --demux kept open at the same time
+#define EDNAFULL_DEMUX_MAX_OPEN_FILES 256
+
+typedef struct ednafull_top_k ednafull_top_k;
+typedef struct ednafull_hit_limit ednafull_hit_limit;
+typedef struct ednafull_stats ednafull_stats;
+
+typedef struct ednafull_options {
+	char* query_filenames[EDNAFULL_MAX_QUERIES];
+	size_t query_count;
+	char* fastq_filename;
+	char* socket_filename;
+	int64_t gap_penalty;
+	unsigned int output_flag;
+	size_t thread_count;
+	size_t shard_index;
+	size_t shard_count;
+	uint64_t checkpoint_interval;
+	bool resume;
+	bool follow;
+	unsigned int follow_timeout;
+	char* follow_sentinel;
+	char* output_filename;
+	FILE* standard_output;
+	char** fastq_filenames;
+	size_t fastq_count;
+	char* input_list_filename;
+	char* input_list_data;
+	size_t parallel_files;
+	bool show_progress;
+	char* mate_filename;
+	bool interleaved;
+	size_t max_fragment_length;
+	char* matched_filename;
+	char* unmatched_filename;
+	int64_t min_score;
+	char* demux_directory;
+	size_t max_open_files;
+	char* coverage_filename;
+	size_t top_k;
+	ednafull_top_k* top_k_heap;
+	uint64_t max_hits;
+	ednafull_hit_limit* hit_limit;
+	bool stopped;
+	int status;
+	double sample_fraction;
+	uint64_t sample_count;
+	uint64_t sample_every;
+	uint64_t sample_seed;
+	bool stats_enabled;
+	char* report_filename;
+	ednafull_stats* stats;
+} ednafull_options;
+
+/*
+	ednafull_input is the FASTQ data of a run, either the 'length' bytes of a mapped file at 'data' or, if 'data' is a NULL
+	pointer, the file descriptor 'fd' that is read until its end ('length' is 0).
+*/
+typedef struct ednafull_input {
+	char* data;
+	size_t length;
+	int fd;
+} ednafull_input;
+
+/*
+	ednafull_checkpoint tracks the position of a run: 'record_count' records ending at 'input_offset' of the FASTQ data have
+	been written to the first 'output_offset' bytes of the output file. A checkpoint file with these positions is written
+	next to the output file every 'interval' records, together with the settings the rows were written with (a hash of the
+	query, the gap penalty, the output type and the sampling options).
+*/
+typedef struct ednafull_checkpoint {
+	char* filename;
+	FILE* output_fd;
+	uint64_t fastq_length;
+	size_t shard_index;
+	size_t shard_count;
+	uint64_t query_hash;
+	int64_t gap_penalty;
+	unsigned int output_flag;
+	double sample_fraction;
+	uint64_t sample_count;
+	uint64_t sample_every;
+	uint64_t sample_seed;
+	uint64_t interval;
+	uint64_t next_record_count;
+	uint64_t record_count;
+	uint64_t input_offset;
+	uint64_t output_offset;
+	bool resumed;
+} ednafull_checkpoint;
+
+/*
+	ednafull_query holds the query sequence, its reverse complement and the aligners of both. The identifier is the
+	FASTA header line (including the '>' character). 'index' is the mapped query index file the aligners borrow their profiles
+	from, or a NULL pointer if the query was read from a FASTA file.
+*/
+typedef struct ednafull_query {
+	char* identifier;
+	char* sequence;
+	char* reverse_complement_sequence;
+	gqss_aligner* aligner;
+	gqss_aligner* reverse_complement_aligner;
+	gqss_batch_aligner* batch_aligner;
+	gqss_batch_aligner* reverse_complement_batch_aligner;
+	gqss_query_index* index;
+} ednafull_query;
+
+/*
+	ednafull_record_output is a FASTQ file that FASTQ records are written to unchanged, as slices of the input buffer
+	('slices') written with writev() once per batch.
+*/
+typedef struct ednafull_record_output {
+	char* filename;
+	int fd;
+	struct iovec* slices;
+	size_t slice_count;
+	uint64_t record_count;
+} ednafull_record_output;
+
+/*
+	ednafull_filter splits the aligned records into the matched and unmatched FASTQ files by their best score and passes
+	the batches on to the callback of the alignment output. 'failed' is set and the stream is stopped if writing failed.
+*/
+typedef struct ednafull_filter {
+	int64_t min_score;
+	ednafull_record_output matched;
+	ednafull_record_output unmatched;
+	gqss_alignment_callback callback;
+	void* user_data;
+	bool failed;
+} ednafull_filter;
+
+/*
+	ednafull_hit_limit ends a run once 'max_hits' records scored at least 'min_score' against the query or its reverse
+	complement (--max-hits). It is shared by the threads aligning the FASTQ files of a run: the thread finding the last hit
+	cancels the batch aligners of 'query', which stops the alignments queued or running for the other files.
+*/
+struct ednafull_hit_limit {
+	pthread_mutex_t mutex;
+	uint64_t max_hits;
+	int64_t min_score;
+	uint64_t hit_count;
+	uint64_t record_count;
+	bool reached;
+	ednafull_query* query;
+};
+
+/*
+	ednafull_hit_counter counts the hits of one alignment stream towards its ednafull_hit_limit and passes the batches on to
+	'callback' (if it is not a NULL pointer), the batch of the last hit ends with that hit.
+*/
+typedef struct ednafull_hit_counter {
+	ednafull_hit_limit* limit;
+	gqss_alignment_callback callback;
+	void* user_data;
+} ednafull_hit_counter;
+
+//the stages of a run timed by the command line tool itself, the other stages are timed by the library
+typedef enum ednafull_stage {
+	EDNAFULL_STAGE_MISMATCH,
+	EDNAFULL_STAGE_FORMAT,
+	EDNAFULL_STAGE_WRITE,
+	EDNAFULL_STAGE_COUNT
+} ednafull_stage;
+
+/*
+	ednafull_stats collects the --stats counters of a run: the stage times and batches of every alignment stream, the
+	records read and aligned, the CLOCK_MONOTONIC nanoseconds spent in the stages of the command line tool and which of the
+	'file_count' FASTQ files were stopped before their end ('stopped_files'). It is shared by the threads aligning the FASTQ
+	files of a run. The counters of the aligners are read from the queries once the run is complete.
+*/
+struct ednafull_stats {
+	pthread_mutex_t mutex;
+	gqss_alignment_stream_stats stream;
+	uint64_t record_count;
+	uint64_t aligned_count;
+	uint64_t stage_nanoseconds[EDNAFULL_STAGE_COUNT];
+	struct timespec start_time;
+	bool* stopped_files;
+	size_t file_count;
+};
+
+/*
+	ednafull_sampler chooses the FASTQ records aligned with --sample-every (every 'every'-th record), --sample-count (the
+	'selected_count' record indices of 'selected', in input order) or --sample-fraction (records whose seeded hash is below
+	'threshold'). The records not chosen are skipped without being parsed.
+*/
+typedef struct ednafull_sampler {
+	uint64_t every;
+	uint64_t count;
+	uint64_t seed;
+	uint64_t threshold;
+	uint64_t* selected;
+	size_t selected_count;
+	size_t next_selected;
+} ednafull_sampler;
+
+/*
+	ednafull_summary aggregates the alignments of a run for --summary-only and --coverage: the number of records, the number
+	of hits (records scoring at least 'min_score' against the query or its reverse complement), a histogram of the best score
+	of every record and the pileup of the hits over the query. The depth of coverage is kept as a difference array of
+	(query_length + 1) entries, a hit covering positions 'start' to 'stop' adds 1 at 'start' and subtracts 1 after 'stop'.
+	The mismatches, deletions (query bases aligned to gaps) and insertions (read bases inserted before a query position)
+	are counted per query position from the alignment strings. The summary passes the batches on to 'callback' (if it is
+	not a NULL pointer). The time spent counting is added to 'stats' (if it is not a NULL pointer).
+*/
+typedef struct ednafull_summary {
+	size_t query_length;
+	int64_t min_score;
+	uint64_t record_count;
+	uint64_t hit_count;
+	uint64_t reverse_complement_hit_count;
+	uint64_t* score_histogram;
+	size_t histogram_size;
+	int64_t* coverage_changes;
+	uint64_t* mismatch_counts;
+	uint64_t* deletion_counts;
+	uint64_t* insertion_counts;
+	ednafull_stats* stats;
+	gqss_alignment_callback callback;
+	void* user_data;
+} ednafull_summary;
+
+/*
+	ednafull_top_k_entry is a copy of a FASTQ record ('record' points into 'data') and its best score. 'file_index' is the
+	position of its FASTQ file in the input.
+*/
+typedef struct ednafull_top_k_entry {
+	int64_t score;
+	size_t file_index;
+	gqss_fastq_record record;
+	char* data;
+	size_t data_capacity;
+} ednafull_top_k_entry;
+
+/*
+	ednafull_top_k is a min-heap of the 'k' best records of a FASTQ file (--top-k) with the worst of them as its first entry,
+	which is the score a new record has to beat.
+*/
+struct ednafull_top_k {
+	size_t k;
+	size_t count;
+	size_t file_index;
+	ednafull_top_k_entry* entries;
+};
+
+//load a query and create its aligners, 'query' takes ownership of 'identifier' and 'sequence'
+void load_ednafull_query(ednafull_query* query, char* identifier, char* sequence, int64_t gap_penalty, gqss_thread_pool* pool);
+
+void free_ednafull_query(ednafull_query* query);
+
+//align the FASTQ records of 'input' from the position of 'checkpoint', returns the number of records aligned ('options->status' is set on failure)
+uint64_t align_ednafull_input(ednafull_input* input, ednafull_options* options, ednafull_query* query, ednafull_checkpoint* checkpoint, gqss_alignment_callback callback, void* user_data);
+
+//return a newly allocated output file name for the FASTQ file of 'options' with the given extension
+char* get_output_filename(ednafull_options* options, char* extension);
+
+//align paired-end reads, from R1 and R2 files or interleaved in 'first_input', returns the number of pairs
+uint64_t handle_fastq_paired(ednafull_options* options, ednafull_input* first_input, ednafull_input* second_input, ednafull_query* query);
+
+//write each FASTQ record to the --demux bin of its best scoring query, returns the number of records
+uint64_t handle_fastq_demux(ednafull_options* options, ednafull_input* input, ednafull_query* queries, size_t query_count);
+
+//initialize an empty summary of the alignments against 'query', returns false if memory could not be allocated
+bool init_ednafull_summary(ednafull_summary* summary, ednafull_query* query, int64_t min_score);
+
+void free_ednafull_summary(ednafull_summary* summary);
+
+//add the best alignment of every record of 'batch' to 'summary'
+void add_summary_batch(ednafull_summary* summary, gqss_alignment_batch* batch);
+
+//gqss_alignment_callback of an ednafull_summary
+bool summarize_batch(gqss_alignment_batch* batch, void* user_data);
+
+//write the C string 's' as a quoted JSON string
+void write_json_string(FILE* file_fd, char* s);
+
+//write the depth, mismatches, deletions and insertions of every query position to 'file_fd', returns false on failure
+bool write_coverage_tsv(FILE* file_fd, ednafull_summary* summary, ednafull_query* query);
+
+//align 'input' and write only the summary of the alignments (--summary-only), returns the number of records
+uint64_t handle_fastq_summary(ednafull_options* options, ednafull_input* input, ednafull_query* query);
+
+//initialize an empty heap of the 'k' best records of FASTQ file 'file_index', returns false if memory could not be allocated
+bool init_ednafull_top_k(ednafull_top_k* top_k, size_t k, size_t file_index);
+
+void free_ednafull_top_k(ednafull_top_k* top_k);
+
+//align 'input' and keep its best records in 'options->top_k_heap' (--top-k), returns the number of records
+uint64_t handle_fastq_top_k(ednafull_options* options, ednafull_input* input, ednafull_query* query);
+
+//write the TSV rows of the best records of all 'heap_count' heaps, returns the exit status
+int write_top_k(ednafull_options* options, ednafull_top_k* heaps, size_t heap_count, ednafull_query* query);
+
+//write the TSV rows of 'batch', returns false if writing to 'file_fd' failed
+bool write_tsv_batch_rows(FILE* file_fd, char* query_sequence_identifier, int64_t gap_penalty, gqss_alignment_batch* batch);
+
+//open the output file of a run of 'query', continue from its checkpoint file if 'options' ask to resume (NULL and 'options->status' on failure)
+FILE* open_checkpointed_output(ednafull_checkpoint* checkpoint, ednafull_options* options, ednafull_query* query, char* output_filename, size_t fastq_length);
+
+//record the position after 'batch' and write a checkpoint file once every checkpoint interval, returns false on failure
+bool update_checkpoint(ednafull_checkpoint* checkpoint, gqss_alignment_batch* batch);
+
+//remove the checkpoint file of a completed run, the checkpoint of a failed run is kept for --resume
+void finish_checkpoint(ednafull_checkpoint* checkpoint, bool completed);
+
+//write all 'slice_count' slices to 'file_fd' (modifying 'slices' on partial writes), returns false on failure
+bool write_slices(int file_fd, struct iovec* slices, size_t slice_count);
+
+//open the --matched-out and --unmatched-out files of 'options', returns false on failure
+bool open_ednafull_filter(ednafull_filter* filter, ednafull_options* options, gqss_alignment_callback callback, void* user_data);
+
+void close_ednafull_filter(ednafull_filter* filter);
+
+//gqss_alignment_callback of an ednafull_filter
+bool filter_batch(gqss_alignment_batch* batch, void* user_data);
+
+//initialize the --max-hits limit of a run against 'query', returns false on failure
+bool init_ednafull_hit_limit(ednafull_hit_limit* limit, uint64_t max_hits, int64_t min_score, ednafull_query* query);
+
+void free_ednafull_hit_limit(ednafull_hit_limit* limit);
+
+//check if the hit limit was reached
+bool ednafull_hit_limit_reached(ednafull_hit_limit* limit);
+
+//gqss_alignment_callback of an ednafull_hit_counter
+bool count_hits_batch(gqss_alignment_batch* batch, void* user_data);
+
+//print the number of hits and sequences of a run and whether it ended early
+void print_hit_limit_summary(ednafull_hit_limit* limit);
+
+//initialize the --stats counters of a run of 'file_count' FASTQ files and start its wall clock, returns false on failure
+bool init_ednafull_stats(ednafull_stats* stats, size_t file_count);
+
+void free_ednafull_stats(ednafull_stats* stats);
+
+//CLOCK_MONOTONIC time in nanoseconds, the start of a stage timed by add_ednafull_stage_time()
+uint64_t get_ednafull_stats_clock(void);
+
+//add the time since 'start_nanoseconds' to 'stage', returns the current time (the start of the next stage)
+uint64_t add_ednafull_stage_time(ednafull_stats* stats, ednafull_stage stage, uint64_t start_nanoseconds);
+
+//record whether the FASTQ file 'file' of the run was stopped before its end (e.g. by --max-hits)
+void set_ednafull_file_stopped(ednafull_stats* stats, size_t file, bool stopped);
+
+//add the counters of an alignment stream that read 'record_count' records and aligned 'aligned_count' of them
+void add_ednafull_stream_stats(ednafull_stats* stats, gqss_alignment_stream_stats* stream_stats, uint64_t record_count, uint64_t aligned_count);
+
+//start counting the work of the aligners of every query
+void enable_ednafull_query_stats(ednafull_query* queries, size_t query_count);
+
+//print the --stats report of a run with the aligner counters of 'queries'
+void print_ednafull_stats(ednafull_stats* stats, ednafull_query* queries, size_t query_count);
+
+//write the --report JSON object of a run that ended with exit status 'status', returns false if writing to 'file_fd' failed
+bool write_ednafull_report(FILE* file_fd, ednafull_stats* stats, ednafull_options* options, ednafull_query* queries, size_t query_count, int status);
+
+//write the --report JSON file of a run that ended with exit status 'status', returns false if writing failed
+bool save_ednafull_report(ednafull_stats* stats, ednafull_options* options, ednafull_query* queries, size_t query_count, int status);
+
+//prepare the sampling of 'input' by the --sample-* options, returns false if memory could not be allocated
+bool init_ednafull_sampler(ednafull_sampler* sampler, ednafull_options* options, ednafull_input* input);
+
+void free_ednafull_sampler(ednafull_sampler* sampler);
+
+//gqss_record_sampler of an ednafull_sampler
+uint64_t sample_record(uint64_t record_index, void* user_data);
+
+//serve alignment jobs on the Unix domain socket 'socket_filename' until SIGINT or SIGTERM, returns the exit status
+int run_ednafull_server(char* socket_filename, ednafull_query* queries, size_t query_count, int64_t gap_penalty);
+
 #endif /* EDNAFULL_LINEAR_SMITH_WATERMAN_H */
@@ -0,0 +1,303 @@
+/* Checkpoints of the Smith-Waterman algorithm with a linear gap penalty using
+ * the EDNAFULL substitution matrix.
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "ednafull_linear_smith_waterman.h"
+
+#include <sys/types.h>
+
+#define EDNAFULL_CHECKPOINT_VERSION 2
+
+//FNV-1a 64-bit offset basis and prime of the query hash
+#define EDNAFULL_CHECKPOINT_FNV_OFFSET UINT64_C(0xcbf29ce484222325)
+#define EDNAFULL_CHECKPOINT_FNV_PRIME UINT64_C(0x100000001b3)
+
+/*
+	uint64_t get_query_hash(ednafull_query* query)
+
+	get_query_hash() returns the FNV-1a hash of the identifier and the sequence of 'query', followed by a '\n' character each.
+*/
+static uint64_t get_query_hash(ednafull_query* query) {
+	char* strings[2] = {query->identifier, query->sequence};
+	uint64_t hash = EDNAFULL_CHECKPOINT_FNV_OFFSET;
+
+	for (size_t i = 0; i < 2; i++) {
+		for (char* c = strings[i]; *c != '\0'; c++) {
+			hash = (hash ^ (unsigned char)*c) * EDNAFULL_CHECKPOINT_FNV_PRIME;
+		}
+		hash = (hash ^ (unsigned char)'\n') * EDNAFULL_CHECKPOINT_FNV_PRIME;
+	}
+	return hash;
+}
+
+/*
+	bool read_checkpoint(ednafull_checkpoint* checkpoint, ednafull_options* options)
+
+	read_checkpoint() assigns the positions of the checkpoint file to 'checkpoint'. The function returns false if there is
+	no checkpoint file or if it was written for other FASTQ data or another shard. If the checkpoint was written with another
+	query, gap penalty, output type or sampling, whose rows can not be continued, 'options->status' is set to 1 as well.
+*/
+static bool read_checkpoint(ednafull_checkpoint* checkpoint, ednafull_options* options) {
+	unsigned int version;
+	uint64_t fastq_length;
+	size_t shard_index;
+	size_t shard_count;
+	uint64_t query_hash;
+	int64_t gap_penalty;
+	unsigned int output_flag;
+	double sample_fraction;
+	uint64_t sample_count;
+	uint64_t sample_every;
+	uint64_t sample_seed;
+
+	FILE* file_fd = fopen(checkpoint->filename, "rb");
+	if (file_fd == NULL) {
+		return false;
+	}
+
+	int fields = fscanf(file_fd, "gqss_checkpoint %u\nfastq_length %" SCNu64 "\nshard %zu/%zu\nrecords %" SCNu64 "\ninput_offset %" SCNu64 "\noutput_offset %" SCNu64 "\n"
+					"query %" SCNx64 "\ngap_penalty %" SCNd64 "\noutput %u\nsample_fraction %lf\nsample_count %" SCNu64 "\nsample_every %" SCNu64 "\nseed %" SCNu64 "\n",
+					&version, &fastq_length, &shard_index, &shard_count,
+					&checkpoint->record_count, &checkpoint->input_offset, &checkpoint->output_offset,
+					&query_hash, &gap_penalty, &output_flag, &sample_fraction, &sample_count, &sample_every, &sample_seed);
+	fclose(file_fd);
+
+	if ((fields != 14) || (version != EDNAFULL_CHECKPOINT_VERSION)) {
+		printf("warning: ignoring invalid checkpoint \"%s\"\n", checkpoint->filename);
+		return false;
+	}
+
+	//a followed FASTQ file has no known length (0)
+	if ((fastq_length != checkpoint->fastq_length) || (shard_index != checkpoint->shard_index) || (shard_count != checkpoint->shard_count)
+			|| ((fastq_length > 0) && (checkpoint->input_offset > fastq_length))) {
+		printf("warning: ignoring checkpoint \"%s\" of different FASTQ data\n", checkpoint->filename);
+		return false;
+	}
+
+	//the output so far has rows of these settings, appending other rows would silently mix them
+	if ((query_hash != checkpoint->query_hash) || (gap_penalty != checkpoint->gap_penalty) || (output_flag != checkpoint->output_flag)
+			|| (sample_fraction != checkpoint->sample_fraction) || (sample_count != checkpoint->sample_count)
+			|| (sample_every != checkpoint->sample_every) || (sample_seed != checkpoint->sample_seed)) {
+		printf("error: checkpoint \"%s\" was written with another query, gap penalty, output type or sampling, rerun without --resume\n", checkpoint->filename);
+		options->status = 1;
+		return false;
+	}
+
+	return true;
+}
+
+/*
+	bool write_checkpoint(ednafull_checkpoint* checkpoint)
+
+	write_checkpoint() makes the output written so far durable and then replaces the checkpoint file with the current
+	positions. The checkpoint is written to a temporary file that is synced and renamed, so a checkpoint file never
+	describes output that was not synced to disk. The function returns false if the output or the checkpoint file could not
+	be written.
+*/
+static bool write_checkpoint(ednafull_checkpoint* checkpoint) {
+	if ((fflush(checkpoint->output_fd) != 0) || (fsync(fileno(checkpoint->output_fd)) != 0)) {
+		perror("write_checkpoint(): fsync(): error");
+		return false;
+	}
+
+	off_t output_offset = ftello(checkpoint->output_fd);
+	if (output_offset < 0) {
+		perror("write_checkpoint(): ftello(): error");
+		return false;
+	}
+	checkpoint->output_offset = (uint64_t)output_offset;
+
+	size_t filename_length = strlen(checkpoint->filename) + 4;
+	char* temporary_filename = (char *)malloc((filename_length + 1) * sizeof(char));
+	if (temporary_filename == NULL) {
+		perror("write_checkpoint(): malloc(): error");
+
+		//immediately exit
+		exit(1);
+	}
+	snprintf(temporary_filename, (filename_length + 1), "%s.tmp", checkpoint->filename);
+
+	FILE* file_fd = fopen(temporary_filename, "wb");
+	if (file_fd == NULL) {
+		perror("write_checkpoint(): fopen(): error");
+
+		free(temporary_filename);
+		return false;
+	}
+
+	fprintf(file_fd, "gqss_checkpoint %u\nfastq_length %" PRIu64 "\nshard %zu/%zu\nrecords %" PRIu64 "\ninput_offset %" PRIu64 "\noutput_offset %" PRIu64 "\n"
+			"query %016" PRIx64 "\ngap_penalty %" PRId64 "\noutput %u\nsample_fraction %.17g\nsample_count %" PRIu64 "\nsample_every %" PRIu64 "\nseed %" PRIu64 "\n",
+			EDNAFULL_CHECKPOINT_VERSION, checkpoint->fastq_length, checkpoint->shard_index, checkpoint->shard_count,
+			checkpoint->record_count, checkpoint->input_offset, checkpoint->output_offset,
+			checkpoint->query_hash, checkpoint->gap_penalty, checkpoint->output_flag, checkpoint->sample_fraction,
+			checkpoint->sample_count, checkpoint->sample_every, checkpoint->sample_seed);
+
+	if ((fflush(file_fd) != 0) || ferror(file_fd) || (fsync(fileno(file_fd)) != 0)) {
+		perror("write_checkpoint(): fprintf(): error");
+
+		fclose(file_fd);
+		free(temporary_filename);
+		return false;
+	}
+	fclose(file_fd);
+
+	bool renamed = (rename(temporary_filename, checkpoint->filename) == 0);
+	if (!renamed) {
+		perror("write_checkpoint(): rename(): error");
+	}
+
+	free(temporary_filename);
+	return renamed;
+}
+
+/*
+	FILE* open_checkpointed_output(ednafull_checkpoint* checkpoint, ednafull_options* options, ednafull_query* query, char* output_filename, size_t fastq_length)
+
+	open_checkpointed_output() opens the output file 'output_filename' for the alignments of 'query' to the 'fastq_length'
+	bytes of FASTQ data. With --resume and a matching checkpoint file, the output is truncated to the checkpointed offset and 'checkpoint' holds the record
+	index and FASTQ offset to continue from. Otherwise, the output file is truncated and the run starts from the first record.
+	The standard output "-" is written without checkpoints. The function returns a NULL pointer and sets 'options->status' if
+	the output file could not be opened or the checkpoint file does not match the settings of the run.
+*/
+FILE* open_checkpointed_output(ednafull_checkpoint* checkpoint, ednafull_options* options, ednafull_query* query, char* output_filename, size_t fastq_length) {
+	checkpoint->fastq_length = fastq_length;
+	checkpoint->shard_index = options->shard_index;
+	checkpoint->shard_count = options->shard_count;
+	checkpoint->query_hash = get_query_hash(query);
+	checkpoint->gap_penalty = options->gap_penalty;
+	checkpoint->output_flag = options->output_flag;
+	checkpoint->sample_fraction = options->sample_fraction;
+	checkpoint->sample_count = options->sample_count;
+	checkpoint->sample_every = options->sample_every;
+	checkpoint->sample_seed = options->sample_seed;
+	checkpoint->interval = options->checkpoint_interval;
+	checkpoint->record_count = 0;
+	checkpoint->input_offset = 0;
+	checkpoint->output_offset = 0;
+	checkpoint->resumed = false;
+
+	if (strcmp(output_filename, EDNAFULL_STANDARD_STREAM) == 0) {
+		//the standard output can be neither synced nor truncated, it is written without checkpoints
+		checkpoint->filename = NULL;
+		checkpoint->interval = 0;
+		checkpoint->next_record_count = 0;
+		checkpoint->output_fd = options->standard_output;
+		return checkpoint->output_fd;
+	}
+
+	size_t filename_length = strlen(output_filename) + strlen(EDNAFULL_CHECKPOINT_EXTENSION);
+	checkpoint->filename = (char *)malloc((filename_length + 1) * sizeof(char));
+	if (checkpoint->filename == NULL) {
+		perror("open_checkpointed_output(): malloc(): error");
+
+		//immediately exit
+		exit(1);
+	}
+	snprintf(checkpoint->filename, (filename_length + 1), "%s%s", output_filename, EDNAFULL_CHECKPOINT_EXTENSION);
+
+	bool resumed = options->resume && read_checkpoint(checkpoint, options);
+	if (options->status != 0) {
+		//the output of the checkpoint is left unchanged
+		checkpoint->output_fd = NULL;
+	}
+	else if (resumed) {
+		checkpoint->output_fd = fopen(output_filename, "r+b");
+		if (checkpoint->output_fd == NULL) {
+			perror("open_checkpointed_output(): fopen(): error");
+		}
+		else if ((ftruncate(fileno(checkpoint->output_fd), (off_t)checkpoint->output_offset) != 0)
+				|| (fseeko(checkpoint->output_fd, (off_t)checkpoint->output_offset, SEEK_SET) != 0)) {
+			//drop the output written after the checkpoint
+			perror("open_checkpointed_output(): ftruncate(): error");
+
+			fclose(checkpoint->output_fd);
+			checkpoint->output_fd = NULL;
+		}
+		else {
+			printf("Resuming after %" PRIu64 " sequences\n", checkpoint->record_count);
+			checkpoint->resumed = true;
+		}
+	}
+	else {
+		checkpoint->record_count = 0;
+		checkpoint->input_offset = 0;
+		checkpoint->output_offset = 0;
+
+		checkpoint->output_fd = fopen(output_filename, "wb");
+		if (checkpoint->output_fd == NULL) {
+			perror("open_checkpointed_output(): fopen(): error");
+		}
+	}
+
+	if (checkpoint->output_fd == NULL) {
+		if (options->status == 0) {
+			options->status = 2;
+		}
+		free(checkpoint->filename);
+		checkpoint->filename = NULL;
+		return NULL;
+	}
+
+	checkpoint->next_record_count = checkpoint->record_count + checkpoint->interval;
+	return checkpoint->output_fd;
+}
+
+/*
+	bool update_checkpoint(ednafull_checkpoint* checkpoint, gqss_alignment_batch* batch)
+
+	update_checkpoint() records the position after the last record of 'batch', whose output has been written, and writes a
+	checkpoint once every 'interval' records. The function returns false if the checkpoint could not be written.
+*/
+bool update_checkpoint(ednafull_checkpoint* checkpoint, gqss_alignment_batch* batch) {
+	if (batch->count == 0) {
+		return true;
+	}
+
+	gqss_fastq_record* last_record = &(batch->records[batch->count - 1]);
+	checkpoint->record_count = last_record->record_index + 1;
+	checkpoint->input_offset = last_record->offset + last_record->length;
+
+	if ((checkpoint->interval > 0) && (checkpoint->record_count >= checkpoint->next_record_count)) {
+		if (!write_checkpoint(checkpoint)) {
+			return false;
+		}
+		checkpoint->next_record_count = checkpoint->record_count + checkpoint->interval;
+	}
+	return true;
+}
+
+/*
+	void finish_checkpoint(ednafull_checkpoint* checkpoint, bool completed)
+
+	finish_checkpoint() removes the checkpoint file after the output file was closed, if it was 'completed'. The checkpoint
+	of a run that failed is kept, so that the run can be continued with --resume.
+*/
+void finish_checkpoint(ednafull_checkpoint* checkpoint, bool completed) {
+	if (checkpoint->filename == NULL) {
+		return;
+	}
+
+	if (completed && (unlink(checkpoint->filename) != 0) && (errno != ENOENT)) {
+		perror("finish_checkpoint(): unlink(): error");
+	}
+
+	free(checkpoint->filename);
+	checkpoint->filename = NULL;
+	return;
+}
@@ -0,0 +1,572 @@
+/* Demultiplexing of the Smith-Waterman algorithm with a linear gap penalty
+ * using the EDNAFULL substitution matrix.
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "ednafull_linear_smith_waterman.h"
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+//file name (without extension) of the bin of the reads scoring below --min-score against every query
+#define EDNAFULL_DEMUX_UNASSIGNED "unassigned"
+
+#define EDNAFULL_DEMUX_EXTENSION ".fastq"
+
+//size of the buffer of the records of a bin written at once
+#define EDNAFULL_DEMUX_BUFFER_SIZE (1 << 16)
+
+typedef struct ednafull_demux_bin ednafull_demux_bin;
+
+/*
+	ednafull_demux_bin is the FASTQ file of the reads assigned to one query. The records are copied to 'buffer' and written
+	once it is full. A bin whose file was closed to stay below the limit of open files ('fd' is -1) reopens it for
+	appending. The open bins form a list from the most ('previous' is a NULL pointer) to the least recently written one.
+*/
+struct ednafull_demux_bin {
+	char* filename;
+	int fd;
+	char* buffer;
+	size_t buffer_length;
+	ednafull_demux_bin* previous;
+	ednafull_demux_bin* next;
+	uint64_t record_count;
+};
+
+/*
+	ednafull_demux assigns each record of a batch to the bin of its best scoring query, the first of 'query_count' bins
+	with the highest score or the last bin (unassigned) if no score reaches 'min_score'. The first query is aligned by the
+	alignment stream, the others by the callback into 'forward' and 'reverse_complement'. 'status' is the exit status of an
+	alignment or a write that failed, which stopped the stream.
+*/
+typedef struct ednafull_demux {
+	ednafull_query* queries;
+	size_t query_count;
+	int64_t min_score;
+
+	ednafull_demux_bin* bins;
+	size_t bin_count;
+	size_t max_open_files;
+	size_t open_file_count;
+	ednafull_demux_bin* most_recent_bin;
+	ednafull_demux_bin* least_recent_bin;
+
+	gqss_batch_result forward;
+	gqss_batch_result reverse_complement;
+	size_t* read_offsets;
+	size_t* read_lengths;
+	int64_t* best_scores;
+	size_t* best_bins;
+
+	//records of a batch ordered by bin, the records of bin 'i' are at 'bin_starts[i]' to 'bin_starts[i + 1]'
+	size_t* bin_starts;
+	size_t* ordered_records;
+
+	int status;
+} ednafull_demux;
+
+/*
+	char* get_bin_filename(char* directory, char* identifier)
+
+	get_bin_filename() returns the newly allocated file name of the bin of the query 'identifier' (a FASTA header line
+	including the '>' character) in 'directory': the first word of the identifier with characters other than letters, digits,
+	'.', '-' and '_' replaced by '_'. The application exits if memory could not be allocated.
+*/
+static char* get_bin_filename(char* directory, char* identifier) {
+	if (identifier[0] == '>') {
+		identifier++;
+	}
+
+	size_t name_length = 0;
+	while ((identifier[name_length] != '\0') && (identifier[name_length] != ' ') && (identifier[name_length] != '\t')
+			&& (identifier[name_length] != '\r') && (identifier[name_length] != '\n')) {
+		name_length++;
+	}
+
+	size_t directory_length = strlen(directory);
+	size_t filename_length = directory_length + 1 + ((name_length > 0) ? name_length : 1) + strlen(EDNAFULL_DEMUX_EXTENSION);
+	char* filename = (char *)malloc((filename_length + 1) * sizeof(char));
+	if (filename == NULL) {
+		perror("get_bin_filename(): malloc(): error");
+
+		//immediately exit
+		exit(1);
+	}
+
+	memcpy(filename, directory, directory_length);
+	filename[directory_length] = '/';
+
+	char* name = filename + directory_length + 1;
+	for (size_t i = 0; i < name_length; i++) {
+		char c = identifier[i];
+		if (((c >= 'A') && (c <= 'Z')) || ((c >= 'a') && (c <= 'z')) || ((c >= '0') && (c <= '9')) || (c == '.') || (c == '-') || (c == '_')) {
+			name[i] = c;
+		}
+		else {
+			name[i] = '_';
+		}
+	}
+	if (name_length == 0) {
+		name[0] = '_';
+		name_length = 1;
+	}
+
+	snprintf((name + name_length), (strlen(EDNAFULL_DEMUX_EXTENSION) + 1), "%s", EDNAFULL_DEMUX_EXTENSION);
+	return filename;
+}
+
+static int compare_bin_filenames(const void* a, const void* b) {
+	return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/*
+	bool has_duplicate_bin_filenames(ednafull_demux* demux)
+
+	has_duplicate_bin_filenames() prints the first file name shared by 2 bins and returns true, if there is one.
+*/
+static bool has_duplicate_bin_filenames(ednafull_demux* demux) {
+	char** filenames = (char **)malloc(demux->bin_count * sizeof(char *));
+	if (filenames == NULL) {
+		perror("has_duplicate_bin_filenames(): malloc(): error");
+
+		//immediately exit
+		exit(1);
+	}
+
+	for (size_t i = 0; i < demux->bin_count; i++) {
+		filenames[i] = demux->bins[i].filename;
+	}
+	qsort(filenames, demux->bin_count, sizeof(char *), compare_bin_filenames);
+
+	bool duplicate = false;
+	for (size_t i = 1; i < demux->bin_count; i++) {
+		if (strcmp(filenames[i - 1], filenames[i]) == 0) {
+			printf("error: several query sequences are demultiplexed to \"%s\"!\n", filenames[i]);
+			duplicate = true;
+			break;
+		}
+	}
+
+	free(filenames);
+	return duplicate;
+}
+
+/*
+	void unlink_bin(ednafull_demux* demux, ednafull_demux_bin* bin)
+
+	unlink_bin() removes the open 'bin' from the list of open bins.
+*/
+static void unlink_bin(ednafull_demux* demux, ednafull_demux_bin* bin) {
+	if (bin->previous != NULL) {
+		bin->previous->next = bin->next;
+	}
+	else {
+		demux->most_recent_bin = bin->next;
+	}
+
+	if (bin->next != NULL) {
+		bin->next->previous = bin->previous;
+	}
+	else {
+		demux->least_recent_bin = bin->previous;
+	}
+
+	bin->previous = NULL;
+	bin->next = NULL;
+	return;
+}
+
+/*
+	void push_bin(ednafull_demux* demux, ednafull_demux_bin* bin)
+
+	push_bin() adds the open 'bin', which is not in the list of open bins, as the most recently written bin.
+*/
+static void push_bin(ednafull_demux* demux, ednafull_demux_bin* bin) {
+	bin->previous = NULL;
+	bin->next = demux->most_recent_bin;
+	if (demux->most_recent_bin != NULL) {
+		demux->most_recent_bin->previous = bin;
+	}
+	else {
+		demux->least_recent_bin = bin;
+	}
+	demux->most_recent_bin = bin;
+	return;
+}
+
+/*
+	bool write_bin_data(ednafull_demux_bin* bin, char* data, size_t length)
+
+	write_bin_data() writes 'length' bytes at 'data' to the open file of 'bin'. The function returns false if writing
+	failed.
+*/
+static bool write_bin_data(ednafull_demux_bin* bin, char* data, size_t length) {
+	struct iovec slice;
+	slice.iov_base = data;
+	slice.iov_len = length;
+
+	if (!write_slices(bin->fd, &slice, 1)) {
+		printf("error: failed to write \"%s\"!\n", bin->filename);
+		perror("write_bin_data(): writev(): error");
+		return false;
+	}
+	return true;
+}
+
+/*
+	bool open_bin(ednafull_demux* demux, ednafull_demux_bin* bin, int flags)
+
+	open_bin() opens the file of 'bin' with 'flags' as the most recently written bin. If 'max_open_files' files are open,
+	the least recently written bin is flushed and closed first. The function returns false if a file could not be written or
+	opened.
+*/
+static bool open_bin(ednafull_demux* demux, ednafull_demux_bin* bin, int flags) {
+	if (demux->open_file_count >= demux->max_open_files) {
+		ednafull_demux_bin* oldest_bin = demux->least_recent_bin;
+
+		if (oldest_bin->buffer_length > 0) {
+			if (!write_bin_data(oldest_bin, oldest_bin->buffer, oldest_bin->buffer_length)) {
+				return false;
+			}
+			oldest_bin->buffer_length = 0;
+		}
+
+		unlink_bin(demux, oldest_bin);
+		close(oldest_bin->fd);
+		oldest_bin->fd = -1;
+		demux->open_file_count--;
+	}
+
+	bin->fd = open(bin->filename, (O_WRONLY | O_CREAT | flags), 0666);
+	if (bin->fd < 0) {
+		printf("error: failed to open \"%s\"!\n", bin->filename);
+		perror("open_bin(): open(): error");
+		return false;
+	}
+	push_bin(demux, bin);
+	demux->open_file_count++;
+	return true;
+}
+
+/*
+	bool use_bin(ednafull_demux* demux, ednafull_demux_bin* bin)
+
+	use_bin() makes 'bin' the most recently written bin before it is written, reopening its file if it was closed. The
+	function returns false if a file could not be written or opened.
+*/
+static bool use_bin(ednafull_demux* demux, ednafull_demux_bin* bin) {
+	if (bin->fd < 0) {
+		return open_bin(demux, bin, O_APPEND);
+	}
+
+	unlink_bin(demux, bin);
+	push_bin(demux, bin);
+	return true;
+}
+
+/*
+	bool flush_bin(ednafull_demux* demux, ednafull_demux_bin* bin)
+
+	flush_bin() writes the buffered records of 'bin' to its file. The function returns false if writing failed.
+*/
+static bool flush_bin(ednafull_demux* demux, ednafull_demux_bin* bin) {
+	if (bin->buffer_length == 0) {
+		return true;
+	}
+
+	if ((!use_bin(demux, bin)) || (!write_bin_data(bin, bin->buffer, bin->buffer_length))) {
+		return false;
+	}
+	bin->buffer_length = 0;
+	return true;
+}
+
+/*
+	bool open_ednafull_demux(ednafull_demux* demux, ednafull_options* options, ednafull_query* queries, size_t query_count)
+
+	open_ednafull_demux() creates the --demux directory and truncates one FASTQ file per query and the file of the
+	unassigned reads. The function returns false if the directory or a file could not be created or 2 queries share a file
+	name.
+*/
+static bool open_ednafull_demux(ednafull_demux* demux, ednafull_options* options, ednafull_query* queries, size_t query_count) {
+	memset(demux, 0, sizeof(ednafull_demux));
+	demux->queries = queries;
+	demux->query_count = query_count;
+	demux->min_score = options->min_score;
+	demux->max_open_files = options->max_open_files;
+	demux->bin_count = query_count + 1;
+
+	gqss_batch_result_init(&demux->forward);
+	gqss_batch_result_init(&demux->reverse_complement);
+
+	if ((mkdir(options->demux_directory, 0777) != 0) && (errno != EEXIST)) {
+		perror("open_ednafull_demux(): mkdir(): error");
+		return false;
+	}
+
+	demux->bins = (ednafull_demux_bin *)calloc(demux->bin_count, sizeof(ednafull_demux_bin));
+	demux->read_offsets = (size_t *)malloc(EDNAFULL_BATCH_SIZE * sizeof(size_t));
+	demux->read_lengths = (size_t *)malloc(EDNAFULL_BATCH_SIZE * sizeof(size_t));
+	demux->best_scores = (int64_t *)malloc(EDNAFULL_BATCH_SIZE * sizeof(int64_t));
+	demux->best_bins = (size_t *)malloc(EDNAFULL_BATCH_SIZE * sizeof(size_t));
+	demux->bin_starts = (size_t *)malloc((demux->bin_count + 1) * sizeof(size_t));
+	demux->ordered_records = (size_t *)malloc(EDNAFULL_BATCH_SIZE * sizeof(size_t));
+
+	if ((demux->bins == NULL) || (demux->read_offsets == NULL) || (demux->read_lengths == NULL) || (demux->best_scores == NULL)
+			|| (demux->best_bins == NULL) || (demux->bin_starts == NULL) || (demux->ordered_records == NULL)) {
+		perror("open_ednafull_demux(): malloc(): error");
+
+		//immediately exit
+		exit(1);
+	}
+
+	for (size_t i = 0; i < demux->bin_count; i++) {
+		demux->bins[i].fd = -1;
+		demux->bins[i].buffer = (char *)malloc(EDNAFULL_DEMUX_BUFFER_SIZE * sizeof(char));
+		if (demux->bins[i].buffer == NULL) {
+			perror("open_ednafull_demux(): malloc(): error");
+
+			//immediately exit
+			exit(1);
+		}
+		if (i < query_count) {
+			demux->bins[i].filename = get_bin_filename(options->demux_directory, queries[i].identifier);
+		}
+		else {
+			demux->bins[i].filename = get_bin_filename(options->demux_directory, EDNAFULL_DEMUX_UNASSIGNED);
+		}
+	}
+
+	if (has_duplicate_bin_filenames(demux)) {
+		return false;
+	}
+
+	//every bin is truncated now, so that no file of an earlier run is left behind, and appended to later
+	for (size_t i = 0; i < demux->bin_count; i++) {
+		if (!open_bin(demux, &(demux->bins[i]), O_TRUNC)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+	bool flush_ednafull_demux(ednafull_demux* demux)
+
+	flush_ednafull_demux() writes the records still buffered in every bin after the run. The function returns false if
+	writing failed.
+*/
+static bool flush_ednafull_demux(ednafull_demux* demux) {
+	for (size_t i = 0; i < demux->bin_count; i++) {
+		if (!flush_bin(demux, &(demux->bins[i]))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void close_ednafull_demux(ednafull_demux* demux) {
+	if (demux->bins != NULL) {
+		for (size_t i = 0; i < demux->bin_count; i++) {
+			if (demux->bins[i].fd >= 0) {
+				close(demux->bins[i].fd);
+			}
+			free(demux->bins[i].filename);
+			free(demux->bins[i].buffer);
+		}
+	}
+	free(demux->bins);
+	free(demux->read_offsets);
+	free(demux->read_lengths);
+	free(demux->best_scores);
+	free(demux->best_bins);
+	free(demux->bin_starts);
+	free(demux->ordered_records);
+
+	gqss_batch_result_free(&demux->forward);
+	gqss_batch_result_free(&demux->reverse_complement);
+	return;
+}
+
+/*
+	void update_best_scores(ednafull_demux* demux, size_t count, size_t bin, gqss_batch_result* forward, gqss_batch_result* reverse_complement)
+
+	update_best_scores() assigns the records that score higher against query 'bin' (or its reverse complement) than against
+	the queries before it to 'bin'.
+*/
+static void update_best_scores(ednafull_demux* demux, size_t count, size_t bin, gqss_batch_result* forward, gqss_batch_result* reverse_complement) {
+	for (size_t i = 0; i < count; i++) {
+		int64_t score = forward->scores[i];
+		if ((reverse_complement != NULL) && (reverse_complement->scores[i] > score)) {
+			score = reverse_complement->scores[i];
+		}
+
+		if ((bin == 0) || (score > demux->best_scores[i])) {
+			demux->best_scores[i] = score;
+			demux->best_bins[i] = bin;
+		}
+	}
+	return;
+}
+
+/*
+	bool write_bin(ednafull_demux* demux, ednafull_demux_bin* bin, gqss_alignment_batch* batch, size_t* records, size_t record_count)
+
+	write_bin() copies the 'record_count' records of 'batch' listed in 'records' to the buffer of 'bin', which is written to
+	the file whenever it is full. A record larger than the buffer is written directly. The function returns false if
+	writing failed.
+*/
+static bool write_bin(ednafull_demux* demux, ednafull_demux_bin* bin, gqss_alignment_batch* batch, size_t* records, size_t record_count) {
+	for (size_t i = 0; i < record_count; i++) {
+		gqss_fastq_record* record = &(batch->records[records[i]]);
+
+		//the identifier line starts the record, a newline character is appended to a last record of the input without one
+		bool has_newline = (record->identifier[record->length - 1] == '\n');
+		size_t length = record->length + (has_newline ? 0 : 1);
+
+		if ((bin->buffer_length + length > EDNAFULL_DEMUX_BUFFER_SIZE) && (!flush_bin(demux, bin))) {
+			return false;
+		}
+
+		if (length > EDNAFULL_DEMUX_BUFFER_SIZE) {
+			if ((!use_bin(demux, bin)) || (!write_bin_data(bin, record->identifier, record->length))
+					|| ((!has_newline) && (!write_bin_data(bin, "\n", 1)))) {
+				return false;
+			}
+			continue;
+		}
+
+		memcpy((bin->buffer + bin->buffer_length), record->identifier, record->length);
+		bin->buffer_length = bin->buffer_length + record->length;
+		if (!has_newline) {
+			bin->buffer[bin->buffer_length] = '\n';
+			bin->buffer_length++;
+		}
+	}
+
+	bin->record_count = bin->record_count + record_count;
+	return true;
+}
+
+/*
+	bool demux_batch(gqss_alignment_batch* batch, void* user_data)
+
+	demux_batch() aligns the records of 'batch' against the other queries of the ednafull_demux 'user_data' and appends every
+	record to the bin of its best scoring query. The records are slices of the input buffer that is only valid during the
+	callback, so they are copied to the buffers of the bins. If aligning or writing failed, 'status' is set and the stream
+	is stopped.
+*/
+static bool demux_batch(gqss_alignment_batch* batch, void* user_data) {
+	ednafull_demux* demux = (ednafull_demux *)user_data;
+
+	if (batch->count == 0) {
+		return true;
+	}
+
+	update_best_scores(demux, batch->count, 0, batch->forward, batch->reverse_complement);
+
+	//the records of a batch are found in the same input buffer, which starts before the first record
+	char* reads = batch->records[0].identifier;
+	for (size_t i = 0; i < batch->count; i++) {
+		demux->read_offsets[i] = (size_t)(batch->records[i].sequence - reads);
+		demux->read_lengths[i] = batch->records[i].sequence_length;
+	}
+
+	for (size_t q = 1; q < demux->query_count; q++) {
+		ednafull_query* query = &(demux->queries[q]);
+
+		if ((!gqss_batch_aligner_align(query->batch_aligner, reads, demux->read_offsets, demux->read_lengths, batch->count, &demux->forward))
+				|| (!gqss_batch_aligner_align(query->reverse_complement_batch_aligner, reads, demux->read_offsets, demux->read_lengths, batch->count, &demux->reverse_complement))) {
+			printf("error: demux_batch(): failed to align FASTQ records!\n");
+
+			demux->status = 1;
+			return false;
+		}
+		update_best_scores(demux, batch->count, q, &demux->forward, &demux->reverse_complement);
+	}
+
+	//counting sort of the records by bin, keeping the input order within a bin
+	memset(demux->bin_starts, 0, (demux->bin_count + 1) * sizeof(size_t));
+	for (size_t i = 0; i < batch->count; i++) {
+		if (demux->best_scores[i] < demux->min_score) {
+			demux->best_bins[i] = demux->query_count;
+		}
+		demux->bin_starts[demux->best_bins[i] + 1]++;
+	}
+	for (size_t i = 0; i < demux->bin_count; i++) {
+		demux->bin_starts[i + 1] = demux->bin_starts[i + 1] + demux->bin_starts[i];
+	}
+	for (size_t i = 0; i < batch->count; i++) {
+		size_t bin = demux->best_bins[i];
+		demux->ordered_records[demux->bin_starts[bin]] = i;
+		demux->bin_starts[bin]++;
+	}
+
+	//the placement advanced each start to the end of its bin
+	size_t start = 0;
+	for (size_t i = 0; i < demux->bin_count; i++) {
+		size_t end = demux->bin_starts[i];
+		if ((end > start) && (!write_bin(demux, &(demux->bins[i]), batch, (demux->ordered_records + start), (end - start)))) {
+			demux->status = 2;
+			return false;
+		}
+		start = end;
+	}
+	return true;
+}
+
+/*
+	uint64_t handle_fastq_demux(ednafull_options* options, ednafull_input* input, ednafull_query* queries, size_t query_count)
+
+	handle_fastq_demux() writes every FASTQ record of 'input' unchanged to the --demux FASTQ file of the query (of
+	'query_count' queries) it scores best against, or to "unassigned.fastq" if it scores below --min-score against every
+	query. The function returns the number of sequences parsed, 'options->status' is set if the records could not be aligned
+	or written.
+*/
+uint64_t handle_fastq_demux(ednafull_options* options, ednafull_input* input, ednafull_query* queries, size_t query_count) {
+	ednafull_demux demux;
+
+	if (!open_ednafull_demux(&demux, options, queries, query_count)) {
+		printf("error: handle_fastq_demux(): failed to create the demultiplexed FASTQ files!\n");
+
+		close_ednafull_demux(&demux);
+
+		options->status = 2;
+		return 0;
+	}
+
+	//no alignment output, no checkpoint
+	ednafull_checkpoint checkpoint;
+	memset(&checkpoint, 0, sizeof(ednafull_checkpoint));
+
+	uint64_t sequence_count = align_ednafull_input(input, options, &queries[0], &checkpoint, demux_batch, &demux);
+	if ((demux.status == 0) && (!flush_ednafull_demux(&demux))) {
+		demux.status = 2;
+	}
+	if (demux.status != 0) {
+		options->status = demux.status;
+	}
+
+	for (size_t i = 0; i < demux.bin_count; i++) {
+		printf("%" PRIu64 "\t%s\n", demux.bins[i].record_count, demux.bins[i].filename);
+	}
+
+	close_ednafull_demux(&demux);
+	return sequence_count;
+}
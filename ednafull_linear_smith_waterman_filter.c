@@ -0,0 +1,306 @@
+/* Matched/unmatched FASTQ outputs and hit limit of the Smith-Waterman algorithm
+ * with a linear gap penalty using the EDNAFULL substitution matrix.
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "ednafull_linear_smith_waterman.h"
+
+#include <fcntl.h>
+#include <limits.h>
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+//the newline character appended to a last record of the input without one
+static char record_newline[1] = {'\n'};
+
+/*
+	bool write_slices(int file_fd, struct iovec* slices, size_t slice_count)
+
+	write_slices() writes every slice of 'slices' to 'file_fd' with writev(), IOV_MAX slices at a time. A partial write
+	continues with the rest of the slices (whose entries are modified). The function returns false if writing failed.
+*/
+bool write_slices(int file_fd, struct iovec* slices, size_t slice_count) {
+	while (slice_count > 0) {
+		int write_count = (slice_count < IOV_MAX) ? (int)slice_count : IOV_MAX;
+
+		ssize_t bytes_written = writev(file_fd, slices, write_count);
+		if (bytes_written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+
+		//skip the slices written completely
+		size_t remaining = (size_t)bytes_written;
+		while ((slice_count > 0) && (remaining >= slices->iov_len)) {
+			remaining = remaining - slices->iov_len;
+			slices++;
+			slice_count--;
+		}
+
+		//continue within a partially written slice
+		if (remaining > 0) {
+			slices->iov_base = (char *)slices->iov_base + remaining;
+			slices->iov_len = slices->iov_len - remaining;
+		}
+	}
+	return true;
+}
+
+/*
+	bool open_record_output(ednafull_record_output* output, char* filename, size_t slice_capacity)
+
+	open_record_output() creates (or truncates) the FASTQ file 'filename' for the records of up to 'slice_capacity' / 2
+	records per batch. The function returns false on failure.
+*/
+static bool open_record_output(ednafull_record_output* output, char* filename, size_t slice_capacity) {
+	output->filename = filename;
+	output->slice_count = 0;
+	output->record_count = 0;
+	output->fd = -1;
+	output->slices = NULL;
+
+	if (filename == NULL) {
+		return true;
+	}
+
+	output->slices = (struct iovec *)malloc(slice_capacity * sizeof(struct iovec));
+	if (output->slices == NULL) {
+		perror("open_record_output(): malloc(): error");
+		return false;
+	}
+
+	output->fd = open(filename, (O_WRONLY | O_CREAT | O_TRUNC), 0666);
+	if (output->fd < 0) {
+		perror("open_record_output(): open(): error");
+		return false;
+	}
+	return true;
+}
+
+static void close_record_output(ednafull_record_output* output) {
+	if (output->fd >= 0) {
+		close(output->fd);
+	}
+	free(output->slices);
+	output->slices = NULL;
+	return;
+}
+
+/*
+	void add_record_slice(ednafull_record_output* output, gqss_fastq_record* record)
+
+	add_record_slice() queues the 4 lines of 'record' as a slice of the input buffer. Nothing is copied, the slices are written
+	before the input buffer changes.
+*/
+static void add_record_slice(ednafull_record_output* output, gqss_fastq_record* record) {
+	if (output->fd < 0) {
+		return;
+	}
+
+	//the identifier line starts the record
+	output->slices[output->slice_count].iov_base = record->identifier;
+	output->slices[output->slice_count].iov_len = record->length;
+	output->slice_count++;
+
+	if (record->identifier[record->length - 1] != '\n') {
+		output->slices[output->slice_count].iov_base = record_newline;
+		output->slices[output->slice_count].iov_len = 1;
+		output->slice_count++;
+	}
+	output->record_count++;
+	return;
+}
+
+//write the queued records of 'output', returns false on failure
+static bool flush_record_output(ednafull_record_output* output) {
+	if ((output->fd >= 0) && (!write_slices(output->fd, output->slices, output->slice_count))) {
+		perror("flush_record_output(): writev(): error");
+		return false;
+	}
+	output->slice_count = 0;
+	return true;
+}
+
+/*
+	bool open_ednafull_filter(ednafull_filter* filter, ednafull_options* options, gqss_alignment_callback callback, void* user_data)
+
+	open_ednafull_filter() opens the --matched-out and --unmatched-out FASTQ files of 'options'. The filter passes every batch
+	on to 'callback' (if it is not a NULL pointer). The function returns false if a file could not be opened.
+*/
+bool open_ednafull_filter(ednafull_filter* filter, ednafull_options* options, gqss_alignment_callback callback, void* user_data) {
+	filter->min_score = options->min_score;
+	filter->callback = callback;
+	filter->user_data = user_data;
+	filter->failed = false;
+
+	//a record takes up to 2 slices (record and missing newline character)
+	bool opened = open_record_output(&filter->matched, options->matched_filename, (2 * EDNAFULL_BATCH_SIZE));
+	opened = open_record_output(&filter->unmatched, (opened ? options->unmatched_filename : NULL), (2 * EDNAFULL_BATCH_SIZE)) && opened;
+	if (!opened) {
+		close_ednafull_filter(filter);
+	}
+	return opened;
+}
+
+void close_ednafull_filter(ednafull_filter* filter) {
+	close_record_output(&filter->matched);
+	close_record_output(&filter->unmatched);
+	return;
+}
+
+/*
+	bool filter_batch(gqss_alignment_batch* batch, void* user_data)
+
+	filter_batch() writes each record of 'batch' to the matched FASTQ file if its alignment against the query or its reverse
+	complement scores at least the minimum score, or to the unmatched FASTQ file otherwise. If writing failed, 'failed' is set
+	and the stream is stopped.
+*/
+bool filter_batch(gqss_alignment_batch* batch, void* user_data) {
+	ednafull_filter* filter = (ednafull_filter *)user_data;
+
+	for (size_t i = 0; i < batch->count; i++) {
+		int64_t score = batch->forward->scores[i];
+		if ((batch->reverse_complement != NULL) && (batch->reverse_complement->scores[i] > score)) {
+			score = batch->reverse_complement->scores[i];
+		}
+
+		if (score >= filter->min_score) {
+			add_record_slice(&filter->matched, &(batch->records[i]));
+		}
+		else {
+			add_record_slice(&filter->unmatched, &(batch->records[i]));
+		}
+	}
+
+	if ((!flush_record_output(&filter->matched)) || (!flush_record_output(&filter->unmatched))) {
+		filter->failed = true;
+		return false;
+	}
+
+	if (filter->callback != NULL) {
+		return filter->callback(batch, filter->user_data);
+	}
+	return true;
+}
+
+/*
+	bool init_ednafull_hit_limit(ednafull_hit_limit* limit, uint64_t max_hits, int64_t min_score, ednafull_query* query)
+
+	init_ednafull_hit_limit() initializes the limit of 'max_hits' records scoring at least 'min_score' against 'query' or its
+	reverse complement. The function returns false if the mutex could not be initialized.
+*/
+bool init_ednafull_hit_limit(ednafull_hit_limit* limit, uint64_t max_hits, int64_t min_score, ednafull_query* query) {
+	limit->max_hits = max_hits;
+	limit->min_score = min_score;
+	limit->hit_count = 0;
+	limit->record_count = 0;
+	limit->reached = false;
+	limit->query = query;
+
+	if (pthread_mutex_init(&limit->mutex, NULL) != 0) {
+		perror("init_ednafull_hit_limit(): pthread_mutex_init(): error");
+		return false;
+	}
+	return true;
+}
+
+void free_ednafull_hit_limit(ednafull_hit_limit* limit) {
+	pthread_mutex_destroy(&limit->mutex);
+	return;
+}
+
+//check if the hit limit was reached
+bool ednafull_hit_limit_reached(ednafull_hit_limit* limit) {
+	pthread_mutex_lock(&limit->mutex);
+	bool reached = limit->reached;
+	pthread_mutex_unlock(&limit->mutex);
+	return reached;
+}
+
+/*
+	bool count_hits_batch(gqss_alignment_batch* batch, void* user_data)
+
+	count_hits_batch() counts the records of 'batch' scoring at least the minimum score of the ednafull_hit_counter
+	'user_data'. Once the limit is reached, the batch is cut after the last hit and passed on, the batch aligners are
+	cancelled and the stream is stopped. A batch aligned by another file after the limit was reached is dropped. The stream
+	only counts the records passed on as read.
+*/
+bool count_hits_batch(gqss_alignment_batch* batch, void* user_data) {
+	ednafull_hit_counter* counter = (ednafull_hit_counter *)user_data;
+	ednafull_hit_limit* limit = counter->limit;
+
+	pthread_mutex_lock(&limit->mutex);
+	if (limit->reached) {
+		pthread_mutex_unlock(&limit->mutex);
+
+		//none of the records was consumed
+		batch->count = 0;
+		return false;
+	}
+
+	size_t record_count = batch->count;
+	for (size_t i = 0; i < batch->count; i++) {
+		int64_t score = batch->forward->scores[i];
+		if ((batch->reverse_complement != NULL) && (batch->reverse_complement->scores[i] > score)) {
+			score = batch->reverse_complement->scores[i];
+		}
+
+		if (score >= limit->min_score) {
+			limit->hit_count++;
+			if (limit->hit_count == limit->max_hits) {
+				record_count = i + 1;
+				limit->reached = true;
+				break;
+			}
+		}
+	}
+	limit->record_count = limit->record_count + record_count;
+	bool reached = limit->reached;
+	pthread_mutex_unlock(&limit->mutex);
+
+	if (reached) {
+		//stop the batches of the other FASTQ files still queued in the thread pool
+		gqss_batch_aligner_cancel(limit->query->batch_aligner);
+		gqss_batch_aligner_cancel(limit->query->reverse_complement_batch_aligner);
+	}
+
+	batch->count = record_count;
+
+	bool next = true;
+	if (counter->callback != NULL) {
+		next = counter->callback(batch, counter->user_data);
+	}
+	return (next && (!reached));
+}
+
+//print the number of hits and sequences of a run and whether it ended early
+void print_hit_limit_summary(ednafull_hit_limit* limit) {
+	if (limit->reached) {
+		printf("Stopped early: %" PRIu64 " hits (minimum score %" PRId64 ") found in the first %" PRIu64 " sequences\n",
+				limit->hit_count, limit->min_score, limit->record_count);
+	}
+	else {
+		printf("%" PRIu64 " of %" PRIu64 " hits (minimum score %" PRId64 ") found in %" PRIu64 " sequences, the input was aligned completely\n",
+				limit->hit_count, limit->max_hits, limit->min_score, limit->record_count);
+	}
+	return;
+}
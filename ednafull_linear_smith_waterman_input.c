@@ -0,0 +1,295 @@
+/* FASTQ input of the Smith-Waterman algorithm with a linear gap penalty using
+ * the EDNAFULL substitution matrix.
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "ednafull_linear_smith_waterman.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/*
+	bool is_follow_finished(ednafull_options* options, struct timespec* last_data_time)
+
+	is_follow_finished() checks if a followed FASTQ file is complete: the sentinel file exists or no data was appended for
+	the follow timeout.
+*/
+static bool is_follow_finished(ednafull_options* options, struct timespec* last_data_time) {
+	struct stat sentinel_stat;
+	struct timespec current_time;
+
+	if ((options->follow_sentinel != NULL) && (stat(options->follow_sentinel, &sentinel_stat) == 0)) {
+		return true;
+	}
+
+	if (options->follow_timeout > 0) {
+		clock_gettime(CLOCK_MONOTONIC, &current_time);
+
+		double idle_seconds = (double)(current_time.tv_sec - last_data_time->tv_sec) + ((double)(current_time.tv_nsec - last_data_time->tv_nsec) * 0.000000001);
+		if (idle_seconds >= (double)options->follow_timeout) {
+			printf("No FASTQ data appended for %u seconds, stopping\n", options->follow_timeout);
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+	bool feed_stream(gqss_alignment_stream* stream, char* data, size_t length, bool end_of_input, size_t* bytes_consumed, ednafull_options* options)
+
+	feed_stream() feeds 'data' to 'stream'. The function returns false and sets 'options->status' if an alignment failed.
+*/
+static bool feed_stream(gqss_alignment_stream* stream, char* data, size_t length, bool end_of_input, size_t* bytes_consumed, ednafull_options* options) {
+	if (!gqss_alignment_stream_feed(stream, data, length, end_of_input, bytes_consumed)) {
+		printf("error: align_ednafull_input(): failed to align FASTQ records!\n");
+
+		options->status = 1;
+		return false;
+	}
+	return true;
+}
+
+/*
+	void align_file_descriptor(gqss_alignment_stream* stream, int file_fd, ednafull_options* options)
+
+	align_file_descriptor() reads 'file_fd' in chunks of EDNAFULL_READ_BUFFER_SIZE bytes and feeds them to 'stream'. The
+	bytes of a partial record stay buffered until the rest of the record was read. With --follow, the end of the file is
+	polled for appended data until is_follow_finished(). 'options->status' is set if reading or aligning failed.
+*/
+static void align_file_descriptor(gqss_alignment_stream* stream, int file_fd, ednafull_options* options) {
+	struct timespec last_data_time;
+	struct timespec poll_interval;
+	size_t bytes_consumed;
+
+	poll_interval.tv_sec = EDNAFULL_FOLLOW_POLL_INTERVAL_MS / 1000;
+	poll_interval.tv_nsec = (EDNAFULL_FOLLOW_POLL_INTERVAL_MS % 1000) * 1000000L;
+
+	size_t capacity = EDNAFULL_READ_BUFFER_SIZE;
+	size_t buffered = 0;
+	char* buffer = (char *)malloc(capacity * sizeof(char));
+	if (buffer == NULL) {
+		perror("align_file_descriptor(): malloc(): error");
+
+		//immediately exit
+		exit(1);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &last_data_time);
+
+	/*
+		Once a followed file is finished, it is read until the end once more: data may have been appended between the
+		last read and the creation of the sentinel file.
+	*/
+	bool finished = false;
+	while ((options->status == 0) && (!gqss_alignment_stream_stopped(stream))) {
+		if (capacity - buffered < EDNAFULL_READ_BUFFER_SIZE) {
+			//a single record is larger than the free space of the buffer
+			capacity = capacity * 2;
+			char* larger_buffer = (char *)realloc(buffer, capacity * sizeof(char));
+			if (larger_buffer == NULL) {
+				perror("align_file_descriptor(): realloc(): error");
+
+				//immediately exit
+				exit(1);
+			}
+			buffer = larger_buffer;
+		}
+
+		ssize_t bytes_read = read(file_fd, buffer + buffered, (capacity - buffered));
+		if (bytes_read < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			perror("align_file_descriptor(): read(): error");
+
+			options->status = 2;
+			break;
+		}
+
+		if (bytes_read > 0) {
+			buffered = buffered + (size_t)bytes_read;
+
+			if (!feed_stream(stream, buffer, buffered, false, &bytes_consumed, options)) {
+				break;
+			}
+
+			//keep the partial record at the end of the buffer
+			buffered = buffered - bytes_consumed;
+			memmove(buffer, buffer + bytes_consumed, buffered);
+
+			clock_gettime(CLOCK_MONOTONIC, &last_data_time);
+			finished = false;
+			continue;
+		}
+
+		//end of file
+		if ((!options->follow) || finished) {
+			break;
+		}
+
+		finished = is_follow_finished(options, &last_data_time);
+		if (!finished) {
+			nanosleep(&poll_interval, NULL);
+		}
+	}
+
+	if ((options->status == 0) && (!gqss_alignment_stream_stopped(stream))) {
+		feed_stream(stream, buffer, buffered, true, &bytes_consumed, options);
+	}
+
+	free(buffer);
+	return;
+}
+
+/*
+	uint64_t align_ednafull_input(ednafull_input* input, ednafull_options* options, ednafull_query* query, ednafull_checkpoint* checkpoint, gqss_alignment_callback callback, void* user_data)
+
+	align_ednafull_input() streams the FASTQ records of 'input' (or the records chosen by the --sample-* options) through the
+	aligners of 'query', the --max-hits counter, the --coverage pileup, the --matched-out and --unmatched-out filter and the
+	given callback, starting from the record index and offset of 'checkpoint'. 'options->stopped' is set if the run ended
+	before the end of the input (e.g. by --max-hits), 'options->status' if reading, aligning or writing the --matched-out,
+	--unmatched-out or --coverage files failed. The function returns the number of FASTQ records read (including the
+	records read before the checkpoint).
+*/
+uint64_t align_ednafull_input(ednafull_input* input, ednafull_options* options, ednafull_query* query, ednafull_checkpoint* checkpoint, gqss_alignment_callback callback, void* user_data) {
+	size_t bytes_consumed;
+	ednafull_filter filter;
+	ednafull_summary coverage;
+	ednafull_hit_counter hit_counter;
+	ednafull_sampler sampler;
+	gqss_alignment_stream_stats stream_stats;
+
+	//the records are written to the FASTQ outputs of the filter before the batch is passed on
+	bool filtered = (options->matched_filename != NULL) || (options->unmatched_filename != NULL);
+	if (filtered) {
+		if (!open_ednafull_filter(&filter, options, callback, user_data)) {
+			printf("error: align_ednafull_input(): failed to open the matched/unmatched FASTQ files!\n");
+
+			options->status = 2;
+			return checkpoint->record_count;
+		}
+		callback = filter_batch;
+		user_data = &filter;
+	}
+
+	if (options->coverage_filename != NULL) {
+		if (!init_ednafull_summary(&coverage, query, options->min_score)) {
+			//immediately exit
+			exit(1);
+		}
+		coverage.stats = options->stats;
+		coverage.callback = callback;
+		coverage.user_data = user_data;
+
+		callback = summarize_batch;
+		user_data = &coverage;
+	}
+
+	//the hits are counted first, so that every output ends with the last hit
+	if (options->hit_limit != NULL) {
+		hit_counter.limit = options->hit_limit;
+		hit_counter.callback = callback;
+		hit_counter.user_data = user_data;
+
+		callback = count_hits_batch;
+		user_data = &hit_counter;
+	}
+
+	gqss_alignment_stream* stream = gqss_alignment_stream_create(query->batch_aligner, query->reverse_complement_batch_aligner, EDNAFULL_BATCH_SIZE, callback, user_data);
+	if (stream == NULL) {
+		printf("error: align_ednafull_input(): failed to create alignment stream!\n");
+
+		//immediately exit
+		exit(1);
+	}
+
+	if (options->stats != NULL) {
+		memset(&stream_stats, 0, sizeof(gqss_alignment_stream_stats));
+		gqss_alignment_stream_set_stats(stream, &stream_stats);
+	}
+
+	//the outputs update 'checkpoint' while the records are aligned
+	uint64_t first_record_count = checkpoint->record_count;
+	gqss_alignment_stream_set_position(stream, checkpoint->record_count, checkpoint->input_offset);
+
+	bool sampled = (options->sample_every > 0) || (options->sample_count > 0) || (options->sample_fraction < 1.0);
+	if (sampled) {
+		if (!init_ednafull_sampler(&sampler, options, input)) {
+			//immediately exit
+			exit(1);
+		}
+		gqss_alignment_stream_set_sampler(stream, sample_record, &sampler);
+	}
+
+	//--top-k ranks the records by score and aligns the best records again once the run is complete
+	if (options->top_k > 0) {
+		gqss_alignment_stream_set_traceback_cutoff(stream, INT64_MAX);
+	}
+
+	if (input->data != NULL) {
+		feed_stream(stream, (input->data + checkpoint->input_offset), (input->length - checkpoint->input_offset), true, &bytes_consumed, options);
+	}
+	else if ((checkpoint->input_offset > 0) && (lseek(input->fd, (off_t)checkpoint->input_offset, SEEK_SET) < 0)) {
+		perror("align_ednafull_input(): lseek(): error");
+		options->status = 2;
+	}
+	else {
+		align_file_descriptor(stream, input->fd, options);
+	}
+
+	uint64_t sequence_count = gqss_alignment_stream_record_count(stream);
+	options->stopped = gqss_alignment_stream_stopped(stream);
+
+	if (sampled) {
+		printf("Sampled %" PRIu64 " of %" PRIu64 " sequences\n", gqss_alignment_stream_aligned_count(stream), (sequence_count - first_record_count));
+		free_ednafull_sampler(&sampler);
+	}
+
+	if (options->stats != NULL) {
+		add_ednafull_stream_stats(options->stats, &stream_stats, (sequence_count - first_record_count), gqss_alignment_stream_aligned_count(stream));
+	}
+
+	gqss_alignment_stream_destroy(stream);
+
+	if (options->coverage_filename != NULL) {
+		FILE* coverage_fd = fopen(options->coverage_filename, "wb");
+		bool written = (coverage_fd != NULL) && write_coverage_tsv(coverage_fd, &coverage, query);
+		if ((coverage_fd != NULL) && (fclose(coverage_fd) != 0)) {
+			written = false;
+		}
+
+		if (written) {
+			printf("Coverage of %" PRIu64 " hits written to \"%s\"\n", coverage.hit_count, options->coverage_filename);
+		}
+		else {
+			perror("align_ednafull_input(): failed to write the coverage file");
+			options->status = 2;
+		}
+		free_ednafull_summary(&coverage);
+	}
+
+	if (filtered) {
+		if (filter.failed) {
+			options->status = 2;
+		}
+		printf("%" PRIu64 " matched and %" PRIu64 " unmatched sequences (minimum score %" PRId64 ")\n",
+				filter.matched.record_count, filter.unmatched.record_count, filter.min_score);
+		close_ednafull_filter(&filter);
+	}
+	return sequence_count;
+}
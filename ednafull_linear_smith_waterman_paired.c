@@ -0,0 +1,366 @@
+/* Paired-end reads of the Smith-Waterman algorithm with a linear gap penalty
+ * using the EDNAFULL substitution matrix.
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "ednafull_linear_smith_waterman.h"
+
+/*
+	ednafull_mate is the best alignment of one mate: on the query ('+') or on its reverse complement ('-'). The 1-based
+	query coordinates are given on the forward strand of the query.
+*/
+typedef struct ednafull_mate {
+	char* identifier;
+	size_t identifier_length;
+	size_t identifier_capacity;
+	char strand;
+	int64_t score;
+	size_t query_start;
+	size_t query_stop;
+} ednafull_mate;
+
+typedef struct paired_writer {
+	FILE* file_fd;
+	char* query_sequence_identifier;
+	size_t query_length;
+	int64_t min_score;
+	size_t max_fragment_length;
+	uint64_t pair_count;
+	ednafull_stats* stats;
+	bool failed;
+
+	//the first mate of a pair waits here if its second mate is found in the next batch
+	ednafull_mate first_mate;
+	bool first_mate_pending;
+} paired_writer;
+
+/*
+	void set_mate(ednafull_mate* mate, gqss_alignment_batch* batch, size_t i, size_t query_length)
+
+	set_mate() assigns the better of the alignments of record 'i' of 'batch' against the query and its reverse complement to
+	'mate', copying the record identifier.
+*/
+static void set_mate(ednafull_mate* mate, gqss_alignment_batch* batch, size_t i, size_t query_length) {
+	gqss_fastq_record* record = &(batch->records[i]);
+
+	if (mate->identifier_capacity < record->identifier_length + 1) {
+		char* identifier = (char *)realloc(mate->identifier, (record->identifier_length + 1) * sizeof(char));
+		if (identifier == NULL) {
+			perror("set_mate(): realloc(): error");
+
+			//immediately exit
+			exit(1);
+		}
+		mate->identifier = identifier;
+		mate->identifier_capacity = record->identifier_length + 1;
+	}
+	memcpy(mate->identifier, record->identifier, record->identifier_length);
+	mate->identifier[record->identifier_length] = '\0';
+	mate->identifier_length = record->identifier_length;
+
+	gqss_batch_result* forward = batch->forward;
+	gqss_batch_result* reverse_complement = batch->reverse_complement;
+
+	if ((forward->scores[i] < 0) && (reverse_complement->scores[i] < 0)) {
+		//empty read
+		mate->strand = '.';
+		mate->score = -1;
+		mate->query_start = 0;
+		mate->query_stop = 0;
+	}
+	else if (forward->scores[i] >= reverse_complement->scores[i]) {
+		mate->strand = '+';
+		mate->score = forward->scores[i];
+		mate->query_start = forward->query_starts[i] + 1;
+		mate->query_stop = forward->query_stops[i] + 1;
+	}
+	else {
+		//position p of the reverse complement is position (query_length - 1 - p) of the query
+		mate->strand = '-';
+		mate->score = reverse_complement->scores[i];
+		mate->query_start = query_length - reverse_complement->query_stops[i];
+		mate->query_stop = query_length - reverse_complement->query_starts[i];
+	}
+	return;
+}
+
+/*
+	bool write_pair_row(paired_writer* writer, ednafull_mate* first_mate, ednafull_mate* second_mate)
+
+	write_pair_row() writes the pair record of two mates. The fragment of mates aligned to opposite strands spans from the
+	first to the last query position covered by either mate. They form a proper pair if both mates score at least the
+	minimum score and the fragment is at most the maximum fragment length. The function returns false if writing failed.
+*/
+static bool write_pair_row(paired_writer* writer, ednafull_mate* first_mate, ednafull_mate* second_mate) {
+	size_t fragment_length = 0;
+	if ((first_mate->score > 0) && (second_mate->score > 0)
+			&& (first_mate->strand != second_mate->strand) && (first_mate->strand != '.') && (second_mate->strand != '.')) {
+		size_t fragment_start = (first_mate->query_start < second_mate->query_start) ? first_mate->query_start : second_mate->query_start;
+		size_t fragment_stop = (first_mate->query_stop > second_mate->query_stop) ? first_mate->query_stop : second_mate->query_stop;
+		fragment_length = fragment_stop - fragment_start + 1;
+	}
+
+	bool proper_pair = (fragment_length > 0) && (fragment_length <= writer->max_fragment_length)
+						&& (first_mate->score >= writer->min_score) && (second_mate->score >= writer->min_score);
+
+	int64_t pair_score = ((first_mate->score > 0) ? first_mate->score : 0) + ((second_mate->score > 0) ? second_mate->score : 0);
+
+	fprintf(writer->file_fd, "%s\t%" PRIu64 "\t%s\t%c\t%" PRId64 "\t%zu\t%zu\t%s\t%c\t%" PRId64 "\t%zu\t%zu\t%" PRId64 "\t%s\t%zu\n",
+			(writer->query_sequence_identifier + 1), writer->pair_count,
+			first_mate->identifier, first_mate->strand, first_mate->score, first_mate->query_start, first_mate->query_stop,
+			second_mate->identifier, second_mate->strand, second_mate->score, second_mate->query_start, second_mate->query_stop,
+			pair_score, (proper_pair ? "yes" : "no"), fragment_length);
+
+	writer->pair_count++;
+	return !ferror(writer->file_fd);
+}
+
+/*
+	bool write_paired_batch(gqss_alignment_batch* batch, void* user_data)
+
+	write_paired_batch() pairs up the records of 'batch', which alternate between first and second mates, and writes a pair
+	record for every pair. If writing failed, 'failed' is set and the stream is stopped.
+*/
+static bool write_paired_batch(gqss_alignment_batch* batch, void* user_data) {
+	paired_writer* writer = (paired_writer *)user_data;
+	ednafull_mate second_mate;
+
+	second_mate.identifier = NULL;
+	second_mate.identifier_capacity = 0;
+
+	uint64_t start_nanoseconds = (writer->stats != NULL) ? get_ednafull_stats_clock() : 0;
+
+	for (size_t i = 0; i < batch->count; i++) {
+		if (!writer->first_mate_pending) {
+			set_mate(&writer->first_mate, batch, i, writer->query_length);
+			writer->first_mate_pending = true;
+			continue;
+		}
+
+		set_mate(&second_mate, batch, i, writer->query_length);
+		writer->first_mate_pending = false;
+
+		if (!write_pair_row(writer, &writer->first_mate, &second_mate)) {
+			perror("write_paired_batch(): fprintf(): error");
+
+			free(second_mate.identifier);
+			writer->failed = true;
+			return false;
+		}
+	}
+
+	free(second_mate.identifier);
+
+	if (writer->stats != NULL) {
+		start_nanoseconds = add_ednafull_stage_time(writer->stats, EDNAFULL_STAGE_FORMAT, start_nanoseconds);
+	}
+
+	//flush the file stream
+	fflush(writer->file_fd);
+
+	if (writer->stats != NULL) {
+		add_ednafull_stage_time(writer->stats, EDNAFULL_STAGE_WRITE, start_nanoseconds);
+	}
+	return true;
+}
+
+/*
+	bool feed_mate_records(gqss_alignment_stream* stream, ednafull_input* first_input, ednafull_input* second_input)
+
+	feed_mate_records() reads the records of the mapped FASTQ files 'first_input' and 'second_input' in lockstep and feeds
+	them to 'stream' interleaved, so that both mates of a pair are aligned next to each other in the same batch. The pairs
+	end with the shorter file. The function returns false if an alignment failed.
+*/
+static bool feed_mate_records(gqss_alignment_stream* stream, ednafull_input* first_input, ednafull_input* second_input) {
+	ednafull_input* inputs[2] = {first_input, second_input};
+	size_t offsets[2] = {0, 0};
+	size_t record_counts[2];
+	size_t bytes_consumed;
+
+	size_t pair_capacity = EDNAFULL_BATCH_SIZE / 2;
+	gqss_fastq_record* records[2];
+	records[0] = (gqss_fastq_record *)malloc(pair_capacity * sizeof(gqss_fastq_record));
+	records[1] = (gqss_fastq_record *)malloc(pair_capacity * sizeof(gqss_fastq_record));
+
+	size_t chunk_capacity = EDNAFULL_READ_BUFFER_SIZE;
+	char* chunk = (char *)malloc(chunk_capacity * sizeof(char));
+	if ((records[0] == NULL) || (records[1] == NULL) || (chunk == NULL)) {
+		perror("feed_mate_records(): malloc(): error");
+
+		//immediately exit
+		exit(1);
+	}
+
+	bool aligned = true;
+	while (aligned && (!gqss_alignment_stream_stopped(stream))) {
+		//record offsets are relative to where the parsing started
+		size_t parse_starts[2] = {offsets[0], offsets[1]};
+
+		for (size_t mate = 0; mate < 2; mate++) {
+			offsets[mate] = offsets[mate] + parse_fastq_records((inputs[mate]->data + offsets[mate]), (inputs[mate]->length - offsets[mate]), true,
+															records[mate], pair_capacity, &record_counts[mate]);
+		}
+
+		size_t pair_count = (record_counts[0] < record_counts[1]) ? record_counts[0] : record_counts[1];
+		if (record_counts[0] != record_counts[1]) {
+			printf("warning: the mate FASTQ files have different numbers of records, ignoring the unpaired records\n");
+		}
+		if (pair_count == 0) {
+			break;
+		}
+
+		//copy the records interleaved, each ending with a newline character
+		size_t chunk_length = 0;
+		for (size_t i = 0; i < pair_count; i++) {
+			for (size_t mate = 0; mate < 2; mate++) {
+				gqss_fastq_record* record = &(records[mate][i]);
+				char* record_start = inputs[mate]->data + parse_starts[mate] + record->offset;
+
+				if (chunk_length + record->length + 1 > chunk_capacity) {
+					chunk_capacity = (chunk_length + record->length + 1) * 2;
+					char* larger_chunk = (char *)realloc(chunk, chunk_capacity * sizeof(char));
+					if (larger_chunk == NULL) {
+						perror("feed_mate_records(): realloc(): error");
+
+						//immediately exit
+						exit(1);
+					}
+					chunk = larger_chunk;
+				}
+
+				memcpy(chunk + chunk_length, record_start, record->length);
+				chunk_length = chunk_length + record->length;
+				if (chunk[chunk_length - 1] != '\n') {
+					chunk[chunk_length] = '\n';
+					chunk_length++;
+				}
+			}
+		}
+
+		aligned = gqss_alignment_stream_feed(stream, chunk, chunk_length, false, &bytes_consumed);
+		if (!aligned) {
+			printf("error: feed_mate_records(): failed to align FASTQ records!\n");
+		}
+
+		if (record_counts[0] != record_counts[1]) {
+			break;
+		}
+	}
+
+	free(records[0]);
+	free(records[1]);
+	free(chunk);
+	return aligned;
+}
+
+/*
+	uint64_t handle_fastq_paired(ednafull_options* options, ednafull_input* first_input, ednafull_input* second_input, ednafull_query* query)
+
+	handle_fastq_paired() aligns the mates of paired-end reads against 'query' and writes one pair record per pair to a tab
+	delimited values file. The mates are read from the mapped FASTQ files 'first_input' and 'second_input' (R1 and R2), or
+	from the interleaved FASTQ data 'first_input' if 'second_input' is a NULL pointer. The function returns the number of
+	pairs written, 'options->status' is set if the pairs could not be aligned or written.
+*/
+uint64_t handle_fastq_paired(ednafull_options* options, ednafull_input* first_input, ednafull_input* second_input, ednafull_query* query) {
+	struct timespec start_time;
+	struct timespec end_time;
+	ednafull_checkpoint checkpoint;
+
+	paired_writer writer;
+	writer.query_sequence_identifier = query->identifier;
+	writer.query_length = strlen(query->sequence);
+	writer.min_score = options->min_score;
+	writer.max_fragment_length = options->max_fragment_length;
+	writer.pair_count = 0;
+	writer.stats = options->stats;
+	writer.first_mate.identifier = NULL;
+	writer.first_mate.identifier_capacity = 0;
+	writer.first_mate_pending = false;
+	writer.failed = false;
+
+	char* new_filename = get_output_filename(options, ".sw.pairs.tsv");
+
+	printf("Writing pair records to \"%s\"\n", new_filename);
+
+	//a checkpoint could separate the mates of a pair, paired runs are written without checkpoints
+	ednafull_options paired_options = *options;
+	paired_options.checkpoint_interval = 0;
+	writer.file_fd = open_checkpointed_output(&checkpoint, &paired_options, query, new_filename, 0);
+
+	//free filename string allocation
+	free(new_filename);
+
+	if (writer.file_fd == NULL) {
+		options->status = paired_options.status;
+		return 0;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+	if (fprintf(writer.file_fd, "%s", "Reference Sequence Identifier\tPair Index\tMate 1 Identifier\tMate 1 Strand\tMate 1 Score\tMate 1 Reference Start\tMate 1 Reference Stop\tMate 2 Identifier\tMate 2 Strand\tMate 2 Score\tMate 2 Reference Start\tMate 2 Reference Stop\tPair Score\tProper Pair\tFragment Length\n") < 0) {
+		perror("handle_fastq_paired(): fprintf(): error");
+		writer.failed = true;
+	}
+	else if (second_input == NULL) {
+		align_ednafull_input(first_input, options, query, &checkpoint, write_paired_batch, &writer);
+	}
+	else {
+		gqss_alignment_stream* stream = gqss_alignment_stream_create(query->batch_aligner, query->reverse_complement_batch_aligner, EDNAFULL_BATCH_SIZE, write_paired_batch, &writer);
+		if (stream == NULL) {
+			printf("error: handle_fastq_paired(): failed to create alignment stream!\n");
+
+			//immediately exit
+			exit(1);
+		}
+
+		gqss_alignment_stream_stats stream_stats;
+		if (options->stats != NULL) {
+			memset(&stream_stats, 0, sizeof(gqss_alignment_stream_stats));
+			gqss_alignment_stream_set_stats(stream, &stream_stats);
+		}
+
+		if (!feed_mate_records(stream, first_input, second_input)) {
+			options->status = 1;
+		}
+
+		if (options->stats != NULL) {
+			add_ednafull_stream_stats(options->stats, &stream_stats, gqss_alignment_stream_record_count(stream), gqss_alignment_stream_aligned_count(stream));
+		}
+
+		gqss_alignment_stream_destroy(stream);
+	}
+
+	if (writer.failed) {
+		options->status = 2;
+	}
+
+	if (writer.first_mate_pending) {
+		printf("warning: ignoring the unpaired last record \"%s\" of the interleaved FASTQ file\n", writer.first_mate.identifier);
+	}
+
+	//close file descriptor
+	fclose(writer.file_fd);
+	finish_checkpoint(&checkpoint, (options->status == 0));
+
+	free(writer.first_mate.identifier);
+
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+	printf("[%11.2lf seconds]: %" PRIu64 " pairs parsed\n", ((double)(end_time.tv_sec - start_time.tv_sec) + ((double)(end_time.tv_nsec - start_time.tv_nsec) * 0.000000001)), writer.pair_count);
+
+	return writer.pair_count;
+}
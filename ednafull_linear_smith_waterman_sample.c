@@ -0,0 +1,154 @@
+/* Subsampling of the FASTQ records of the Smith-Waterman algorithm with a linear
+ * gap penalty using the EDNAFULL substitution matrix.
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "ednafull_linear_smith_waterman.h"
+
+/*
+	uint64_t mix_bits(uint64_t value)
+
+	mix_bits() is the finalizer of the SplitMix64 generator, it maps consecutive values to unrelated, uniformly distributed
+	values.
+*/
+static uint64_t mix_bits(uint64_t value) {
+	value = (value ^ (value >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+	value = (value ^ (value >> 27)) * UINT64_C(0x94d049bb133111eb);
+	return value ^ (value >> 31);
+}
+
+//next value of the SplitMix64 generator with state 'state'
+static uint64_t next_random(uint64_t* state) {
+	*state = (*state) + UINT64_C(0x9e3779b97f4a7c15);
+	return mix_bits(*state);
+}
+
+static int compare_record_indices(const void* a, const void* b) {
+	uint64_t index_a = *(const uint64_t *)a;
+	uint64_t index_b = *(const uint64_t *)b;
+
+	if (index_a < index_b) {
+		return -1;
+	}
+	return (index_a > index_b) ? 1 : 0;
+}
+
+/*
+	bool select_reservoir(ednafull_sampler* sampler, ednafull_input* input)
+
+	select_reservoir() chooses 'sampler->count' record indices of the mapped 'input' uniformly at random with reservoir
+	sampling (algorithm R), seeded with 'sampler->seed'. The records are only counted by their newline characters. The
+	function returns false if memory could not be allocated.
+*/
+static bool select_reservoir(ednafull_sampler* sampler, ednafull_input* input) {
+	size_t record_count;
+	skip_fastq_records(input->data, input->length, true, SIZE_MAX, &record_count);
+
+	size_t reservoir_size = (record_count < sampler->count) ? record_count : (size_t)sampler->count;
+	sampler->selected = (uint64_t *)malloc((reservoir_size + 1) * sizeof(uint64_t));
+	if (sampler->selected == NULL) {
+		perror("select_reservoir(): malloc(): error");
+		return false;
+	}
+
+	uint64_t state = sampler->seed;
+	for (size_t i = 0; i < record_count; i++) {
+		if (i < reservoir_size) {
+			sampler->selected[i] = i;
+			continue;
+		}
+
+		uint64_t j = next_random(&state) % ((uint64_t)i + 1);
+		if (j < reservoir_size) {
+			sampler->selected[j] = i;
+		}
+	}
+
+	//the records are aligned in input order
+	qsort(sampler->selected, reservoir_size, sizeof(uint64_t), compare_record_indices);
+	sampler->selected_count = reservoir_size;
+	sampler->next_selected = 0;
+	return true;
+}
+
+/*
+	bool init_ednafull_sampler(ednafull_sampler* sampler, ednafull_options* options, ednafull_input* input)
+
+	init_ednafull_sampler() prepares the --sample-every, --sample-fraction or --sample-count sampling of 'input'. A fixed
+	number of records needs the mapped FASTQ file, its records are chosen before the alignment starts. The function returns
+	false if memory could not be allocated.
+*/
+bool init_ednafull_sampler(ednafull_sampler* sampler, ednafull_options* options, ednafull_input* input) {
+	sampler->every = options->sample_every;
+	sampler->count = options->sample_count;
+	sampler->seed = options->sample_seed;
+	sampler->selected = NULL;
+	sampler->selected_count = 0;
+	sampler->next_selected = 0;
+
+	//a record is kept if the hash of its index is below the fraction of the range of hash values
+	sampler->threshold = UINT64_MAX;
+	if (options->sample_fraction < 1.0) {
+		sampler->threshold = (uint64_t)(options->sample_fraction * 18446744073709551616.0);
+	}
+
+	if (sampler->count > 0) {
+		assert(input->data != NULL);
+		return select_reservoir(sampler, input);
+	}
+	return true;
+}
+
+void free_ednafull_sampler(ednafull_sampler* sampler) {
+	free(sampler->selected);
+	sampler->selected = NULL;
+	return;
+}
+
+/*
+	uint64_t sample_record(uint64_t record_index, void* user_data)
+
+	sample_record() is the gqss_record_sampler of the ednafull_sampler 'user_data'. --sample-every skips to the next multiple
+	of the stride, --sample-count to the next chosen record and --sample-fraction keeps a record by the seeded hash of its
+	index, so that a resumed run chooses the same records.
+*/
+uint64_t sample_record(uint64_t record_index, void* user_data) {
+	ednafull_sampler* sampler = (ednafull_sampler *)user_data;
+
+	if (sampler->every > 0) {
+		uint64_t remainder = record_index % sampler->every;
+		return (remainder == 0) ? 0 : (sampler->every - remainder);
+	}
+
+	if (sampler->count > 0) {
+		if (sampler->next_selected == sampler->selected_count) {
+			//skip the rest of the input
+			return UINT64_MAX;
+		}
+
+		uint64_t next_index = sampler->selected[sampler->next_selected];
+		assert(next_index >= record_index);
+		if (next_index == record_index) {
+			sampler->next_selected++;
+			return 0;
+		}
+		return (next_index - record_index);
+	}
+
+	return (mix_bits(sampler->seed ^ mix_bits(record_index)) < sampler->threshold) ? 0 : 1;
+}
@@ -0,0 +1,559 @@
+/* Alignment server for the Smith-Waterman algorithm with a linear gap penalty
+ * using the EDNAFULL substitution matrix.
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "ednafull_linear_smith_waterman.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+//milliseconds between checks for a shutdown request while waiting for clients
+#define EDNAFULL_SERVER_POLL_TIMEOUT 250
+
+//largest FASTQ data of an 'ALIGN <QUERY> READS <BYTES>' request (1 GiB)
+#define EDNAFULL_SERVER_MAX_READS_BYTES ((size_t)1 << 30)
+
+static volatile sig_atomic_t ednafull_server_shutdown = 0;
+
+typedef struct ednafull_connection ednafull_connection;
+
+typedef struct ednafull_server {
+	int socket_fd;
+	ednafull_query* queries;
+	size_t query_count;
+	int64_t gap_penalty;
+
+	//open connections, guarded by 'mutex'
+	pthread_mutex_t mutex;
+	pthread_cond_t connections_closed;
+	ednafull_connection* connections;
+} ednafull_server;
+
+struct ednafull_connection {
+	ednafull_server* server;
+	int socket_fd;
+	FILE* input;
+	FILE* output;
+
+	//reusable request line and inline FASTQ data buffers
+	char* line;
+	size_t line_capacity;
+	char* reads;
+	size_t reads_capacity;
+
+	ednafull_connection* previous;
+	ednafull_connection* next;
+};
+
+typedef struct ednafull_job {
+	FILE* output;
+	ednafull_query* query;
+	int64_t gap_penalty;
+} ednafull_job;
+
+/*
+	void handle_shutdown_signal(int signal_number)
+
+	handle_shutdown_signal() requests the server to stop accepting connections.
+*/
+static void handle_shutdown_signal(int signal_number) {
+	(void)signal_number;
+	ednafull_server_shutdown = 1;
+	return;
+}
+
+/*
+	bool write_job_batch(gqss_alignment_batch* batch, void* user_data)
+
+	write_job_batch() streams the TSV rows of 'batch' to the client. The job is stopped if the client went away.
+*/
+static bool write_job_batch(gqss_alignment_batch* batch, void* user_data) {
+	ednafull_job* job = (ednafull_job *)user_data;
+
+	if (!write_tsv_batch_rows(job->output, job->query->identifier, job->gap_penalty, batch)) {
+		return false;
+	}
+	return (fflush(job->output) == 0);
+}
+
+/*
+	ednafull_query* find_query(ednafull_server* server, char* name)
+
+	find_query() returns the query with the index 'name' or the query whose first identifier token is 'name'. The function
+	returns a NULL pointer if no query matches.
+*/
+static ednafull_query* find_query(ednafull_server* server, char* name) {
+	char* end;
+	unsigned long long query_index = strtoull(name, &end, 10);
+	if ((end != name) && (*end == '\0')) {
+		if (query_index < server->query_count) {
+			return &(server->queries[query_index]);
+		}
+		return NULL;
+	}
+
+	size_t name_length = strlen(name);
+	for (size_t i = 0; i < server->query_count; i++) {
+		//skip the '>' character of the FASTA identifier
+		char* identifier = server->queries[i].identifier + 1;
+		if ((strncmp(identifier, name, name_length) == 0) && ((identifier[name_length] == '\0') || (identifier[name_length] == ' '))) {
+			return &(server->queries[i]);
+		}
+	}
+	return NULL;
+}
+
+/*
+	bool run_job(ednafull_connection* connection, ednafull_query* query, char* fastq_data, size_t fastq_length)
+
+	run_job() aligns the FASTQ records of 'fastq_data' and streams the TSV rows followed by the status line to the client.
+	The function returns false if the client went away.
+*/
+static bool run_job(ednafull_connection* connection, ednafull_query* query, char* fastq_data, size_t fastq_length) {
+	ednafull_job job;
+	job.output = connection->output;
+	job.query = query;
+	job.gap_penalty = connection->server->gap_penalty;
+
+	size_t bytes_consumed;
+
+	gqss_alignment_stream* stream = gqss_alignment_stream_create(query->batch_aligner, query->reverse_complement_batch_aligner, EDNAFULL_BATCH_SIZE, write_job_batch, &job);
+	if (stream == NULL) {
+		fprintf(connection->output, "#ERROR\tfailed to create alignment stream\n");
+		return (fflush(connection->output) == 0);
+	}
+
+	bool aligned = gqss_alignment_stream_feed(stream, fastq_data, fastq_length, true, &bytes_consumed);
+	bool stopped = gqss_alignment_stream_stopped(stream);
+	uint64_t record_count = gqss_alignment_stream_record_count(stream);
+
+	gqss_alignment_stream_destroy(stream);
+
+	if (stopped) {
+		//the client went away while the rows were written
+		return false;
+	}
+
+	if (!aligned) {
+		fprintf(connection->output, "#ERROR\tfailed to align FASTQ records\n");
+	}
+	else {
+		fprintf(connection->output, "#OK\t%" PRIu64 "\n", record_count);
+	}
+	return (fflush(connection->output) == 0);
+}
+
+/*
+	bool handle_request(ednafull_connection* connection)
+
+	handle_request() parses one request line and runs the request. The function returns false when the connection
+	should be closed.
+
+	Requests:
+		QUERIES                       list the loaded queries
+		ALIGN <QUERY> FILE <PATH>     align the FASTQ file PATH (a path on the server)
+		ALIGN <QUERY> READS <BYTES>   align the BYTES bytes of FASTQ data that follow the request line
+		QUIT                          close the connection
+*/
+static bool handle_request(ednafull_connection* connection) {
+	ednafull_server* server = connection->server;
+	FILE* output = connection->output;
+
+	ssize_t line_length = getline(&connection->line, &connection->line_capacity, connection->input);
+	if (line_length < 0) {
+		//client closed the connection
+		return false;
+	}
+
+	//strip the newline and carriage return characters
+	while ((line_length > 0) && ((connection->line[line_length - 1] == '\n') || (connection->line[line_length - 1] == '\r'))) {
+		line_length--;
+	}
+	connection->line[line_length] = '\0';
+
+	char* save_pointer;
+	char* command = strtok_r(connection->line, " \t", &save_pointer);
+	if (command == NULL) {
+		//ignore empty lines
+		return true;
+	}
+
+	if (strcmp(command, "QUIT") == 0) {
+		return false;
+	}
+
+	if (strcmp(command, "QUERIES") == 0) {
+		for (size_t i = 0; i < server->query_count; i++) {
+			fprintf(output, "%zu\t%s\n", i, (server->queries[i].identifier + 1));
+		}
+		fprintf(output, "#OK\t%zu\n", server->query_count);
+		return (fflush(output) == 0);
+	}
+
+	if (strcmp(command, "ALIGN") != 0) {
+		fprintf(output, "#ERROR\tunknown request '%s'\n", command);
+		return (fflush(output) == 0);
+	}
+
+	char* query_name = strtok_r(NULL, " \t", &save_pointer);
+	char* source = strtok_r(NULL, " \t", &save_pointer);
+	char* argument = strtok_r(NULL, "", &save_pointer);
+	while ((argument != NULL) && ((*argument == ' ') || (*argument == '\t'))) {
+		argument++;
+	}
+
+	if ((query_name == NULL) || (source == NULL) || (argument == NULL) || (*argument == '\0')) {
+		fprintf(output, "#ERROR\texpected 'ALIGN <QUERY> FILE <PATH>' or 'ALIGN <QUERY> READS <BYTES>'\n");
+		return (fflush(output) == 0);
+	}
+
+	if (strcmp(source, "READS") == 0) {
+		char* end;
+		errno = 0;
+		unsigned long long parsed_length = strtoull(argument, &end, 10);
+		if ((end == argument) || (*end != '\0') || (*argument == '-') || (errno == ERANGE)) {
+			fprintf(output, "#ERROR\tcould not parse the number of bytes\n");
+
+			//the inline data cannot be skipped
+			fflush(output);
+			return false;
+		}
+
+		//the length is checked before any size arithmetic, so that 'length + 1' cannot wrap around
+		if ((parsed_length >= SIZE_MAX) || (parsed_length > EDNAFULL_SERVER_MAX_READS_BYTES)) {
+			fprintf(output, "#ERROR\t%llu bytes exceed the maximum of %zu bytes\n", parsed_length, EDNAFULL_SERVER_MAX_READS_BYTES);
+
+			//the inline data cannot be skipped
+			fflush(output);
+			return false;
+		}
+		size_t length = (size_t)parsed_length;
+
+		if ((length + 1) > connection->reads_capacity) {
+			char* reads = (char *)realloc(connection->reads, (length + 1) * sizeof(char));
+			if (reads == NULL) {
+				fprintf(output, "#ERROR\tfailed to allocate %zu bytes\n", length);
+
+				//the inline data cannot be skipped
+				fflush(output);
+				return false;
+			}
+			connection->reads = reads;
+			connection->reads_capacity = length + 1;
+		}
+
+		if (fread(connection->reads, sizeof(char), length, connection->input) != length) {
+			//client closed the connection before sending all data
+			return false;
+		}
+		connection->reads[length] = '\0';
+
+		ednafull_query* query = find_query(server, query_name);
+		if (query == NULL) {
+			fprintf(output, "#ERROR\tunknown query '%s'\n", query_name);
+			return (fflush(output) == 0);
+		}
+		return run_job(connection, query, connection->reads, length);
+	}
+
+	if (strcmp(source, "FILE") == 0) {
+		ednafull_query* query = find_query(server, query_name);
+		if (query == NULL) {
+			fprintf(output, "#ERROR\tunknown query '%s'\n", query_name);
+			return (fflush(output) == 0);
+		}
+
+		size_t length;
+		char* data = map_file(argument, &length);
+		if (data == NULL) {
+			fprintf(output, "#ERROR\tcould not read FASTQ file '%s'\n", argument);
+			return (fflush(output) == 0);
+		}
+
+		bool connected = run_job(connection, query, data, length);
+
+		//unmap FASTQ file
+		unmap_file(data, length);
+		return connected;
+	}
+
+	fprintf(output, "#ERROR\tunknown job source '%s'\n", source);
+	return (fflush(output) == 0);
+}
+
+/*
+	void close_connection(ednafull_connection* connection)
+
+	close_connection() removes 'connection' from the server's open connections and frees it.
+*/
+static void close_connection(ednafull_connection* connection) {
+	ednafull_server* server = connection->server;
+
+	pthread_mutex_lock(&server->mutex);
+	if (connection->previous != NULL) {
+		connection->previous->next = connection->next;
+	}
+	else {
+		server->connections = connection->next;
+	}
+	if (connection->next != NULL) {
+		connection->next->previous = connection->previous;
+	}
+	if (server->connections == NULL) {
+		pthread_cond_broadcast(&server->connections_closed);
+	}
+	pthread_mutex_unlock(&server->mutex);
+
+	//the streams own the socket file descriptor and its duplicate
+	fclose(connection->input);
+	fclose(connection->output);
+
+	free(connection->line);
+	free(connection->reads);
+	free(connection);
+	return;
+}
+
+/*
+	void* run_connection(void* argument)
+
+	run_connection() is the start routine of each client thread, it handles requests until the client closes the
+	connection or the server shuts down.
+*/
+static void* run_connection(void* argument) {
+	ednafull_connection* connection = (ednafull_connection *)argument;
+
+	while (handle_request(connection)) {
+		//keep serving the client
+	}
+
+	close_connection(connection);
+	return NULL;
+}
+
+/*
+	bool open_connection(ednafull_server* server, int socket_fd)
+
+	open_connection() starts a detached thread serving the client connected to 'socket_fd'. The function returns false
+	(and closes 'socket_fd') on failure.
+*/
+static bool open_connection(ednafull_server* server, int socket_fd) {
+	ednafull_connection* connection = (ednafull_connection *)calloc(1, sizeof(ednafull_connection));
+	if (connection == NULL) {
+		perror("open_connection(): calloc(): error");
+
+		close(socket_fd);
+		return false;
+	}
+	connection->server = server;
+	connection->socket_fd = socket_fd;
+
+	int output_fd = dup(socket_fd);
+	if (output_fd < 0) {
+		perror("open_connection(): dup(): error");
+
+		close(socket_fd);
+		free(connection);
+		return false;
+	}
+
+	connection->input = fdopen(socket_fd, "rb");
+	connection->output = fdopen(output_fd, "wb");
+	if ((connection->input == NULL) || (connection->output == NULL)) {
+		perror("open_connection(): fdopen(): error");
+
+		if (connection->input != NULL) {
+			fclose(connection->input);
+		}
+		else {
+			close(socket_fd);
+		}
+		if (connection->output != NULL) {
+			fclose(connection->output);
+		}
+		else {
+			close(output_fd);
+		}
+		free(connection);
+		return false;
+	}
+
+	pthread_mutex_lock(&server->mutex);
+	connection->next = server->connections;
+	if (server->connections != NULL) {
+		server->connections->previous = connection;
+	}
+	server->connections = connection;
+	pthread_mutex_unlock(&server->mutex);
+
+	pthread_attr_t attributes;
+	pthread_t thread;
+	pthread_attr_init(&attributes);
+	pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+	int create_status = pthread_create(&thread, &attributes, run_connection, connection);
+	pthread_attr_destroy(&attributes);
+
+	if (create_status != 0) {
+		printf("error: open_connection(): pthread_create() failed!\n");
+
+		close_connection(connection);
+		return false;
+	}
+	return true;
+}
+
+/*
+	int open_server_socket(char* socket_filename)
+
+	open_server_socket() returns a Unix domain socket listening on 'socket_filename' or -1 on failure.
+*/
+static int open_server_socket(char* socket_filename) {
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(struct sockaddr_un));
+	address.sun_family = AF_UNIX;
+
+	if (strlen(socket_filename) >= sizeof(address.sun_path)) {
+		printf("error: socket file name \"%s\" is too long!\n", socket_filename);
+		return -1;
+	}
+	memcpy(address.sun_path, socket_filename, strlen(socket_filename));
+
+	int socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (socket_fd < 0) {
+		perror("open_server_socket(): socket(): error");
+		return -1;
+	}
+
+	if (bind(socket_fd, (struct sockaddr *)&address, sizeof(struct sockaddr_un)) != 0) {
+		perror("open_server_socket(): bind(): error");
+
+		close(socket_fd);
+		return -1;
+	}
+
+	if (listen(socket_fd, SOMAXCONN) != 0) {
+		perror("open_server_socket(): listen(): error");
+
+		close(socket_fd);
+		unlink(socket_filename);
+		return -1;
+	}
+
+	return socket_fd;
+}
+
+/*
+	int run_ednafull_server(char* socket_filename, ednafull_query* queries, size_t query_count, int64_t gap_penalty)
+
+	run_ednafull_server() accepts clients on the Unix domain socket 'socket_filename' and aligns their jobs against the
+	loaded queries until the process receives SIGINT or SIGTERM. Each client is served by its own thread, the alignments
+	of all clients share the thread pool of the queries' batch aligners.
+
+	run_ednafull_server() returns 0 after a clean shutdown and 1 if the server could not be started.
+*/
+int run_ednafull_server(char* socket_filename, ednafull_query* queries, size_t query_count, int64_t gap_penalty) {
+	ednafull_server server;
+	server.queries = queries;
+	server.query_count = query_count;
+	server.gap_penalty = gap_penalty;
+	server.connections = NULL;
+
+	if (pthread_mutex_init(&server.mutex, NULL) != 0) {
+		return 1;
+	}
+	if (pthread_cond_init(&server.connections_closed, NULL) != 0) {
+		pthread_mutex_destroy(&server.mutex);
+		return 1;
+	}
+
+	struct sigaction action;
+	memset(&action, 0, sizeof(struct sigaction));
+	sigemptyset(&action.sa_mask);
+	action.sa_flags = SA_RESTART;
+
+	//a client closing its connection must not terminate the server
+	action.sa_handler = SIG_IGN;
+	sigaction(SIGPIPE, &action, NULL);
+
+	action.sa_handler = handle_shutdown_signal;
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+
+	server.socket_fd = open_server_socket(socket_filename);
+	if (server.socket_fd < 0) {
+		pthread_cond_destroy(&server.connections_closed);
+		pthread_mutex_destroy(&server.mutex);
+		return 1;
+	}
+
+	printf("Listening on \"%s\"\n", socket_filename);
+	fflush(stdout);
+
+	struct pollfd listener;
+	listener.fd = server.socket_fd;
+	listener.events = POLLIN;
+
+	//the signal handler may run on any thread, poll with a timeout to notice it
+	while (!ednafull_server_shutdown) {
+		int poll_status = poll(&listener, 1, EDNAFULL_SERVER_POLL_TIMEOUT);
+		if (poll_status <= 0) {
+			if ((poll_status < 0) && (errno != EINTR)) {
+				perror("run_ednafull_server(): poll(): error");
+				break;
+			}
+			continue;
+		}
+
+		int client_fd = accept(server.socket_fd, NULL, NULL);
+		if (client_fd < 0) {
+			if ((errno != EINTR) && (errno != ECONNABORTED)) {
+				perror("run_ednafull_server(): accept(): error");
+				break;
+			}
+			continue;
+		}
+
+		open_connection(&server, client_fd);
+	}
+
+	printf("Shutting down server\n");
+
+	close(server.socket_fd);
+	unlink(socket_filename);
+
+	//end the requests of the open connections and wait for their threads to finish
+	pthread_mutex_lock(&server.mutex);
+	for (ednafull_connection* connection = server.connections; connection != NULL; connection = connection->next) {
+		shutdown(connection->socket_fd, SHUT_RDWR);
+	}
+	while (server.connections != NULL) {
+		pthread_cond_wait(&server.connections_closed, &server.mutex);
+	}
+	pthread_mutex_unlock(&server.mutex);
+
+	pthread_cond_destroy(&server.connections_closed);
+	pthread_mutex_destroy(&server.mutex);
+	return 0;
+}
@@ -0,0 +1,343 @@
+/* Run statistics (--stats) of the Smith-Waterman algorithm with a linear gap
+ * penalty using the EDNAFULL substitution matrix.
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "ednafull_linear_smith_waterman.h"
+
+#include <sys/stat.h>
+#include <sys/resource.h>
+
+/*
+	bool init_ednafull_stats(ednafull_stats* stats, size_t file_count)
+
+	init_ednafull_stats() clears the counters of 'stats' for a run of 'file_count' FASTQ files and starts the wall clock of
+	the run. The function returns false if memory could not be allocated or the mutex could not be initialized.
+*/
+bool init_ednafull_stats(ednafull_stats* stats, size_t file_count) {
+	memset(&stats->stream, 0, sizeof(gqss_alignment_stream_stats));
+	stats->record_count = 0;
+	stats->aligned_count = 0;
+	for (size_t i = 0; i < EDNAFULL_STAGE_COUNT; i++) {
+		stats->stage_nanoseconds[i] = 0;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &stats->start_time);
+
+	//a --serve run has no FASTQ files
+	stats->file_count = file_count;
+	stats->stopped_files = (bool *)calloc((file_count + 1), sizeof(bool));
+	if (stats->stopped_files == NULL) {
+		perror("init_ednafull_stats(): calloc(): error");
+		return false;
+	}
+
+	if (pthread_mutex_init(&stats->mutex, NULL) != 0) {
+		perror("init_ednafull_stats(): pthread_mutex_init(): error");
+
+		free(stats->stopped_files);
+		return false;
+	}
+	return true;
+}
+
+void free_ednafull_stats(ednafull_stats* stats) {
+	pthread_mutex_destroy(&stats->mutex);
+	free(stats->stopped_files);
+	return;
+}
+
+//record whether the FASTQ file 'file' of the run was stopped before its end (e.g. by --max-hits)
+void set_ednafull_file_stopped(ednafull_stats* stats, size_t file, bool stopped) {
+	pthread_mutex_lock(&stats->mutex);
+	stats->stopped_files[file] = stopped;
+	pthread_mutex_unlock(&stats->mutex);
+	return;
+}
+
+//CLOCK_MONOTONIC time in nanoseconds, the start of a stage timed by add_ednafull_stage_time()
+uint64_t get_ednafull_stats_clock(void) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t)now.tv_sec * 1000000000) + (uint64_t)now.tv_nsec;
+}
+
+/*
+	uint64_t add_ednafull_stage_time(ednafull_stats* stats, ednafull_stage stage, uint64_t start_nanoseconds)
+
+	add_ednafull_stage_time() adds the time since 'start_nanoseconds' (a time of get_ednafull_stats_clock()) to 'stage' of
+	'stats'. The function returns the current time, so that consecutive stages are timed with a single clock reading each.
+*/
+uint64_t add_ednafull_stage_time(ednafull_stats* stats, ednafull_stage stage, uint64_t start_nanoseconds) {
+	uint64_t now = get_ednafull_stats_clock();
+
+	pthread_mutex_lock(&stats->mutex);
+	stats->stage_nanoseconds[stage] = stats->stage_nanoseconds[stage] + (now - start_nanoseconds);
+	pthread_mutex_unlock(&stats->mutex);
+	return now;
+}
+
+//add the counters of an alignment stream that read 'record_count' records and aligned 'aligned_count' of them
+void add_ednafull_stream_stats(ednafull_stats* stats, gqss_alignment_stream_stats* stream_stats, uint64_t record_count, uint64_t aligned_count) {
+	pthread_mutex_lock(&stats->mutex);
+	stats->stream.batch_count = stats->stream.batch_count + stream_stats->batch_count;
+	stats->stream.parse_nanoseconds = stats->stream.parse_nanoseconds + stream_stats->parse_nanoseconds;
+	stats->stream.align_nanoseconds = stats->stream.align_nanoseconds + stream_stats->align_nanoseconds;
+	stats->stream.callback_nanoseconds = stats->stream.callback_nanoseconds + stream_stats->callback_nanoseconds;
+	stats->record_count = stats->record_count + record_count;
+	stats->aligned_count = stats->aligned_count + aligned_count;
+	pthread_mutex_unlock(&stats->mutex);
+	return;
+}
+
+//start counting the work of the aligners of every query
+void enable_ednafull_query_stats(ednafull_query* queries, size_t query_count) {
+	for (size_t i = 0; i < query_count; i++) {
+		gqss_batch_aligner_set_stats(queries[i].batch_aligner, true);
+		gqss_batch_aligner_set_stats(queries[i].reverse_complement_batch_aligner, true);
+	}
+	return;
+}
+
+//add the counters of worker 'worker_index' of both batch aligners of every query to 'aligner_stats'
+static void add_worker_stats(ednafull_query* queries, size_t query_count, size_t worker_index, gqss_aligner_stats* aligner_stats) {
+	for (size_t i = 0; i < query_count; i++) {
+		if (worker_index < gqss_batch_aligner_worker_count(queries[i].batch_aligner)) {
+			gqss_batch_aligner_add_stats(queries[i].batch_aligner, worker_index, aligner_stats);
+		}
+		if (worker_index < gqss_batch_aligner_worker_count(queries[i].reverse_complement_batch_aligner)) {
+			gqss_batch_aligner_add_stats(queries[i].reverse_complement_batch_aligner, worker_index, aligner_stats);
+		}
+	}
+	return;
+}
+
+static double get_seconds(uint64_t nanoseconds) {
+	return (double)nanoseconds * 0.000000001;
+}
+
+//seconds since the start of the run
+static double get_wall_seconds(ednafull_stats* stats) {
+	struct timespec end_time;
+
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+	return (double)(end_time.tv_sec - stats->start_time.tv_sec) + ((double)(end_time.tv_nsec - stats->start_time.tv_nsec) * 0.000000001);
+}
+
+//number of worker threads of the batch aligners of 'queries'
+static size_t get_worker_count(ednafull_query* queries, size_t query_count) {
+	size_t worker_count = 0;
+	for (size_t i = 0; i < query_count; i++) {
+		size_t query_worker_count = gqss_batch_aligner_worker_count(queries[i].batch_aligner);
+		if (query_worker_count > worker_count) {
+			worker_count = query_worker_count;
+		}
+	}
+	return worker_count;
+}
+
+//sum of the counters of every worker aligner of 'queries'
+static void get_total_stats(ednafull_query* queries, size_t query_count, gqss_aligner_stats* total) {
+	memset(total, 0, sizeof(gqss_aligner_stats));
+
+	size_t worker_count = get_worker_count(queries, query_count);
+	for (size_t i = 0; i < worker_count; i++) {
+		add_worker_stats(queries, query_count, i, total);
+	}
+	return;
+}
+
+//time a worker spent aligning
+static double get_busy_seconds(gqss_aligner_stats* worker) {
+	return get_seconds(worker->encode_nanoseconds + worker->fill_nanoseconds + worker->traceback_nanoseconds);
+}
+
+/*
+	void print_ednafull_stats(ednafull_stats* stats, ednafull_query* queries, size_t query_count)
+
+	print_ednafull_stats() prints the --stats report of a run: the time spent in every stage, the records and cells
+	aligned, the throughput over the wall time of the run and, for every worker thread, its alignments and the share of
+	the wall time it spent aligning. The stage times of the aligners are summed over the worker threads, the other stages
+	are timed on the threads feeding the alignment streams. The batch aligners of 'queries' must be idle.
+*/
+void print_ednafull_stats(ednafull_stats* stats, ednafull_query* queries, size_t query_count) {
+	gqss_aligner_stats total;
+
+	double wall_seconds = get_wall_seconds(stats);
+	get_total_stats(queries, query_count, &total);
+
+	printf("Run statistics:\n");
+	printf("  stage                      seconds\n");
+	printf("  parse                   %10.3lf\n", get_seconds(stats->stream.parse_nanoseconds));
+	printf("  encode                  %10.3lf\n", get_seconds(total.encode_nanoseconds));
+	printf("  fill                    %10.3lf\n", get_seconds(total.fill_nanoseconds));
+	printf("  traceback               %10.3lf\n", get_seconds(total.traceback_nanoseconds));
+	printf("  mismatch counting       %10.3lf\n", get_seconds(stats->stage_nanoseconds[EDNAFULL_STAGE_MISMATCH]));
+	printf("  formatting              %10.3lf\n", get_seconds(stats->stage_nanoseconds[EDNAFULL_STAGE_FORMAT]));
+	printf("  write                   %10.3lf\n", get_seconds(stats->stage_nanoseconds[EDNAFULL_STAGE_WRITE]));
+	printf("  batch alignment (wall)  %10.3lf\n", get_seconds(stats->stream.align_nanoseconds));
+	printf("  output callbacks (wall) %10.3lf\n", get_seconds(stats->stream.callback_nanoseconds));
+	printf("  run (wall)              %10.3lf\n", wall_seconds);
+
+	printf("  records read            %10" PRIu64 "\n", stats->record_count);
+	printf("  records aligned         %10" PRIu64 "\n", stats->aligned_count);
+	printf("  records skipped         %10" PRIu64 "\n", (stats->record_count - stats->aligned_count));
+	printf("  batches                 %10" PRIu64 "\n", stats->stream.batch_count);
+	printf("  alignments              %10" PRIu64 "\n", total.alignment_count);
+	printf("  cells computed          %10" PRIu64 "\n", total.cell_count);
+	printf("  tracebacks computed     %10" PRIu64 "\n", total.traceback_count);
+	printf("  tracebacks skipped      %10" PRIu64 "\n", total.skipped_traceback_count);
+
+	double reads_per_second = (wall_seconds > 0) ? ((double)stats->aligned_count / wall_seconds) : 0;
+	double gcups = (wall_seconds > 0) ? (((double)total.cell_count / wall_seconds) * 0.000000001) : 0;
+	printf("  reads/s                 %10.0lf\n", reads_per_second);
+	printf("  GCUPS                   %10.3lf\n", gcups);
+
+	printf("  thread  alignments  busy seconds  utilisation\n");
+	size_t worker_count = get_worker_count(queries, query_count);
+	for (size_t i = 0; i < worker_count; i++) {
+		gqss_aligner_stats worker;
+		memset(&worker, 0, sizeof(gqss_aligner_stats));
+		add_worker_stats(queries, query_count, i, &worker);
+
+		double busy_seconds = get_busy_seconds(&worker);
+		double utilisation = (wall_seconds > 0) ? ((busy_seconds * 100) / wall_seconds) : 0;
+		printf("  %6zu  %10" PRIu64 "  %12.3lf  %10.1lf%%\n", i, worker.alignment_count, busy_seconds, utilisation);
+	}
+	return;
+}
+
+//peak resident set size of the process in kilobytes
+static long get_peak_rss(void) {
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+	return usage.ru_maxrss;
+}
+
+//write the size of the file 'filename' in bytes, or null if it is not a regular file (a pipe or the standard input)
+static void write_json_file_size(FILE* file_fd, char* filename) {
+	struct stat file_stat;
+
+	if ((stat(filename, &file_stat) == 0) && S_ISREG(file_stat.st_mode)) {
+		fprintf(file_fd, "%" PRIu64, (uint64_t)file_stat.st_size);
+	}
+	else {
+		fprintf(file_fd, "null");
+	}
+	return;
+}
+
+/*
+	bool write_ednafull_report(FILE* file_fd, ednafull_stats* stats, ednafull_options* options, ednafull_query* queries, size_t query_count, int status)
+
+	write_ednafull_report() writes the --report of a run as a JSON object: its exit status, the queries and the FASTQ files
+	with their sizes and whether they were stopped before their end, the record, alignment, cell and allocation counts, the
+	seconds of every stage (see print_ednafull_stats()), the throughput, the utilisation of every worker thread, the peak
+	resident set size, and the kernel that aligned the reads. The kernel is the scalar query profile kernel: its query
+	profile is read from a query index file or computed on first use, and with --top-k only the best records are traced
+	back. There is no prefilter, its rejection rate is null. The function returns false if writing to 'file_fd' failed.
+*/
+bool write_ednafull_report(FILE* file_fd, ednafull_stats* stats, ednafull_options* options, ednafull_query* queries, size_t query_count, int status) {
+	gqss_aligner_stats total;
+
+	double wall_seconds = get_wall_seconds(stats);
+	get_total_stats(queries, query_count, &total);
+
+	fprintf(file_fd, "{\n  \"status\": %d,\n  \"queries\": [", status);
+	for (size_t i = 0; i < query_count; i++) {
+		fprintf(file_fd, "%s{\"identifier\": ", ((i > 0) ? ", " : ""));
+		write_json_string(file_fd, (queries[i].identifier + 1));
+		fprintf(file_fd, ", \"length\": %zu}", strlen(queries[i].sequence));
+	}
+
+	fprintf(file_fd, "],\n  \"inputs\": [");
+	for (size_t i = 0; i < options->fastq_count; i++) {
+		fprintf(file_fd, "%s{\"filename\": ", ((i > 0) ? ", " : ""));
+		write_json_string(file_fd, options->fastq_filenames[i]);
+		fprintf(file_fd, ", \"bytes\": ");
+		write_json_file_size(file_fd, options->fastq_filenames[i]);
+		fprintf(file_fd, ", \"stopped\": %s}", (stats->stopped_files[i] ? "true" : "false"));
+	}
+	if (options->mate_filename != NULL) {
+		//the mates are read together with the first FASTQ file
+		fprintf(file_fd, ", {\"filename\": ");
+		write_json_string(file_fd, options->mate_filename);
+		fprintf(file_fd, ", \"bytes\": ");
+		write_json_file_size(file_fd, options->mate_filename);
+		fprintf(file_fd, ", \"stopped\": %s}", (stats->stopped_files[0] ? "true" : "false"));
+	}
+
+	bool indexed = (query_count > 0) && (queries[0].index != NULL);
+	fprintf(file_fd, "],\n  \"kernel\": {\"name\": \"scalar_query_profile\", \"query_profile\": \"%s\", \"traceback\": \"%s\"},\n",
+			(indexed ? "index" : "computed"), ((options->top_k > 0) ? "best" : "all"));
+	fprintf(file_fd, "  \"prefilter\": null,\n  \"threads\": %zu,\n", options->thread_count);
+
+	fprintf(file_fd, "  \"records\": {\"read\": %" PRIu64 ", \"aligned\": %" PRIu64 ", \"skipped\": %" PRIu64 "},\n",
+			stats->record_count, stats->aligned_count, (stats->record_count - stats->aligned_count));
+	fprintf(file_fd, "  \"batches\": %" PRIu64 ",\n  \"alignments\": %" PRIu64 ",\n  \"cells\": %" PRIu64 ",\n"
+			"  \"tracebacks\": %" PRIu64 ",\n  \"skipped_tracebacks\": %" PRIu64 ",\n  \"allocations\": %" PRIu64 ",\n",
+			stats->stream.batch_count, total.alignment_count, total.cell_count, total.traceback_count,
+			total.skipped_traceback_count, total.allocation_count);
+
+	fprintf(file_fd, "  \"seconds\": {\"wall\": %.6lf, \"parse\": %.6lf, \"encode\": %.6lf, \"fill\": %.6lf, \"traceback\": %.6lf, "
+			"\"mismatch_counting\": %.6lf, \"formatting\": %.6lf, \"write\": %.6lf, \"batch_alignment\": %.6lf, \"callbacks\": %.6lf},\n",
+			wall_seconds, get_seconds(stats->stream.parse_nanoseconds), get_seconds(total.encode_nanoseconds),
+			get_seconds(total.fill_nanoseconds), get_seconds(total.traceback_nanoseconds),
+			get_seconds(stats->stage_nanoseconds[EDNAFULL_STAGE_MISMATCH]), get_seconds(stats->stage_nanoseconds[EDNAFULL_STAGE_FORMAT]),
+			get_seconds(stats->stage_nanoseconds[EDNAFULL_STAGE_WRITE]), get_seconds(stats->stream.align_nanoseconds),
+			get_seconds(stats->stream.callback_nanoseconds));
+
+	double reads_per_second = (wall_seconds > 0) ? ((double)stats->aligned_count / wall_seconds) : 0;
+	double gcups = (wall_seconds > 0) ? (((double)total.cell_count / wall_seconds) * 0.000000001) : 0;
+	fprintf(file_fd, "  \"reads_per_second\": %.1lf,\n  \"gcups\": %.6lf,\n  \"thread_utilisation\": [", reads_per_second, gcups);
+
+	size_t worker_count = get_worker_count(queries, query_count);
+	for (size_t i = 0; i < worker_count; i++) {
+		gqss_aligner_stats worker;
+		memset(&worker, 0, sizeof(gqss_aligner_stats));
+		add_worker_stats(queries, query_count, i, &worker);
+
+		double busy_seconds = get_busy_seconds(&worker);
+		fprintf(file_fd, "%s{\"thread\": %zu, \"alignments\": %" PRIu64 ", \"busy_seconds\": %.6lf, \"utilisation\": %.4lf}",
+				((i > 0) ? ", " : ""), i, worker.alignment_count, busy_seconds, ((wall_seconds > 0) ? (busy_seconds / wall_seconds) : 0));
+	}
+	fprintf(file_fd, "],\n  \"peak_rss_kilobytes\": %ld\n}\n", get_peak_rss());
+
+	return (!ferror(file_fd));
+}
+
+/*
+	bool save_ednafull_report(ednafull_stats* stats, ednafull_options* options, ednafull_query* queries, size_t query_count, int status)
+
+	save_ednafull_report() writes the --report of a run that ended with exit status 'status' to 'options->report_filename'.
+	The function prints an error message and returns false if the file could not be written.
+*/
+bool save_ednafull_report(ednafull_stats* stats, ednafull_options* options, ednafull_query* queries, size_t query_count, int status) {
+	FILE* report_fd = fopen(options->report_filename, "wb");
+	bool written = (report_fd != NULL) && write_ednafull_report(report_fd, stats, options, queries, query_count, status);
+	if ((report_fd != NULL) && (fclose(report_fd) != 0)) {
+		written = false;
+	}
+
+	if (!written) {
+		perror("error: failed to write the report file");
+	}
+	return written;
+}
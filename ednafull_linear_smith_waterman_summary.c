@@ -0,0 +1,340 @@
+/* Alignment summaries of the Smith-Waterman algorithm with a linear gap penalty
+ * using the EDNAFULL substitution matrix.
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "ednafull_linear_smith_waterman.h"
+
+#include <ctype.h>
+
+//highest score of a single matching base of the EDNAFULL substitution matrix
+#define EDNAFULL_MAX_MATCH_SCORE 5
+
+/*
+	bool init_ednafull_summary(ednafull_summary* summary, ednafull_query* query, int64_t min_score)
+
+	init_ednafull_summary() allocates the score histogram, up to the score of a read matching the whole query, and the
+	pileup arrays of 'summary'. The function returns false if memory could not be allocated.
+*/
+bool init_ednafull_summary(ednafull_summary* summary, ednafull_query* query, int64_t min_score) {
+	summary->query_length = strlen(query->sequence);
+	summary->min_score = min_score;
+	summary->record_count = 0;
+	summary->hit_count = 0;
+	summary->reverse_complement_hit_count = 0;
+	summary->stats = NULL;
+	summary->callback = NULL;
+	summary->user_data = NULL;
+
+	summary->histogram_size = ((EDNAFULL_MAX_MATCH_SCORE * summary->query_length) / EDNAFULL_SUMMARY_SCORE_BIN_WIDTH) + 1;
+	summary->score_histogram = (uint64_t *)calloc(summary->histogram_size, sizeof(uint64_t));
+	summary->coverage_changes = (int64_t *)calloc((summary->query_length + 1), sizeof(int64_t));
+	summary->mismatch_counts = (uint64_t *)calloc((summary->query_length + 1), sizeof(uint64_t));
+	summary->deletion_counts = (uint64_t *)calloc((summary->query_length + 1), sizeof(uint64_t));
+	summary->insertion_counts = (uint64_t *)calloc((summary->query_length + 1), sizeof(uint64_t));
+	if ((summary->score_histogram == NULL) || (summary->coverage_changes == NULL) || (summary->mismatch_counts == NULL)
+			|| (summary->deletion_counts == NULL) || (summary->insertion_counts == NULL)) {
+		perror("init_ednafull_summary(): calloc(): error");
+
+		free_ednafull_summary(summary);
+		return false;
+	}
+	return true;
+}
+
+void free_ednafull_summary(ednafull_summary* summary) {
+	free(summary->score_histogram);
+	free(summary->coverage_changes);
+	free(summary->mismatch_counts);
+	free(summary->deletion_counts);
+	free(summary->insertion_counts);
+	summary->score_histogram = NULL;
+	summary->coverage_changes = NULL;
+	summary->mismatch_counts = NULL;
+	summary->deletion_counts = NULL;
+	summary->insertion_counts = NULL;
+	return;
+}
+
+/*
+	void add_alignment_pileup(ednafull_summary* summary, gqss_batch_result* results, size_t i, bool reverse_complement)
+
+	add_alignment_pileup() counts the mismatches, deletions and insertions of alignment 'i' of 'results' at the query positions
+	they are found at. The alignment strings run from the query start to the query stop of the aligned sequence, which is the
+	reverse complement of the query if 'reverse_complement' is true.
+*/
+static void add_alignment_pileup(ednafull_summary* summary, gqss_batch_result* results, size_t i, bool reverse_complement) {
+	char* query_alignment = results->query_alignments + results->alignment_offsets[i];
+	char* read_alignment = results->read_alignments + results->alignment_offsets[i];
+	size_t alignment_length = results->alignment_offsets[i + 1] - results->alignment_offsets[i] - 1;
+
+	//position of the next base of the aligned sequence
+	size_t position = results->query_starts[i];
+	for (size_t j = 0; (j < alignment_length) && (position < summary->query_length); j++) {
+		//position p of the reverse complement is position (query_length - 1 - p) of the query
+		size_t query_position = reverse_complement ? (summary->query_length - 1 - position) : position;
+
+		if (query_alignment[j] == '-') {
+			//in query order, the next base of the reverse complement comes before the insertion
+			size_t insertion_position = reverse_complement ? (query_position + 1) : query_position;
+			if (insertion_position < summary->query_length) {
+				summary->insertion_counts[insertion_position]++;
+			}
+			continue;
+		}
+
+		if (read_alignment[j] == '-') {
+			summary->deletion_counts[query_position]++;
+		}
+		else if (toupper((unsigned char)query_alignment[j]) != toupper((unsigned char)read_alignment[j])) {
+			summary->mismatch_counts[query_position]++;
+		}
+		position++;
+	}
+	return;
+}
+
+/*
+	void add_summary_batch(ednafull_summary* summary, gqss_alignment_batch* batch)
+
+	add_summary_batch() counts the best score of every record of 'batch' and adds the best alignment of every hit to the
+	pileup. A hit against the reverse complement covers the positions of the query it is the reverse complement of.
+*/
+void add_summary_batch(ednafull_summary* summary, gqss_alignment_batch* batch) {
+	gqss_batch_result* forward = batch->forward;
+	gqss_batch_result* reverse_complement = batch->reverse_complement;
+
+	for (size_t i = 0; i < batch->count; i++) {
+		bool reverse_complement_hit = (reverse_complement != NULL) && (reverse_complement->scores[i] > forward->scores[i]);
+		int64_t score = reverse_complement_hit ? reverse_complement->scores[i] : forward->scores[i];
+
+		//an empty read (score -1) is counted in the first range, a score above the query length in the last one
+		size_t bin = (score > 0) ? (size_t)(score / EDNAFULL_SUMMARY_SCORE_BIN_WIDTH) : 0;
+		if (bin >= summary->histogram_size) {
+			bin = summary->histogram_size - 1;
+		}
+		summary->score_histogram[bin]++;
+
+		if ((score < summary->min_score) || (score < 0)) {
+			continue;
+		}
+		summary->hit_count++;
+		if (reverse_complement_hit) {
+			summary->reverse_complement_hit_count++;
+		}
+
+		if (score == 0) {
+			//nothing was aligned
+			continue;
+		}
+
+		size_t start;
+		size_t stop;
+		if (reverse_complement_hit) {
+			//position p of the reverse complement is position (query_length - 1 - p) of the query
+			start = summary->query_length - 1 - reverse_complement->query_stops[i];
+			stop = summary->query_length - 1 - reverse_complement->query_starts[i];
+		}
+		else {
+			start = forward->query_starts[i];
+			stop = forward->query_stops[i];
+		}
+
+		//the depth changes at both ends of the hit only, the other counters per aligned position
+		summary->coverage_changes[start]++;
+		summary->coverage_changes[stop + 1]--;
+
+		add_alignment_pileup(summary, (reverse_complement_hit ? reverse_complement : forward), i, reverse_complement_hit);
+	}
+	summary->record_count = summary->record_count + batch->count;
+	return;
+}
+
+/*
+	void write_json_string(FILE* file_fd, char* s)
+
+	write_json_string() writes the C string 's' as a quoted JSON string, escaping quotes, backslashes and control characters.
+*/
+void write_json_string(FILE* file_fd, char* s) {
+	fputc('"', file_fd);
+	for (; *s != '\0'; s++) {
+		unsigned char c = (unsigned char)*s;
+		if ((c == '"') || (c == '\\')) {
+			fputc('\\', file_fd);
+			fputc(c, file_fd);
+		}
+		else if (c < 0x20) {
+			fprintf(file_fd, "\\u%04x", c);
+		}
+		else {
+			fputc(c, file_fd);
+		}
+	}
+	fputc('"', file_fd);
+	return;
+}
+
+/*
+	bool write_summary_json(FILE* file_fd, ednafull_summary* summary, char* query_sequence_identifier, char* fastq_filename, bool stopped)
+
+	write_summary_json() writes 'summary' as a JSON object, with the coverage of every query position computed from the
+	difference array and whether the run was 'stopped' before the end of the FASTQ file (e.g. by --max-hits). The function
+	returns false if writing to 'file_fd' failed.
+*/
+static bool write_summary_json(FILE* file_fd, ednafull_summary* summary, char* query_sequence_identifier, char* fastq_filename, bool stopped) {
+	fprintf(file_fd, "{\n  \"query\": ");
+	write_json_string(file_fd, query_sequence_identifier);
+	fprintf(file_fd, ",\n  \"query_length\": %zu,\n  \"fastq\": ", summary->query_length);
+	write_json_string(file_fd, fastq_filename);
+	fprintf(file_fd, ",\n  \"min_score\": %" PRId64 ",\n  \"sequences\": %" PRIu64 ",\n  \"stopped\": %s,\n  \"hits\": %" PRIu64 ",\n"
+			"  \"forward_hits\": %" PRIu64 ",\n  \"reverse_complement_hits\": %" PRIu64 ",\n  \"score_bin_width\": %d,\n",
+			summary->min_score, summary->record_count, (stopped ? "true" : "false"), summary->hit_count,
+			(summary->hit_count - summary->reverse_complement_hit_count), summary->reverse_complement_hit_count,
+			EDNAFULL_SUMMARY_SCORE_BIN_WIDTH);
+
+	fprintf(file_fd, "  \"score_histogram\": [");
+	for (size_t i = 0; i < summary->histogram_size; i++) {
+		fprintf(file_fd, "%s%" PRIu64, ((i > 0) ? ", " : ""), summary->score_histogram[i]);
+	}
+
+	fprintf(file_fd, "],\n  \"coverage\": [");
+	int64_t depth = 0;
+	for (size_t i = 0; i < summary->query_length; i++) {
+		depth = depth + summary->coverage_changes[i];
+		fprintf(file_fd, "%s%" PRId64, ((i > 0) ? ", " : ""), depth);
+	}
+	fprintf(file_fd, "],\n  \"mismatches\": [");
+	for (size_t i = 0; i < summary->query_length; i++) {
+		fprintf(file_fd, "%s%" PRIu64, ((i > 0) ? ", " : ""), summary->mismatch_counts[i]);
+	}
+
+	fprintf(file_fd, "],\n  \"deletions\": [");
+	for (size_t i = 0; i < summary->query_length; i++) {
+		fprintf(file_fd, "%s%" PRIu64, ((i > 0) ? ", " : ""), summary->deletion_counts[i]);
+	}
+
+	fprintf(file_fd, "],\n  \"insertions\": [");
+	for (size_t i = 0; i < summary->query_length; i++) {
+		fprintf(file_fd, "%s%" PRIu64, ((i > 0) ? ", " : ""), summary->insertion_counts[i]);
+	}
+	fprintf(file_fd, "]\n}\n");
+
+	return (!ferror(file_fd));
+}
+
+/*
+	bool write_coverage_tsv(FILE* file_fd, ednafull_summary* summary, ednafull_query* query)
+
+	write_coverage_tsv() writes a row per position of 'query' (1-based) with its base, the depth of coverage by the hits of
+	'summary' and their mismatches, deletions and insertions. The function returns false if writing to 'file_fd' failed.
+*/
+bool write_coverage_tsv(FILE* file_fd, ednafull_summary* summary, ednafull_query* query) {
+	fprintf(file_fd, "%s", "Reference Position\tReference Base\tDepth\tMismatches\tDeletions\tInsertions\n");
+
+	int64_t depth = 0;
+	for (size_t i = 0; i < summary->query_length; i++) {
+		depth = depth + summary->coverage_changes[i];
+		fprintf(file_fd, "%zu\t%c\t%" PRId64 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\n", (i + 1), query->sequence[i], depth,
+				summary->mismatch_counts[i], summary->deletion_counts[i], summary->insertion_counts[i]);
+	}
+
+	return (!ferror(file_fd));
+}
+
+/*
+	bool summarize_batch(gqss_alignment_batch* batch, void* user_data)
+
+	summarize_batch() adds 'batch' to the ednafull_summary 'user_data' and passes it on. The callback runs on the thread feeding
+	the alignment stream after the batch was aligned, so the counters of a run need no locking.
+*/
+bool summarize_batch(gqss_alignment_batch* batch, void* user_data) {
+	ednafull_summary* summary = (ednafull_summary *)user_data;
+
+	if (summary->stats != NULL) {
+		uint64_t start_nanoseconds = get_ednafull_stats_clock();
+		add_summary_batch(summary, batch);
+		add_ednafull_stage_time(summary->stats, EDNAFULL_STAGE_MISMATCH, start_nanoseconds);
+	}
+	else {
+		add_summary_batch(summary, batch);
+	}
+
+	if (summary->callback != NULL) {
+		return summary->callback(batch, summary->user_data);
+	}
+	return true;
+}
+
+/*
+	uint64_t handle_fastq_summary(ednafull_options* options, ednafull_input* input, ednafull_query* query)
+
+	handle_fastq_summary() aligns the FASTQ data and writes the summary of the alignments to the '.sw.summary.json' (or -o)
+	file instead of a row per alignment. The function returns the number of sequences parsed, 'options->status' is set if
+	the summary file could not be written.
+*/
+uint64_t handle_fastq_summary(ednafull_options* options, ednafull_input* input, ednafull_query* query) {
+	struct timespec start_time;
+	struct timespec end_time;
+	ednafull_checkpoint checkpoint;
+	ednafull_summary summary;
+
+	if (!init_ednafull_summary(&summary, query, options->min_score)) {
+		//immediately exit
+		exit(1);
+	}
+	summary.stats = options->stats;
+
+	char* new_filename = get_output_filename(options, ".sw.summary.json");
+
+	printf("Writing alignment summary to \"%s\"\n", new_filename);
+
+	//the summary is written once the run is complete, there is nothing to checkpoint
+	ednafull_options summary_options = *options;
+	summary_options.checkpoint_interval = 0;
+	FILE* file_fd = open_checkpointed_output(&checkpoint, &summary_options, query, new_filename, 0);
+
+	//free filename string allocation
+	free(new_filename);
+
+	if (file_fd == NULL) {
+		options->status = summary_options.status;
+		free_ednafull_summary(&summary);
+		return 0;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+	uint64_t sequence_count = align_ednafull_input(input, options, query, &checkpoint, summarize_batch, &summary);
+
+	//the summary of a failed run would be incomplete
+	if ((options->status == 0) && (!write_summary_json(file_fd, &summary, (query->identifier + 1), options->fastq_filename, options->stopped))) {
+		perror("handle_fastq_summary(): fprintf(): error");
+		options->status = 2;
+	}
+
+	//close file descriptor
+	fclose(file_fd);
+	finish_checkpoint(&checkpoint, (options->status == 0));
+
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+	printf("[%11.2lf seconds]: %" PRIu64 " sequences parsed, %" PRIu64 " hits\n", ((double)(end_time.tv_sec - start_time.tv_sec) + ((double)(end_time.tv_nsec - start_time.tv_nsec) * 0.000000001)),
+			sequence_count, summary.hit_count);
+
+	free_ednafull_summary(&summary);
+	return sequence_count;
+}
@@ -0,0 +1,319 @@
+/* Best scoring reads of the Smith-Waterman algorithm with a linear gap penalty
+ * using the EDNAFULL substitution matrix.
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "ednafull_linear_smith_waterman.h"
+
+/*
+	bool is_better_entry(ednafull_top_k_entry* a, ednafull_top_k_entry* b)
+
+	is_better_entry() checks if 'a' ranks before 'b': it has the higher score or, on equal scores, comes first in the input.
+*/
+static bool is_better_entry(ednafull_top_k_entry* a, ednafull_top_k_entry* b) {
+	if (a->score != b->score) {
+		return (a->score > b->score);
+	}
+	if (a->file_index != b->file_index) {
+		return (a->file_index < b->file_index);
+	}
+	return (a->record.record_index < b->record.record_index);
+}
+
+/*
+	bool init_ednafull_top_k(ednafull_top_k* top_k, size_t k, size_t file_index)
+
+	init_ednafull_top_k() allocates an empty heap of the 'k' best records of the FASTQ file 'file_index' (the position of the file
+	in the input, which ranks records of equal score). The function returns false if memory could not be allocated.
+*/
+bool init_ednafull_top_k(ednafull_top_k* top_k, size_t k, size_t file_index) {
+	top_k->k = k;
+	top_k->count = 0;
+	top_k->file_index = file_index;
+	top_k->entries = (ednafull_top_k_entry *)calloc(k, sizeof(ednafull_top_k_entry));
+	if (top_k->entries == NULL) {
+		perror("init_ednafull_top_k(): calloc(): error");
+		return false;
+	}
+	return true;
+}
+
+void free_ednafull_top_k(ednafull_top_k* top_k) {
+	if (top_k->entries != NULL) {
+		for (size_t i = 0; i < top_k->k; i++) {
+			free(top_k->entries[i].data);
+		}
+	}
+	free(top_k->entries);
+	top_k->entries = NULL;
+	top_k->count = 0;
+	return;
+}
+
+/*
+	void sift_down(ednafull_top_k* top_k, size_t i)
+
+	sift_down() restores the min-heap order below entry 'i', the worst entry of the heap is its first entry.
+*/
+static void sift_down(ednafull_top_k* top_k, size_t i) {
+	ednafull_top_k_entry* entries = top_k->entries;
+
+	for (;;) {
+		size_t worst = i;
+		size_t left = (2 * i) + 1;
+		size_t right = left + 1;
+
+		if ((left < top_k->count) && is_better_entry(&entries[worst], &entries[left])) {
+			worst = left;
+		}
+		if ((right < top_k->count) && is_better_entry(&entries[worst], &entries[right])) {
+			worst = right;
+		}
+		if (worst == i) {
+			return;
+		}
+
+		ednafull_top_k_entry entry = entries[i];
+		entries[i] = entries[worst];
+		entries[worst] = entry;
+		i = worst;
+	}
+}
+
+static void sift_up(ednafull_top_k* top_k, size_t i) {
+	ednafull_top_k_entry* entries = top_k->entries;
+
+	while (i > 0) {
+		size_t parent = (i - 1) / 2;
+		if (!is_better_entry(&entries[parent], &entries[i])) {
+			return;
+		}
+
+		ednafull_top_k_entry entry = entries[i];
+		entries[i] = entries[parent];
+		entries[parent] = entry;
+		i = parent;
+	}
+	return;
+}
+
+/*
+	void copy_record(ednafull_top_k_entry* entry, gqss_fastq_record* record)
+
+	copy_record() copies the bytes of 'record' into the buffer of 'entry' (grown if needed), since the record only points into
+	the input buffer of the current batch. The application exits if memory could not be allocated.
+*/
+static void copy_record(ednafull_top_k_entry* entry, gqss_fastq_record* record) {
+	if (entry->data_capacity < record->length) {
+		char* data = (char *)realloc(entry->data, record->length * sizeof(char));
+		if (data == NULL) {
+			perror("copy_record(): realloc(): error");
+
+			//immediately exit
+			exit(1);
+		}
+		entry->data = data;
+		entry->data_capacity = record->length;
+	}
+	memcpy(entry->data, record->identifier, record->length);
+
+	entry->record = *record;
+	entry->record.identifier = entry->data;
+	entry->record.sequence = entry->data + (record->sequence - record->identifier);
+	entry->record.quality = entry->data + (record->quality - record->identifier);
+	return;
+}
+
+/*
+	bool add_top_k_batch(gqss_alignment_batch* batch, void* user_data)
+
+	add_top_k_batch() adds the records of 'batch' that rank before the worst of the best records found so far to the
+	ednafull_top_k 'user_data'. Only those records are copied, the others are skipped after a comparison with the first
+	entry of the heap.
+*/
+static bool add_top_k_batch(gqss_alignment_batch* batch, void* user_data) {
+	ednafull_top_k* top_k = (ednafull_top_k *)user_data;
+	ednafull_top_k_entry candidate;
+
+	candidate.file_index = top_k->file_index;
+
+	for (size_t i = 0; i < batch->count; i++) {
+		candidate.score = batch->forward->scores[i];
+		if ((batch->reverse_complement != NULL) && (batch->reverse_complement->scores[i] > candidate.score)) {
+			candidate.score = batch->reverse_complement->scores[i];
+		}
+		candidate.record.record_index = batch->records[i].record_index;
+
+		if (top_k->count < top_k->k) {
+			copy_record(&(top_k->entries[top_k->count]), &(batch->records[i]));
+			top_k->entries[top_k->count].score = candidate.score;
+			top_k->entries[top_k->count].file_index = candidate.file_index;
+			top_k->count++;
+			sift_up(top_k, (top_k->count - 1));
+		}
+		else if (is_better_entry(&candidate, &(top_k->entries[0]))) {
+			//replace the worst entry, reusing its buffer
+			copy_record(&(top_k->entries[0]), &(batch->records[i]));
+			top_k->entries[0].score = candidate.score;
+			top_k->entries[0].file_index = candidate.file_index;
+			sift_down(top_k, 0);
+		}
+	}
+	return true;
+}
+
+/*
+	uint64_t handle_fastq_top_k(ednafull_options* options, ednafull_input* input, ednafull_query* query)
+
+	handle_fastq_top_k() aligns the FASTQ data and keeps the best records in 'options->top_k_heap', they are written by
+	write_top_k() once every FASTQ file was aligned. The function returns the number of sequences parsed.
+*/
+uint64_t handle_fastq_top_k(ednafull_options* options, ednafull_input* input, ednafull_query* query) {
+	assert(options->top_k_heap != NULL);
+
+	//no output file until the run is complete, no checkpoint
+	ednafull_checkpoint checkpoint;
+	memset(&checkpoint, 0, sizeof(ednafull_checkpoint));
+
+	return align_ednafull_input(input, options, query, &checkpoint, add_top_k_batch, options->top_k_heap);
+}
+
+static int compare_entries(const void* a, const void* b) {
+	ednafull_top_k_entry* entry_a = *(ednafull_top_k_entry * const *)a;
+	ednafull_top_k_entry* entry_b = *(ednafull_top_k_entry * const *)b;
+
+	if (is_better_entry(entry_a, entry_b)) {
+		return -1;
+	}
+	if (is_better_entry(entry_b, entry_a)) {
+		return 1;
+	}
+	return 0;
+}
+
+/*
+	int write_top_k(ednafull_options* options, ednafull_top_k* heaps, size_t heap_count, ednafull_query* query)
+
+	write_top_k() merges the 'heap_count' heaps of the FASTQ files of a run and writes the TSV rows of the best
+	'options->top_k' records, best first, to the '.sw.top.tsv' (or -o) file. The records were aligned without traceback, so
+	only the winners are aligned again to render their alignments. The function returns the exit status, 1 if the winners
+	could not be aligned and 2 if the file could not be written.
+*/
+int write_top_k(ednafull_options* options, ednafull_top_k* heaps, size_t heap_count, ednafull_query* query) {
+	ednafull_checkpoint checkpoint;
+
+	size_t entry_count = 0;
+	size_t data_length = 0;
+	for (size_t i = 0; i < heap_count; i++) {
+		entry_count = entry_count + heaps[i].count;
+		for (size_t j = 0; j < heaps[i].count; j++) {
+			data_length = data_length + heaps[i].entries[j].record.length;
+		}
+	}
+
+	ednafull_top_k_entry** entries = (ednafull_top_k_entry **)malloc((entry_count + 1) * sizeof(ednafull_top_k_entry *));
+	gqss_fastq_record* records = (gqss_fastq_record *)malloc((entry_count + 1) * sizeof(gqss_fastq_record));
+	size_t* read_offsets = (size_t *)malloc((entry_count + 1) * sizeof(size_t));
+	size_t* read_lengths = (size_t *)malloc((entry_count + 1) * sizeof(size_t));
+	char* data = (char *)malloc((data_length + 1) * sizeof(char));
+	if ((entries == NULL) || (records == NULL) || (read_offsets == NULL) || (read_lengths == NULL) || (data == NULL)) {
+		perror("write_top_k(): malloc(): error");
+
+		//immediately exit
+		exit(1);
+	}
+
+	size_t next_entry = 0;
+	for (size_t i = 0; i < heap_count; i++) {
+		for (size_t j = 0; j < heaps[i].count; j++) {
+			entries[next_entry] = &(heaps[i].entries[j]);
+			next_entry++;
+		}
+	}
+	qsort(entries, entry_count, sizeof(ednafull_top_k_entry *), compare_entries);
+
+	size_t winner_count = (entry_count < options->top_k) ? entry_count : options->top_k;
+
+	//the batch aligner expects the reads of a batch in a single buffer
+	size_t offset = 0;
+	for (size_t i = 0; i < winner_count; i++) {
+		gqss_fastq_record* record = &(entries[i]->record);
+		memcpy(data + offset, record->identifier, record->length);
+
+		records[i] = *record;
+		records[i].identifier = data + offset;
+		records[i].sequence = data + offset + (record->sequence - record->identifier);
+		records[i].quality = data + offset + (record->quality - record->identifier);
+
+		read_offsets[i] = (size_t)(records[i].sequence - data);
+		read_lengths[i] = records[i].sequence_length;
+		offset = offset + record->length;
+	}
+
+	gqss_batch_result forward;
+	gqss_batch_result reverse_complement;
+	gqss_batch_result_init(&forward);
+	gqss_batch_result_init(&reverse_complement);
+
+	//the rows are written at once after the run, there is nothing to checkpoint
+	ednafull_options top_k_options = *options;
+	top_k_options.checkpoint_interval = 0;
+	top_k_options.status = 0;
+	if ((!gqss_batch_aligner_align(query->batch_aligner, data, read_offsets, read_lengths, winner_count, &forward))
+			|| (!gqss_batch_aligner_align(query->reverse_complement_batch_aligner, data, read_offsets, read_lengths, winner_count, &reverse_complement))) {
+		printf("error: write_top_k(): failed to align FASTQ records!\n");
+		top_k_options.status = 1;
+	}
+	else {
+		gqss_alignment_batch batch;
+		batch.count = winner_count;
+		batch.records = records;
+		batch.forward = &forward;
+		batch.reverse_complement = &reverse_complement;
+
+		char* new_filename = get_output_filename(options, ".sw.top.tsv");
+
+		printf("Writing the %zu best scoring sequences to \"%s\"\n", winner_count, new_filename);
+
+		FILE* file_fd = open_checkpointed_output(&checkpoint, &top_k_options, query, new_filename, 0);
+
+		//free filename string allocation
+		free(new_filename);
+
+		if (file_fd != NULL) {
+			write_tsv_alignment_header(file_fd);
+			bool written = write_tsv_batch_rows(file_fd, query->identifier, options->gap_penalty, &batch) && (!ferror(file_fd));
+
+			//close file descriptor, the rows may still be buffered
+			if ((fclose(file_fd) != 0) || (!written)) {
+				perror("write_top_k(): fprintf(): error");
+				top_k_options.status = 2;
+			}
+			finish_checkpoint(&checkpoint, (top_k_options.status == 0));
+		}
+	}
+
+	gqss_batch_result_free(&forward);
+	gqss_batch_result_free(&reverse_complement);
+	free(data);
+	free(read_lengths);
+	free(read_offsets);
+	free(records);
+	free(entries);
+	return top_k_options.status;
+}
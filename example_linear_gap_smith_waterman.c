@@ -82,5 +82,23 @@ int main(int argc, char* argv[]) {
 
 	//free scoring matrix allocation
 	free(scores);
+
+	//an aligner context owns the scoring matrix and alignment strings and can be reused for many sequences
+	gqss_aligner* aligner = gqss_aligner_create(a, strlen(a), get_example_substitution, LINEAR_GAP_PENALTY);
+	assert(aligner != NULL);
+
+	gqss_alignment_result result;
+	if (!gqss_aligner_align(aligner, b, strlen(b), &result)) {
+		printf("error: failed to align \"%s\" against \"%s\"!\n", b, a);
+		gqss_aligner_destroy(aligner);
+		return 1;
+	}
+
+	printf("Aligner Score: %lld\n", result.score);
+	printf("Aligner Indices: (%llu, %llu) to (%llu, %llu)\n", (uint64_t)result.query_start, (uint64_t)result.read_start, (uint64_t)result.query_stop, (uint64_t)result.read_stop);
+	printf("Aligner Alignments:\n%s\n%s\n", result.query_alignment, result.read_alignment);
+
+	//free aligner context
+	gqss_aligner_destroy(aligner);
 	return 0;
 }
@@ -0,0 +1,49 @@
+/* GQSS library definitions
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef GQSS_H
+#define GQSS_H
+
+/*
+	libgqss exports the aligner (linear_gap_smith_waterman.h, gqss_batch_alignment.h, gqss_thread_pool.h), the
+	EDNAFULL substitution matrix (gqss_ednafull.h), the FASTA/FASTQ parsers (gqss_file_io.h), the alignment
+	formatters (gqss_alignment_format.h), the FASTQ alignment stream (gqss_alignment_stream.h), the query index
+	files (gqss_query_index.h) and the FASTQ record offset index files (gqss_fastq_index.h).
+
+	None of the library functions keep global or static mutable state. Functions may be called concurrently from
+	many threads as long as a given gqss_aligner or gqss_batch_result is not used by two threads at once.
+
+	The exported symbols are listed in libgqss.map. GQSS_VERSION_MAJOR is the shared library version (soname)
+	and changes only when the ABI is broken.
+*/
+#define GQSS_VERSION_MAJOR 1
+#define GQSS_VERSION_MINOR 0
+#define GQSS_VERSION_PATCH 0
+
+#include "linear_gap_smith_waterman.h"
+#include "gqss_thread_pool.h"
+#include "gqss_batch_alignment.h"
+#include "gqss_ednafull.h"
+#include "gqss_file_io.h"
+#include "gqss_alignment_format.h"
+#include "gqss_alignment_stream.h"
+#include "gqss_query_index.h"
+#include "gqss_fastq_index.h"
+
+#endif /* GQSS_H */
@@ -97,7 +97,8 @@ static void count_mismatches(char* trace_X, char* trace_Y, uint64_t* identical,
 	*gaps_Y = 0;
 	*mismatches = 0;
 
-	for (size_t i = 0; i < strlen(trace_X); i++) {
+	size_t alignment_length = strlen(trace_X);
+	for (size_t i = 0; i < alignment_length; i++) {
 		if (trace_X[i] == trace_Y[i]) {
 			if (trace_X[i] == '-') {
 				//both bases in 'trace_X' in 'trace_Y' are gaps
@@ -248,7 +249,8 @@ char* generate_int_linear_gap_penalty_pair_alignment(char* program_name, char* s
 #endif	/* defined(__MINGW32__) || defined(__MINGW64__) */
 
 	//format time as human-readable C string
-	assert(strftime(time_string, 100, "%a %b %d %H:%M:%S %Y", &tm_now) != 0);
+	size_t time_string_length = strftime(time_string, 25, "%a %b %d %H:%M:%S %Y", &tm_now);
+	assert(time_string_length != 0);
 
 	uint64_t identicals;
 	uint64_t gaps_X;
@@ -333,9 +335,10 @@ char* generate_int_linear_gap_penalty_pair_alignment(char* program_name, char* s
 	}
 
 	//format the format string
-	assert(sprintf(sequence_identifier_format_string,
+	int format_string_length = sprintf(sequence_identifier_format_string,
 		"%%-%llus %%20llu %%s %%20llu\n",							//2 + length(repr(typemax(UInt64))) + 19 = 2 + 20 + 19 = 41
-		max_sequence_identifier_length) > 21);
+		max_sequence_identifier_length);
+	assert(format_string_length > 21);
 
 	char* alignment_buffer = (char *)malloc(51 * sizeof(char));
 	if (alignment_buffer == NULL) {
@@ -536,3 +539,51 @@ char* generate_int_linear_gap_penalty_pair_alignment(char* program_name, char* s
 
 	return pair_allocation;
 }
+
+/*
+	write_tsv_alignment_header(FILE* file)
+
+	write_tsv_alignment_header() writes the column descriptions of the tab separated values (TSV) format to 'file'. The function
+	returns a negative value on failure like fprintf().
+*/
+int write_tsv_alignment_header(FILE* file) {
+	return fprintf(file, "%s", "Reference Sequence Identifier\tSequence Identifier\tSmith-Waterman Score\tLinear Gap Penalty\tSubstitution Matrix\tAlignment Length\tAlignment Identities\tAlignment Gaps\tAlignment Mismatches\tReference Sequence Alignment\tSequence Alignment\tSequence Alignment Base Quality\n");
+}
+
+/*
+	write_int_linear_gap_penalty_tsv_alignment(FILE* file, char* query_sequence_identifier_prefix, char* query_sequence_identifier, char* sequence_identifier, size_t sequence_identifier_length, char* substitution_matrix_name, int64_t score, int64_t gap_penalty, char* trace_X, char* trace_Y, size_t alignment_length, char* quality, size_t quality_length)
+
+	write_int_linear_gap_penalty_tsv_alignment() writes one alignment as a row of the tab separated values (TSV) format to 'file'. 'trace_X' is the
+	reference (query) sequence alignment and 'trace_Y' the sequence alignment. The sequence identifier and the base qualities do not need to be null
+	terminated. 'query_sequence_identifier' starts with the '>' character of the FASTA format, which is not written.
+
+	write_int_linear_gap_penalty_tsv_alignment() returns a negative value on failure like fprintf().
+*/
+int write_int_linear_gap_penalty_tsv_alignment(FILE* file, char* query_sequence_identifier_prefix, char* query_sequence_identifier, char* sequence_identifier, size_t sequence_identifier_length, char* substitution_matrix_name, int64_t score, int64_t gap_penalty, char* trace_X, char* trace_Y, size_t alignment_length, char* quality, size_t quality_length) {
+	assert((trace_X != NULL) && (trace_Y != NULL) && (query_sequence_identifier != NULL) && (sequence_identifier != NULL));
+
+	uint64_t identicals;
+	uint64_t gaps_X;
+	uint64_t gaps_Y;
+	uint64_t mismatches;
+
+	//count the number of mismatches and gaps found between 'trace_X' and 'trace_Y'
+	count_mismatches(trace_X, trace_Y, &identicals, &gaps_X, &gaps_Y, &mismatches);
+
+	return fprintf(file, "%s%s\t%.*s\t%" PRId64 "\t%" PRId64 "\t%s\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%s\t%s\t%.*s\n",
+					query_sequence_identifier_prefix,
+					(query_sequence_identifier + 1),
+					(int)sequence_identifier_length,
+					sequence_identifier,
+					score,
+					gap_penalty,
+					substitution_matrix_name,
+					(uint64_t)alignment_length,
+					identicals,
+					(gaps_X + gaps_Y),
+					mismatches,
+					trace_X,
+					trace_Y,
+					(int)quality_length,
+					quality);
+}
@@ -89,4 +89,23 @@
 */
 char* generate_int_linear_gap_penalty_pair_alignment(char* program_name, char* substitution_matrix_name, char* query_sequence_identifier, char* sequence_identifier, char* trace_X, char* trace_Y, int64_t score, int64_t gap_penalty);
 
+/*
+	write_tsv_alignment_header(FILE* file)
+
+	write_tsv_alignment_header() writes the column descriptions of the tab separated values (TSV) format to 'file'. The function
+	returns a negative value on failure like fprintf().
+*/
+int write_tsv_alignment_header(FILE* file);
+
+/*
+	write_int_linear_gap_penalty_tsv_alignment(FILE* file, char* query_sequence_identifier_prefix, char* query_sequence_identifier, char* sequence_identifier, size_t sequence_identifier_length, char* substitution_matrix_name, int64_t score, int64_t gap_penalty, char* trace_X, char* trace_Y, size_t alignment_length, char* quality, size_t quality_length)
+
+	write_int_linear_gap_penalty_tsv_alignment() writes one alignment as a row of the tab separated values (TSV) format to 'file'. 'trace_X' is the
+	reference (query) sequence alignment and 'trace_Y' the sequence alignment. The sequence identifier and the base qualities do not need to be null
+	terminated. 'query_sequence_identifier' starts with the '>' character of the FASTA format, which is not written.
+
+	write_int_linear_gap_penalty_tsv_alignment() returns a negative value on failure like fprintf().
+*/
+int write_int_linear_gap_penalty_tsv_alignment(FILE* file, char* query_sequence_identifier_prefix, char* query_sequence_identifier, char* sequence_identifier, size_t sequence_identifier_length, char* substitution_matrix_name, int64_t score, int64_t gap_penalty, char* trace_X, char* trace_Y, size_t alignment_length, char* quality, size_t quality_length);
+
 #endif /* GQSS_ALIGNMENT_FORMAT_H */
@@ -0,0 +1,356 @@
+/* GQSS FASTQ alignment stream related functions.
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "gqss_alignment_stream.h"
+
+struct gqss_alignment_stream {
+	gqss_batch_aligner* forward_aligner;
+	gqss_batch_aligner* reverse_complement_aligner;
+
+	gqss_alignment_callback callback;
+	void* user_data;
+
+	size_t batch_size;
+	gqss_fastq_record* records;
+	size_t* read_offsets;
+	size_t* read_lengths;
+
+	gqss_batch_result forward;
+	gqss_batch_result reverse_complement;
+
+	gqss_record_sampler sampler;
+	void* sampler_user_data;
+	uint64_t skip_count;
+	bool skip_decided;
+
+	uint64_t record_count;
+	uint64_t aligned_count;
+	uint64_t input_offset;
+	int64_t traceback_cutoff;
+	bool stopped;
+
+	gqss_alignment_stream_stats* stats;
+};
+
+//CLOCK_MONOTONIC time in nanoseconds, for gqss_alignment_stream_stats
+static uint64_t get_monotonic_nanoseconds(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t)now.tv_sec * UINT64_C(1000000000)) + (uint64_t)now.tv_nsec;
+}
+
+//add the time since 'stage_start' to 'counter' and return the start of the next stage
+static uint64_t count_stage_time(uint64_t* counter, uint64_t stage_start) {
+	uint64_t stage_end = get_monotonic_nanoseconds();
+	*counter = (*counter) + (stage_end - stage_start);
+	return stage_end;
+}
+
+/*
+	gqss_alignment_stream_create(gqss_batch_aligner* forward, gqss_batch_aligner* reverse_complement, size_t batch_size, gqss_alignment_callback callback, void* user_data)
+
+	gqss_alignment_stream_create() returns a new stream that aligns up to 'batch_size' records at a time with 'forward' and
+	'reverse_complement' (which may be a NULL pointer). The function returns a NULL pointer on failure.
+*/
+gqss_alignment_stream* gqss_alignment_stream_create(gqss_batch_aligner* forward, gqss_batch_aligner* reverse_complement, size_t batch_size, gqss_alignment_callback callback, void* user_data) {
+	assert((forward != NULL) && (callback != NULL));
+
+	if (batch_size == 0) {
+		return NULL;
+	}
+
+	gqss_alignment_stream* stream = (gqss_alignment_stream *)calloc(1, sizeof(gqss_alignment_stream));
+	if (stream == NULL) {
+		perror("gqss_alignment_stream_create(): calloc(): error");
+		return NULL;
+	}
+
+	stream->forward_aligner = forward;
+	stream->reverse_complement_aligner = reverse_complement;
+	stream->callback = callback;
+	stream->user_data = user_data;
+	stream->batch_size = batch_size;
+
+	//every alignment is traced back
+	stream->traceback_cutoff = INT64_MIN;
+
+	gqss_batch_result_init(&stream->forward);
+	gqss_batch_result_init(&stream->reverse_complement);
+
+	stream->records = (gqss_fastq_record *)malloc(batch_size * sizeof(gqss_fastq_record));
+	stream->read_offsets = (size_t *)malloc(batch_size * sizeof(size_t));
+	stream->read_lengths = (size_t *)malloc(batch_size * sizeof(size_t));
+	if ((stream->records == NULL) || (stream->read_offsets == NULL) || (stream->read_lengths == NULL)) {
+		perror("gqss_alignment_stream_create(): malloc(): error");
+
+		gqss_alignment_stream_destroy(stream);
+		return NULL;
+	}
+
+	return stream;
+}
+
+void gqss_alignment_stream_destroy(gqss_alignment_stream* stream) {
+	if (stream == NULL) {
+		return;
+	}
+
+	gqss_batch_result_free(&stream->forward);
+	gqss_batch_result_free(&stream->reverse_complement);
+
+	free(stream->records);
+	free(stream->read_offsets);
+	free(stream->read_lengths);
+	free(stream);
+	return;
+}
+
+/*
+	collect_sampled_records(gqss_alignment_stream* stream, char* data, size_t length, bool end_of_input, size_t* record_count, uint64_t* input_record_count)
+
+	collect_sampled_records() parses up to a batch of the records of 'data' chosen by the sampler of 'stream', skipping the
+	others, and assigns the number of records parsed to 'record_count' and the number of records read (parsed or skipped) to
+	'input_record_count'. Like parse_fastq_records(), record indices and offsets are relative to 'data' and the function
+	returns the number of bytes consumed. The decision of the sampler carries over to the next call.
+*/
+static size_t collect_sampled_records(gqss_alignment_stream* stream, char* data, size_t length, bool end_of_input, size_t* record_count, uint64_t* input_record_count) {
+	size_t bytes_consumed = 0;
+	size_t parsed_count;
+
+	*record_count = 0;
+	*input_record_count = 0;
+
+	while ((*record_count < stream->batch_size) && (bytes_consumed < length)) {
+		if (!stream->skip_decided) {
+			stream->skip_count = stream->sampler(stream->record_count + (*input_record_count), stream->sampler_user_data);
+			stream->skip_decided = true;
+		}
+
+		if (stream->skip_count > 0) {
+			size_t max_records = (stream->skip_count < (uint64_t)SIZE_MAX) ? (size_t)stream->skip_count : SIZE_MAX;
+			size_t skipped_bytes = skip_fastq_records(data + bytes_consumed, length - bytes_consumed, end_of_input, max_records, &parsed_count);
+			if (parsed_count == 0) {
+				//only a partial record remains
+				break;
+			}
+
+			stream->skip_count = stream->skip_count - parsed_count;
+			stream->skip_decided = (stream->skip_count > 0);
+			*input_record_count = (*input_record_count) + parsed_count;
+			bytes_consumed = bytes_consumed + skipped_bytes;
+			continue;
+		}
+
+		gqss_fastq_record* record = &(stream->records[*record_count]);
+		size_t record_bytes = parse_fastq_records(data + bytes_consumed, length - bytes_consumed, end_of_input, record, 1, &parsed_count);
+		if (parsed_count == 0) {
+			break;
+		}
+
+		record->record_index = *input_record_count;
+		record->offset = bytes_consumed;
+
+		stream->skip_decided = false;
+		*record_count = (*record_count) + 1;
+		*input_record_count = (*input_record_count) + 1;
+		bytes_consumed = bytes_consumed + record_bytes;
+	}
+
+	return bytes_consumed;
+}
+
+/*
+	gqss_alignment_stream_feed(gqss_alignment_stream* stream, char* data, size_t length, bool end_of_input, size_t* bytes_consumed)
+
+	gqss_alignment_stream_feed() aligns every complete FASTQ record found in 'data' and assigns the number of bytes of
+	those records to 'bytes_consumed'. The caller keeps the remaining bytes (a partial record) and feeds them again
+	with more data, or with 'end_of_input' set to true once no more data will follow.
+
+	gqss_alignment_stream_feed() returns false if an alignment failed. It returns true without consuming all
+	complete records if the callback stopped the stream or a batch aligner was cancelled (which stops the stream
+	without delivering the batch).
+*/
+bool gqss_alignment_stream_feed(gqss_alignment_stream* stream, char* data, size_t length, bool end_of_input, size_t* bytes_consumed) {
+	assert((stream != NULL) && (bytes_consumed != NULL));
+
+	*bytes_consumed = 0;
+
+	while ((!stream->stopped) && (*bytes_consumed < length)) {
+		size_t record_count;
+		uint64_t input_record_count;
+		size_t record_bytes;
+
+		uint64_t stage_start = 0;
+		if (stream->stats != NULL) {
+			stage_start = get_monotonic_nanoseconds();
+		}
+
+		if (stream->sampler == NULL) {
+			record_bytes = parse_fastq_records(data + (*bytes_consumed), length - (*bytes_consumed), end_of_input, stream->records, stream->batch_size, &record_count);
+			input_record_count = record_count;
+		}
+		else {
+			record_bytes = collect_sampled_records(stream, data + (*bytes_consumed), length - (*bytes_consumed), end_of_input, &record_count, &input_record_count);
+		}
+
+		if (stream->stats != NULL) {
+			stage_start = count_stage_time(&stream->stats->parse_nanoseconds, stage_start);
+		}
+
+		if (record_bytes == 0) {
+			//only a partial record remains
+			break;
+		}
+
+		if (record_count == 0) {
+			//every record was skipped by the sampler
+			stream->record_count = stream->record_count + input_record_count;
+			*bytes_consumed = (*bytes_consumed) + record_bytes;
+			continue;
+		}
+
+		for (size_t i = 0; i < record_count; i++) {
+			gqss_fastq_record* record = &(stream->records[i]);
+
+			//read offsets are relative to 'data', record offsets are relative to the start of the input
+			stream->read_offsets[i] = (size_t)(record->sequence - data);
+			stream->read_lengths[i] = record->sequence_length;
+
+			record->record_index = stream->record_count + record->record_index;
+			record->offset = record->offset + stream->input_offset + (*bytes_consumed);
+		}
+
+		if (!gqss_batch_aligner_align_cutoff(stream->forward_aligner, data, stream->read_offsets, stream->read_lengths, record_count, stream->traceback_cutoff, &stream->forward)) {
+			if (gqss_batch_aligner_cancelled(stream->forward_aligner)) {
+				stream->stopped = true;
+				break;
+			}
+			return false;
+		}
+
+		gqss_alignment_batch batch;
+		batch.count = record_count;
+		batch.records = stream->records;
+		batch.forward = &stream->forward;
+		batch.reverse_complement = NULL;
+
+		if (stream->reverse_complement_aligner != NULL) {
+			if (!gqss_batch_aligner_align_cutoff(stream->reverse_complement_aligner, data, stream->read_offsets, stream->read_lengths, record_count, stream->traceback_cutoff, &stream->reverse_complement)) {
+				if (gqss_batch_aligner_cancelled(stream->reverse_complement_aligner)) {
+					stream->stopped = true;
+					break;
+				}
+				return false;
+			}
+			batch.reverse_complement = &stream->reverse_complement;
+		}
+
+		if (stream->stats != NULL) {
+			stage_start = count_stage_time(&stream->stats->align_nanoseconds, stage_start);
+		}
+
+		if (!stream->callback(&batch, stream->user_data)) {
+			stream->stopped = true;
+
+			//only the records the callback consumed before stopping the stream count as read
+			if (batch.count < record_count) {
+				input_record_count = 0;
+				record_bytes = 0;
+				if (batch.count > 0) {
+					gqss_fastq_record* last_record = &(stream->records[batch.count - 1]);
+					input_record_count = last_record->record_index + 1 - stream->record_count;
+					record_bytes = (size_t)(last_record->offset + last_record->length - stream->input_offset) - (*bytes_consumed);
+				}
+				record_count = batch.count;
+			}
+		}
+
+		if (stream->stats != NULL) {
+			count_stage_time(&stream->stats->callback_nanoseconds, stage_start);
+			stream->stats->batch_count++;
+		}
+
+		stream->record_count = stream->record_count + input_record_count;
+		stream->aligned_count = stream->aligned_count + record_count;
+		*bytes_consumed = (*bytes_consumed) + record_bytes;
+	}
+
+	stream->input_offset = stream->input_offset + (*bytes_consumed);
+	return true;
+}
+
+//continue record indices at 'record_count' and input offsets at 'input_offset' (e.g. when resuming a run)
+void gqss_alignment_stream_set_position(gqss_alignment_stream* stream, uint64_t record_count, uint64_t input_offset) {
+	assert(stream != NULL);
+
+	stream->record_count = record_count;
+	stream->input_offset = input_offset;
+	return;
+}
+
+//only trace back the alignments of the following batches that score at least 'traceback_cutoff'
+void gqss_alignment_stream_set_traceback_cutoff(gqss_alignment_stream* stream, int64_t traceback_cutoff) {
+	assert(stream != NULL);
+
+	stream->traceback_cutoff = traceback_cutoff;
+	return;
+}
+
+/*
+	gqss_alignment_stream_set_sampler(gqss_alignment_stream* stream, gqss_record_sampler sampler, void* user_data)
+
+	gqss_alignment_stream_set_sampler() only aligns the records chosen by 'sampler'. The records it skips are not parsed,
+	the stream only searches their newline characters. Record indices keep counting the skipped records.
+*/
+void gqss_alignment_stream_set_sampler(gqss_alignment_stream* stream, gqss_record_sampler sampler, void* user_data) {
+	assert(stream != NULL);
+
+	stream->sampler = sampler;
+	stream->sampler_user_data = user_data;
+	stream->skip_decided = false;
+	return;
+}
+
+//add the batches and stage times of the following calls to gqss_alignment_stream_feed() to 'stats' (NULL stops counting)
+void gqss_alignment_stream_set_stats(gqss_alignment_stream* stream, gqss_alignment_stream_stats* stats) {
+	assert(stream != NULL);
+
+	stream->stats = stats;
+	return;
+}
+
+//number of records read so far, aligned or skipped by the sampler
+uint64_t gqss_alignment_stream_record_count(gqss_alignment_stream* stream) {
+	return stream->record_count;
+}
+
+//number of records delivered to the callback so far
+uint64_t gqss_alignment_stream_aligned_count(gqss_alignment_stream* stream) {
+	return stream->aligned_count;
+}
+
+//number of input bytes consumed so far by all calls to gqss_alignment_stream_feed()
+uint64_t gqss_alignment_stream_input_offset(gqss_alignment_stream* stream) {
+	return stream->input_offset;
+}
+
+//check if the stream was stopped by the callback or a cancelled batch aligner
+bool gqss_alignment_stream_stopped(gqss_alignment_stream* stream) {
+	return stream->stopped;
+}
@@ -0,0 +1,133 @@
+/* GQSS FASTQ alignment stream related function definitions
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef GQSS_ALIGNMENT_STREAM_H
+#define GQSS_ALIGNMENT_STREAM_H
+
+#include "gqss_batch_alignment.h"
+#include "gqss_file_io.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+
+/*
+	gqss_alignment_batch is the unit of results delivered to a gqss_alignment_callback.
+
+	Entry 'i' of 'forward' and 'reverse_complement' is the alignment of 'records[i]' against the query and its
+	reverse complement ('reverse_complement' is a NULL pointer if the stream has no reverse complement aligner).
+	The records point into the buffer given to gqss_alignment_stream_feed() and, like the results, are only
+	valid during the callback. Record indices and offsets count from the start of the input (every byte fed
+	to the stream).
+*/
+typedef struct gqss_alignment_batch {
+	size_t count;
+	gqss_fastq_record* records;
+	gqss_batch_result* forward;
+	gqss_batch_result* reverse_complement;
+} gqss_alignment_batch;
+
+/*
+	A callback returns false to stop the stream. Before stopping it, the callback may lower the 'count' of the batch
+	to the number of records it consumed: the records after them are neither counted as read nor as consumed bytes.
+*/
+typedef bool (*gqss_alignment_callback)(gqss_alignment_batch* batch, void* user_data);
+
+//a sampler returns the number of records to skip, starting with record 'record_index' of the input (0 aligns the record)
+typedef uint64_t (*gqss_record_sampler)(uint64_t record_index, void* user_data);
+
+/*
+	gqss_alignment_stream_stats counts the batches of a stream given to gqss_alignment_stream_set_stats() and the
+	CLOCK_MONOTONIC nanoseconds spent parsing (or skipping) their FASTQ records, aligning them (the wall time of both batch
+	aligners) and in the callback.
+*/
+typedef struct gqss_alignment_stream_stats {
+	uint64_t batch_count;
+	uint64_t parse_nanoseconds;
+	uint64_t align_nanoseconds;
+	uint64_t callback_nanoseconds;
+} gqss_alignment_stream_stats;
+
+/*
+	gqss_alignment_stream parses FASTQ records from the buffers it is fed, aligns them in batches with the given
+	batch aligners and delivers every batch, in input order, to the callback.
+*/
+typedef struct gqss_alignment_stream gqss_alignment_stream;
+
+/*
+	gqss_alignment_stream_create(gqss_batch_aligner* forward, gqss_batch_aligner* reverse_complement, size_t batch_size, gqss_alignment_callback callback, void* user_data)
+
+	gqss_alignment_stream_create() returns a new stream that aligns up to 'batch_size' records at a time with 'forward' and
+	'reverse_complement' (which may be a NULL pointer). The function returns a NULL pointer on failure.
+*/
+gqss_alignment_stream* gqss_alignment_stream_create(gqss_batch_aligner* forward, gqss_batch_aligner* reverse_complement, size_t batch_size, gqss_alignment_callback callback, void* user_data);
+
+void gqss_alignment_stream_destroy(gqss_alignment_stream* stream);
+
+/*
+	gqss_alignment_stream_feed(gqss_alignment_stream* stream, char* data, size_t length, bool end_of_input, size_t* bytes_consumed)
+
+	gqss_alignment_stream_feed() aligns every complete FASTQ record found in 'data' and assigns the number of bytes of
+	those records to 'bytes_consumed'. The caller keeps the remaining bytes (a partial record) and feeds them again
+	with more data, or with 'end_of_input' set to true once no more data will follow.
+
+	gqss_alignment_stream_feed() returns false if an alignment failed. It returns true without consuming all
+	complete records if the callback stopped the stream or a batch aligner was cancelled (which stops the stream
+	without delivering the batch).
+*/
+bool gqss_alignment_stream_feed(gqss_alignment_stream* stream, char* data, size_t length, bool end_of_input, size_t* bytes_consumed);
+
+//continue record indices at 'record_count' and input offsets at 'input_offset' (e.g. when resuming a run)
+void gqss_alignment_stream_set_position(gqss_alignment_stream* stream, uint64_t record_count, uint64_t input_offset);
+
+/*
+	gqss_alignment_stream_set_traceback_cutoff(gqss_alignment_stream* stream, int64_t traceback_cutoff)
+
+	gqss_alignment_stream_set_traceback_cutoff() only traces back the alignments of the following batches that score at least
+	'traceback_cutoff', see gqss_aligner_align_cutoff(). The callback may raise the cutoff while the stream runs.
+*/
+void gqss_alignment_stream_set_traceback_cutoff(gqss_alignment_stream* stream, int64_t traceback_cutoff);
+
+/*
+	gqss_alignment_stream_set_sampler(gqss_alignment_stream* stream, gqss_record_sampler sampler, void* user_data)
+
+	gqss_alignment_stream_set_sampler() only aligns the records chosen by 'sampler'. The records it skips are not parsed,
+	the stream only searches their newline characters. Record indices keep counting the skipped records.
+*/
+void gqss_alignment_stream_set_sampler(gqss_alignment_stream* stream, gqss_record_sampler sampler, void* user_data);
+
+//add the batches and stage times of the following calls to gqss_alignment_stream_feed() to 'stats' (NULL stops counting)
+void gqss_alignment_stream_set_stats(gqss_alignment_stream* stream, gqss_alignment_stream_stats* stats);
+
+//number of records read so far, aligned or skipped by the sampler
+uint64_t gqss_alignment_stream_record_count(gqss_alignment_stream* stream);
+
+//number of records delivered to the callback so far
+uint64_t gqss_alignment_stream_aligned_count(gqss_alignment_stream* stream);
+
+//number of input bytes consumed so far by all calls to gqss_alignment_stream_feed()
+uint64_t gqss_alignment_stream_input_offset(gqss_alignment_stream* stream);
+
+//check if the stream was stopped by the callback or a cancelled batch aligner
+bool gqss_alignment_stream_stopped(gqss_alignment_stream* stream);
+
+#endif /* GQSS_ALIGNMENT_STREAM_H */
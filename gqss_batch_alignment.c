@@ -0,0 +1,481 @@
+/* GQSS batch alignment related functions.
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "gqss_batch_alignment.h"
+
+//number of tasks queued per worker for each batch, so that workers finishing early can take more reads
+#define GQSS_BATCH_TASKS_PER_WORKER 4
+
+struct gqss_batch_aligner {
+	gqss_thread_pool* pool;
+
+	size_t worker_count;
+	gqss_aligner** worker_aligners;
+
+	//set by gqss_batch_aligner_cancel(), checked by the tasks before every read
+	pthread_mutex_t mutex;
+	bool cancelled;
+
+	//without a pool, the callers share the single worker aligner one batch at a time
+	pthread_mutex_t caller_mutex;
+};
+
+struct gqss_batch_chunk {
+	gqss_batch_aligner* batch_aligner;
+
+	char* reads;
+	size_t* read_offsets;
+	size_t* read_lengths;
+	size_t first_read;
+	size_t last_read;
+	int64_t traceback_cutoff;
+
+	gqss_batch_result* results;
+
+	//alignment strings of the chunk, copied into the result after every chunk has finished
+	char* query_alignments;
+	char* read_alignments;
+	size_t alignment_size;
+	size_t alignment_capacity;
+
+	bool failed;
+	bool cancelled;
+};
+
+//initialize an empty batch result
+void gqss_batch_result_init(gqss_batch_result* results) {
+	memset(results, 0, sizeof(gqss_batch_result));
+	return;
+}
+
+//free the arrays of a batch result
+void gqss_batch_result_free(gqss_batch_result* results) {
+	if (results == NULL) {
+		return;
+	}
+
+	for (size_t i = 0; i < results->chunk_capacity; i++) {
+		free(results->chunks[i].query_alignments);
+		free(results->chunks[i].read_alignments);
+	}
+	free(results->chunks);
+
+	free(results->scores);
+	free(results->query_starts);
+	free(results->query_stops);
+	free(results->read_starts);
+	free(results->read_stops);
+	free(results->alignment_offsets);
+	free(results->query_alignments);
+	free(results->read_alignments);
+
+	gqss_batch_result_init(results);
+	return;
+}
+
+/*
+	grow_allocation(void** allocation, size_t count, size_t element_size)
+
+	grow_allocation() reallocates '*allocation' to hold 'count' elements of 'element_size' bytes. The function returns
+	false (and leaves '*allocation' untouched) if memory could not be allocated.
+*/
+static bool grow_allocation(void** allocation, size_t count, size_t element_size) {
+	void* new_allocation = realloc(*allocation, count * element_size);
+	if (new_allocation == NULL) {
+		perror("grow_allocation(): realloc(): error");
+		return false;
+	}
+	*allocation = new_allocation;
+	return true;
+}
+
+/*
+	reserve_results(gqss_batch_result* results, size_t count, size_t chunk_count)
+
+	reserve_results() grows the arrays of 'results' to fit 'count' reads and 'chunk_count' tasks. The function returns false
+	if memory could not be allocated.
+*/
+static bool reserve_results(gqss_batch_result* results, size_t count, size_t chunk_count) {
+	if (count > results->capacity) {
+		if (!grow_allocation((void **)&results->scores, count, sizeof(int64_t))
+			|| !grow_allocation((void **)&results->query_starts, count, sizeof(size_t))
+			|| !grow_allocation((void **)&results->query_stops, count, sizeof(size_t))
+			|| !grow_allocation((void **)&results->read_starts, count, sizeof(size_t))
+			|| !grow_allocation((void **)&results->read_stops, count, sizeof(size_t))
+			|| !grow_allocation((void **)&results->alignment_offsets, count + 1, sizeof(size_t))) {
+			return false;
+		}
+		results->capacity = count;
+	}
+
+	if (chunk_count > results->chunk_capacity) {
+		if (!grow_allocation((void **)&results->chunks, chunk_count, sizeof(gqss_batch_chunk))) {
+			return false;
+		}
+
+		//new chunks start without alignment string buffers
+		memset(results->chunks + results->chunk_capacity, 0, (chunk_count - results->chunk_capacity) * sizeof(gqss_batch_chunk));
+		results->chunk_capacity = chunk_count;
+	}
+
+	return true;
+}
+
+/*
+	append_alignment(gqss_batch_chunk* chunk, char* query_alignment, char* read_alignment, size_t alignment_length)
+
+	append_alignment() copies the null terminated alignment strings to the end of the chunk's alignment buffers. The
+	function returns false if memory could not be allocated.
+*/
+static bool append_alignment(gqss_batch_chunk* chunk, char* query_alignment, char* read_alignment, size_t alignment_length) {
+	size_t required_size = chunk->alignment_size + alignment_length + 1;
+	if (required_size > chunk->alignment_capacity) {
+		size_t new_capacity = chunk->alignment_capacity * 2;
+		if (new_capacity < required_size) {
+			new_capacity = required_size;
+		}
+		if (!grow_allocation((void **)&chunk->query_alignments, new_capacity, sizeof(char))
+			|| !grow_allocation((void **)&chunk->read_alignments, new_capacity, sizeof(char))) {
+			return false;
+		}
+		chunk->alignment_capacity = new_capacity;
+	}
+
+	memcpy(chunk->query_alignments + chunk->alignment_size, query_alignment, (alignment_length + 1) * sizeof(char));
+	memcpy(chunk->read_alignments + chunk->alignment_size, read_alignment, (alignment_length + 1) * sizeof(char));
+	chunk->alignment_size = required_size;
+	return true;
+}
+
+/*
+	align_chunk(void* argument, size_t worker_index)
+
+	align_chunk() aligns the reads of one chunk with the aligner of the worker running the task. The alignment string
+	lengths (including the null character) are temporarily stored in 'alignment_offsets[i + 1]'.
+*/
+static void align_chunk(void* argument, size_t worker_index) {
+	gqss_batch_chunk* chunk = (gqss_batch_chunk *)argument;
+	gqss_batch_result* results = chunk->results;
+	gqss_aligner* aligner = chunk->batch_aligner->worker_aligners[worker_index];
+
+	gqss_alignment_result alignment;
+	char empty_alignment[1] = "";
+
+	chunk->alignment_size = 0;
+	chunk->failed = false;
+	chunk->cancelled = false;
+
+	for (size_t i = chunk->first_read; i < chunk->last_read; i++) {
+		if (gqss_batch_aligner_cancelled(chunk->batch_aligner)) {
+			chunk->cancelled = true;
+			return;
+		}
+
+		char* read = chunk->reads + chunk->read_offsets[i];
+		size_t read_length;
+		if (chunk->read_lengths == NULL) {
+			read_length = chunk->read_offsets[i + 1] - chunk->read_offsets[i];
+		}
+		else {
+			read_length = chunk->read_lengths[i];
+		}
+
+		if (read_length == 0) {
+			//nothing to align
+			alignment.score = -1;
+			alignment.query_start = 0;
+			alignment.query_stop = 0;
+			alignment.read_start = 0;
+			alignment.read_stop = 0;
+			alignment.alignment_length = 0;
+			alignment.query_alignment = empty_alignment;
+			alignment.read_alignment = empty_alignment;
+		}
+		else if (!gqss_aligner_align_cutoff(aligner, read, read_length, chunk->traceback_cutoff, &alignment)) {
+			chunk->failed = true;
+			return;
+		}
+
+		results->scores[i] = alignment.score;
+		results->query_starts[i] = alignment.query_start;
+		results->query_stops[i] = alignment.query_stop;
+		results->read_starts[i] = alignment.read_start;
+		results->read_stops[i] = alignment.read_stop;
+		results->alignment_offsets[i + 1] = alignment.alignment_length + 1;
+
+		if (!append_alignment(chunk, alignment.query_alignment, alignment.read_alignment, alignment.alignment_length)) {
+			chunk->failed = true;
+			return;
+		}
+	}
+
+	return;
+}
+
+/*
+	gqss_batch_aligner_create(gqss_aligner* aligner, gqss_thread_pool* pool)
+
+	gqss_batch_aligner_create() returns a new batch aligner with a clone of 'aligner' for each worker of 'pool'. If 'pool' is
+	a NULL pointer, batches are aligned on the calling thread with a single clone, the batches of concurrent callers are
+	aligned one after the other. The function returns a NULL pointer on failure.
+*/
+gqss_batch_aligner* gqss_batch_aligner_create(gqss_aligner* aligner, gqss_thread_pool* pool) {
+	assert(aligner != NULL);
+
+	gqss_batch_aligner* batch_aligner = (gqss_batch_aligner *)calloc(1, sizeof(gqss_batch_aligner));
+	if (batch_aligner == NULL) {
+		perror("gqss_batch_aligner_create(): calloc(): error");
+		return NULL;
+	}
+
+	if (pthread_mutex_init(&batch_aligner->mutex, NULL) != 0) {
+		perror("gqss_batch_aligner_create(): pthread_mutex_init(): error");
+
+		free(batch_aligner);
+		return NULL;
+	}
+	if (pthread_mutex_init(&batch_aligner->caller_mutex, NULL) != 0) {
+		perror("gqss_batch_aligner_create(): pthread_mutex_init(): error");
+
+		pthread_mutex_destroy(&batch_aligner->mutex);
+		free(batch_aligner);
+		return NULL;
+	}
+
+	batch_aligner->pool = pool;
+	if (pool == NULL) {
+		batch_aligner->worker_count = 1;
+	}
+	else {
+		batch_aligner->worker_count = gqss_thread_pool_thread_count(pool);
+	}
+
+	batch_aligner->worker_aligners = (gqss_aligner **)calloc(batch_aligner->worker_count, sizeof(gqss_aligner *));
+	if (batch_aligner->worker_aligners == NULL) {
+		perror("gqss_batch_aligner_create(): calloc(): error");
+
+		pthread_mutex_destroy(&batch_aligner->caller_mutex);
+		pthread_mutex_destroy(&batch_aligner->mutex);
+		free(batch_aligner);
+		return NULL;
+	}
+
+	for (size_t i = 0; i < batch_aligner->worker_count; i++) {
+		batch_aligner->worker_aligners[i] = gqss_aligner_clone(aligner);
+		if (batch_aligner->worker_aligners[i] == NULL) {
+			gqss_batch_aligner_destroy(batch_aligner);
+			return NULL;
+		}
+	}
+
+	return batch_aligner;
+}
+
+void gqss_batch_aligner_destroy(gqss_batch_aligner* batch_aligner) {
+	if (batch_aligner == NULL) {
+		return;
+	}
+
+	for (size_t i = 0; i < batch_aligner->worker_count; i++) {
+		gqss_aligner_destroy(batch_aligner->worker_aligners[i]);
+	}
+
+	free(batch_aligner->worker_aligners);
+	pthread_mutex_destroy(&batch_aligner->caller_mutex);
+	pthread_mutex_destroy(&batch_aligner->mutex);
+	free(batch_aligner);
+	return;
+}
+
+/*
+	gqss_batch_aligner_cancel(gqss_batch_aligner* batch_aligner)
+
+	gqss_batch_aligner_cancel() stops the alignments of 'batch_aligner' running on any thread: the tasks queued or running
+	skip their remaining reads, and every call to gqss_batch_aligner_align() returns false from then on.
+*/
+void gqss_batch_aligner_cancel(gqss_batch_aligner* batch_aligner) {
+	assert(batch_aligner != NULL);
+
+	pthread_mutex_lock(&batch_aligner->mutex);
+	batch_aligner->cancelled = true;
+	pthread_mutex_unlock(&batch_aligner->mutex);
+	return;
+}
+
+//check if gqss_batch_aligner_cancel() was called
+bool gqss_batch_aligner_cancelled(gqss_batch_aligner* batch_aligner) {
+	assert(batch_aligner != NULL);
+
+	pthread_mutex_lock(&batch_aligner->mutex);
+	bool cancelled = batch_aligner->cancelled;
+	pthread_mutex_unlock(&batch_aligner->mutex);
+	return cancelled;
+}
+
+//start or stop counting the work of every worker aligner, see gqss_aligner_set_stats()
+void gqss_batch_aligner_set_stats(gqss_batch_aligner* batch_aligner, bool enabled) {
+	assert(batch_aligner != NULL);
+
+	for (size_t i = 0; i < batch_aligner->worker_count; i++) {
+		gqss_aligner_set_stats(batch_aligner->worker_aligners[i], enabled);
+	}
+	return;
+}
+
+//number of worker aligners, one per thread of the pool (1 without a pool)
+size_t gqss_batch_aligner_worker_count(gqss_batch_aligner* batch_aligner) {
+	assert(batch_aligner != NULL);
+	return batch_aligner->worker_count;
+}
+
+/*
+	gqss_batch_aligner_add_stats(gqss_batch_aligner* batch_aligner, size_t worker_index, gqss_aligner_stats* stats)
+
+	gqss_batch_aligner_add_stats() adds the counters of the aligner of worker 'worker_index' (the thread of the pool with that
+	index) to 'stats'. The counters must not be read while the batch aligner aligns a batch.
+*/
+void gqss_batch_aligner_add_stats(gqss_batch_aligner* batch_aligner, size_t worker_index, gqss_aligner_stats* stats) {
+	assert((batch_aligner != NULL) && (worker_index < batch_aligner->worker_count));
+
+	gqss_aligner_add_stats(batch_aligner->worker_aligners[worker_index], stats);
+	return;
+}
+
+/*
+	gqss_batch_aligner_align(gqss_batch_aligner* batch_aligner, char* reads, size_t* read_offsets, size_t* read_lengths, size_t read_count, gqss_batch_result* results)
+
+	gqss_batch_aligner_align() aligns 'read_count' reads found in the buffer 'reads' and assigns the alignments to 'results'.
+	Read 'i' starts at 'reads + read_offsets[i]' and has length 'read_lengths[i]'. If 'read_lengths' is a NULL pointer, the reads
+	are packed and 'read_offsets' must have (read_count + 1) entries, so that read 'i' has length (read_offsets[i + 1] - read_offsets[i]).
+
+	gqss_batch_aligner_align() returns false if memory could not be allocated or a task could not be queued.
+*/
+bool gqss_batch_aligner_align(gqss_batch_aligner* batch_aligner, char* reads, size_t* read_offsets, size_t* read_lengths, size_t read_count, gqss_batch_result* results) {
+	return gqss_batch_aligner_align_cutoff(batch_aligner, reads, read_offsets, read_lengths, read_count, INT64_MIN, results);
+}
+
+/*
+	gqss_batch_aligner_align_cutoff(gqss_batch_aligner* batch_aligner, char* reads, size_t* read_offsets, size_t* read_lengths, size_t read_count, int64_t traceback_cutoff, gqss_batch_result* results)
+
+	gqss_batch_aligner_align_cutoff() is gqss_batch_aligner_align() that only traces back the alignments scoring at least
+	'traceback_cutoff', see gqss_aligner_align_cutoff().
+*/
+bool gqss_batch_aligner_align_cutoff(gqss_batch_aligner* batch_aligner, char* reads, size_t* read_offsets, size_t* read_lengths, size_t read_count, int64_t traceback_cutoff, gqss_batch_result* results) {
+	assert((batch_aligner != NULL) && (results != NULL));
+
+	results->count = 0;
+	if (gqss_batch_aligner_cancelled(batch_aligner)) {
+		return false;
+	}
+
+	size_t chunk_count = 1;
+	if (batch_aligner->pool != NULL) {
+		chunk_count = batch_aligner->worker_count * GQSS_BATCH_TASKS_PER_WORKER;
+	}
+	if (chunk_count > read_count) {
+		chunk_count = read_count;
+	}
+
+	if (!reserve_results(results, read_count, chunk_count)) {
+		return false;
+	}
+
+	results->alignment_offsets[0] = 0;
+	if (read_count == 0) {
+		return true;
+	}
+
+	size_t reads_per_chunk = read_count / chunk_count;
+	size_t remaining_reads = read_count % chunk_count;
+	size_t next_read = 0;
+	for (size_t i = 0; i < chunk_count; i++) {
+		gqss_batch_chunk* chunk = &(results->chunks[i]);
+		chunk->batch_aligner = batch_aligner;
+		chunk->reads = reads;
+		chunk->read_offsets = read_offsets;
+		chunk->read_lengths = read_lengths;
+		chunk->traceback_cutoff = traceback_cutoff;
+		chunk->results = results;
+
+		//spread the remainder over the first chunks
+		chunk->first_read = next_read;
+		next_read = next_read + reads_per_chunk + ((i < remaining_reads) ? 1 : 0);
+		chunk->last_read = next_read;
+	}
+	assert(next_read == read_count);
+
+	if (batch_aligner->pool == NULL) {
+		pthread_mutex_lock(&batch_aligner->caller_mutex);
+		align_chunk(&(results->chunks[0]), 0);
+		pthread_mutex_unlock(&batch_aligner->caller_mutex);
+	}
+	else {
+		gqss_task_group group;
+		if (!gqss_task_group_init(&group)) {
+			return false;
+		}
+
+		bool submitted = true;
+		for (size_t i = 0; i < chunk_count; i++) {
+			if (!gqss_thread_pool_submit(batch_aligner->pool, &group, align_chunk, &(results->chunks[i]))) {
+				submitted = false;
+				break;
+			}
+		}
+
+		//wait even after a failed submission, queued tasks reference 'results'
+		gqss_task_group_wait(&group);
+		gqss_task_group_destroy(&group);
+
+		if (!submitted) {
+			return false;
+		}
+	}
+
+	//convert alignment string lengths to offsets
+	size_t alignment_size = 0;
+	for (size_t i = 0; i < chunk_count; i++) {
+		if (results->chunks[i].failed || results->chunks[i].cancelled) {
+			return false;
+		}
+		alignment_size = alignment_size + results->chunks[i].alignment_size;
+	}
+	for (size_t i = 0; i < read_count; i++) {
+		results->alignment_offsets[i + 1] = results->alignment_offsets[i] + results->alignment_offsets[i + 1];
+	}
+	assert(results->alignment_offsets[read_count] == alignment_size);
+
+	if (alignment_size > results->alignment_capacity) {
+		if (!grow_allocation((void **)&results->query_alignments, alignment_size, sizeof(char))
+			|| !grow_allocation((void **)&results->read_alignments, alignment_size, sizeof(char))) {
+			return false;
+		}
+		results->alignment_capacity = alignment_size;
+	}
+
+	for (size_t i = 0; i < chunk_count; i++) {
+		gqss_batch_chunk* chunk = &(results->chunks[i]);
+		size_t offset = results->alignment_offsets[chunk->first_read];
+		memcpy(results->query_alignments + offset, chunk->query_alignments, chunk->alignment_size * sizeof(char));
+		memcpy(results->read_alignments + offset, chunk->read_alignments, chunk->alignment_size * sizeof(char));
+	}
+
+	results->count = read_count;
+	return true;
+}
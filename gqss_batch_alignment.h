@@ -0,0 +1,133 @@
+/* GQSS batch alignment related function definitions
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef GQSS_BATCH_ALIGNMENT_H
+#define GQSS_BATCH_ALIGNMENT_H
+
+#include "linear_gap_smith_waterman.h"
+#include "gqss_thread_pool.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+
+/*
+	gqss_batch_aligner aligns arrays of reads against one query with one gqss_aligner clone per worker of a
+	thread pool. Since a worker runs one task at a time, several threads may call gqss_batch_aligner_align()
+	with the same batch aligner as long as each call uses its own gqss_batch_result. Without a pool, the
+	batches are aligned on the calling threads with a single clone, one batch at a time: concurrent calls are
+	safe but do not run in parallel.
+*/
+typedef struct gqss_batch_aligner gqss_batch_aligner;
+
+typedef struct gqss_batch_chunk gqss_batch_chunk;
+
+/*
+	gqss_batch_result is a struct of arrays with one entry per read of a batch.
+
+	The alignment strings of read 'i' start at 'query_alignments + alignment_offsets[i]' and
+	'read_alignments + alignment_offsets[i]', they are null terminated and of length
+	(alignment_offsets[i + 1] - alignment_offsets[i] - 1). Reads of length 0 are given a score of -1
+	and empty alignment strings.
+
+	The arrays are reused (and only grown) by later calls to gqss_batch_aligner_align() with the same result.
+*/
+typedef struct gqss_batch_result {
+	size_t count;
+	int64_t* scores;
+	size_t* query_starts;
+	size_t* query_stops;
+	size_t* read_starts;
+	size_t* read_stops;
+	size_t* alignment_offsets;
+	char* query_alignments;
+	char* read_alignments;
+
+	//allocation sizes and per task scratch, managed by gqss_batch_aligner_align()
+	size_t capacity;
+	size_t alignment_capacity;
+	gqss_batch_chunk* chunks;
+	size_t chunk_capacity;
+} gqss_batch_result;
+
+//initialize an empty batch result
+void gqss_batch_result_init(gqss_batch_result* results);
+
+//free the arrays of a batch result
+void gqss_batch_result_free(gqss_batch_result* results);
+
+/*
+	gqss_batch_aligner_create(gqss_aligner* aligner, gqss_thread_pool* pool)
+
+	gqss_batch_aligner_create() returns a new batch aligner with a clone of 'aligner' for each worker of 'pool'. If 'pool' is
+	a NULL pointer, batches are aligned on the calling thread. The function returns a NULL pointer on failure.
+*/
+gqss_batch_aligner* gqss_batch_aligner_create(gqss_aligner* aligner, gqss_thread_pool* pool);
+
+void gqss_batch_aligner_destroy(gqss_batch_aligner* batch_aligner);
+
+/*
+	gqss_batch_aligner_align(gqss_batch_aligner* batch_aligner, char* reads, size_t* read_offsets, size_t* read_lengths, size_t read_count, gqss_batch_result* results)
+
+	gqss_batch_aligner_align() aligns 'read_count' reads found in the buffer 'reads' and assigns the alignments to 'results'.
+	Read 'i' starts at 'reads + read_offsets[i]' and has length 'read_lengths[i]'. If 'read_lengths' is a NULL pointer, the reads
+	are packed and 'read_offsets' must have (read_count + 1) entries, so that read 'i' has length (read_offsets[i + 1] - read_offsets[i]).
+
+	gqss_batch_aligner_align() returns false if memory could not be allocated, a task could not be queued or the batch aligner
+	was cancelled.
+*/
+bool gqss_batch_aligner_align(gqss_batch_aligner* batch_aligner, char* reads, size_t* read_offsets, size_t* read_lengths, size_t read_count, gqss_batch_result* results);
+
+/*
+	gqss_batch_aligner_align_cutoff(gqss_batch_aligner* batch_aligner, char* reads, size_t* read_offsets, size_t* read_lengths, size_t read_count, int64_t traceback_cutoff, gqss_batch_result* results)
+
+	gqss_batch_aligner_align_cutoff() is gqss_batch_aligner_align() that only traces back the alignments scoring at least
+	'traceback_cutoff', see gqss_aligner_align_cutoff().
+*/
+bool gqss_batch_aligner_align_cutoff(gqss_batch_aligner* batch_aligner, char* reads, size_t* read_offsets, size_t* read_lengths, size_t read_count, int64_t traceback_cutoff, gqss_batch_result* results);
+
+/*
+	gqss_batch_aligner_cancel(gqss_batch_aligner* batch_aligner)
+
+	gqss_batch_aligner_cancel() stops the alignments of 'batch_aligner' running on any thread: the tasks queued or running
+	skip their remaining reads, and every call to gqss_batch_aligner_align() returns false from then on.
+*/
+void gqss_batch_aligner_cancel(gqss_batch_aligner* batch_aligner);
+
+//check if gqss_batch_aligner_cancel() was called
+bool gqss_batch_aligner_cancelled(gqss_batch_aligner* batch_aligner);
+
+//start or stop counting the work of every worker aligner, see gqss_aligner_set_stats()
+void gqss_batch_aligner_set_stats(gqss_batch_aligner* batch_aligner, bool enabled);
+
+//number of worker aligners, one per thread of the pool (1 without a pool)
+size_t gqss_batch_aligner_worker_count(gqss_batch_aligner* batch_aligner);
+
+/*
+	gqss_batch_aligner_add_stats(gqss_batch_aligner* batch_aligner, size_t worker_index, gqss_aligner_stats* stats)
+
+	gqss_batch_aligner_add_stats() adds the counters of the aligner of worker 'worker_index' (the thread of the pool with that
+	index) to 'stats'. The counters must not be read while the batch aligner aligns a batch.
+*/
+void gqss_batch_aligner_add_stats(gqss_batch_aligner* batch_aligner, size_t worker_index, gqss_aligner_stats* stats);
+
+#endif /* GQSS_BATCH_ALIGNMENT_H */
@@ -0,0 +1,50 @@
+/* Definitions for the EDNAFULL substitution matrix and DNA sequence related functions.
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef GQSS_EDNAFULL_H
+#define GQSS_EDNAFULL_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+/*
+	char complement_dna_base(char base)
+
+	complement_dna_base() returns the complement of a given base if possible.
+	Otherwise, the function returns the null character.
+*/
+char complement_dna_base(char base);
+
+/*
+	char* get_reverse_complement(char* sequence)
+
+	get_reverse_complement() returns the reverse complement of a string in a newly allocated C string.
+*/
+char* get_reverse_complement(char* sequence);
+
+/*
+	int64_t get_nuc_4_4_value(char a, char b)
+
+	int64_t get_nuc_4_4_value(char a, char b) return the value of the 2 bases according to the EDNAFULL substitution matrix.
+*/
+int64_t get_nuc_4_4_value(char a, char b);
+
+#endif /* GQSS_EDNAFULL_H */
@@ -0,0 +1,362 @@
+/* GQSS FASTQ record offset index related functions.
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "gqss_fastq_index.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define GQSS_FASTQ_INDEX_VERSION 2
+
+//written in native byte order, a file from a machine of different byte order is rejected
+#define GQSS_FASTQ_INDEX_BYTE_ORDER 0x01020304
+
+//number of offsets buffered before they are written to the index file
+#define GQSS_FASTQ_INDEX_WRITE_BUFFER 4096
+
+//FNV-1a 64-bit offset basis and prime of the fingerprint of the first and last records
+#define GQSS_FASTQ_INDEX_FNV_OFFSET UINT64_C(0xcbf29ce484222325)
+#define GQSS_FASTQ_INDEX_FNV_PRIME UINT64_C(0x100000001b3)
+
+static const char GQSS_FASTQ_INDEX_MAGIC[8] = "GQSSFQI";
+
+/*
+	The header is followed by 'entry_count' uint64_t record offsets. 'fingerprint' is the hash of the bytes of the first
+	and the last record (starting at 'last_record_offset'), so that a FASTQ file rewritten with the same size is detected.
+*/
+typedef struct gqss_fastq_index_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	uint64_t stride;
+	uint64_t record_count;
+	uint64_t fastq_length;
+	uint64_t entry_count;
+	uint64_t last_record_offset;
+	uint64_t fingerprint;
+} gqss_fastq_index_header;
+
+struct gqss_fastq_index {
+	char* data;
+	size_t length;
+	gqss_fastq_index_header* header;
+	uint64_t* offsets;
+};
+
+/*
+	skip_lines(char* data, size_t length, size_t offset, uint64_t line_count)
+
+	skip_lines() returns the offset of the line 'line_count' lines after the line starting at 'offset', or 'length' if the
+	data ends first. memchr() does the scanning, glibc implements it with vector instructions.
+*/
+static size_t skip_lines(char* data, size_t length, size_t offset, uint64_t line_count) {
+	for (uint64_t i = 0; (i < line_count) && (offset < length); i++) {
+		char* newline = (char *)memchr(data + offset, '\n', length - offset);
+		if (newline == NULL) {
+			return length;
+		}
+		offset = (size_t)(newline - data) + 1;
+	}
+	return offset;
+}
+
+//check if a record starts at 'offset': the start of the data or of a line beginning with '@'
+static bool is_record_start(char* data, size_t length, size_t offset) {
+	return (offset < length) && ((offset == 0) || (data[offset - 1] == '\n')) && (data[offset] == '@');
+}
+
+/*
+	get_fingerprint(char* data, size_t length, size_t last_record_offset)
+
+	get_fingerprint() returns the FNV-1a hash of the first record and of the record starting at 'last_record_offset' of
+	the FASTQ data (0 for data without records).
+*/
+static uint64_t get_fingerprint(char* data, size_t length, size_t last_record_offset) {
+	size_t starts[2] = {0, last_record_offset};
+	uint64_t hash = GQSS_FASTQ_INDEX_FNV_OFFSET;
+
+	if (length == 0) {
+		return 0;
+	}
+
+	for (size_t i = 0; i < 2; i++) {
+		size_t end = skip_lines(data, length, starts[i], 4);
+		for (size_t j = starts[i]; j < end; j++) {
+			hash = (hash ^ (unsigned char)data[j]) * GQSS_FASTQ_INDEX_FNV_PRIME;
+		}
+	}
+	return hash;
+}
+
+/*
+	gqss_fastq_index_write(char* filename, char* data, size_t length, uint64_t stride)
+
+	gqss_fastq_index_write() scans the FASTQ data 'data' of 'length' bytes for record starts and writes the offset of every
+	'stride'-th record to the index file 'filename'. The function returns false on failure.
+
+	A record is complete like for parse_fastq_records() at the end of the input: its quality scores line has started,
+	the final newline character may be missing.
+
+	The index is written to 'filename' with a ".tmp" suffix first and then renamed, so that an interrupted run never leaves
+	a truncated index behind.
+*/
+bool gqss_fastq_index_write(char* filename, char* data, size_t length, uint64_t stride) {
+	assert((filename != NULL) && (stride > 0));
+
+	gqss_fastq_index_header header;
+	memset(&header, 0, sizeof(gqss_fastq_index_header));
+	memcpy(header.magic, GQSS_FASTQ_INDEX_MAGIC, sizeof(header.magic));
+	header.version = GQSS_FASTQ_INDEX_VERSION;
+	header.byte_order = GQSS_FASTQ_INDEX_BYTE_ORDER;
+	header.stride = stride;
+	header.fastq_length = length;
+
+	uint64_t* offsets = (uint64_t *)malloc(GQSS_FASTQ_INDEX_WRITE_BUFFER * sizeof(uint64_t));
+	if (offsets == NULL) {
+		perror("gqss_fastq_index_write(): malloc(): error");
+		return false;
+	}
+
+	char* temporary_filename = (char *)malloc((strlen(filename) + 5) * sizeof(char));
+	if (temporary_filename == NULL) {
+		perror("gqss_fastq_index_write(): malloc(): error");
+
+		free(offsets);
+		return false;
+	}
+	memcpy(temporary_filename, filename, (strlen(filename) * sizeof(char)));
+	memcpy((temporary_filename + strlen(filename)), ".tmp", (5 * sizeof(char)));
+
+	FILE* file_fd = fopen(temporary_filename, "wb");
+	if (file_fd == NULL) {
+		perror("gqss_fastq_index_write(): fopen(): error");
+
+		free(temporary_filename);
+		free(offsets);
+		return false;
+	}
+
+	//the header is rewritten with the counts once the scan has finished
+	bool written = (fwrite(&header, sizeof(gqss_fastq_index_header), 1, file_fd) == 1);
+
+	size_t buffered = 0;
+	size_t offset = 0;
+	while (written && (offset < length)) {
+		//the quality scores line of the record must have started
+		size_t quality_start = skip_lines(data, length, offset, 3);
+		if (quality_start >= length) {
+			break;
+		}
+
+		if ((header.record_count % stride) == 0) {
+			offsets[buffered] = offset;
+			buffered++;
+			header.entry_count++;
+
+			if (buffered == GQSS_FASTQ_INDEX_WRITE_BUFFER) {
+				written = (fwrite(offsets, sizeof(uint64_t), buffered, file_fd) == buffered);
+				buffered = 0;
+			}
+		}
+		header.last_record_offset = offset;
+		header.record_count++;
+
+		offset = skip_lines(data, length, quality_start, 1);
+	}
+	if (header.record_count > 0) {
+		header.fingerprint = get_fingerprint(data, length, (size_t)header.last_record_offset);
+	}
+
+	if (written && (buffered > 0)) {
+		written = (fwrite(offsets, sizeof(uint64_t), buffered, file_fd) == buffered);
+	}
+
+	if (written) {
+		written = (fseek(file_fd, 0, SEEK_SET) == 0) && (fwrite(&header, sizeof(gqss_fastq_index_header), 1, file_fd) == 1);
+	}
+
+	free(offsets);
+
+	if ((fclose(file_fd) != 0) || (!written)) {
+		perror("gqss_fastq_index_write(): fwrite(): error");
+
+		unlink(temporary_filename);
+		free(temporary_filename);
+		return false;
+	}
+
+	if (rename(temporary_filename, filename) != 0) {
+		perror("gqss_fastq_index_write(): rename(): error");
+
+		unlink(temporary_filename);
+		free(temporary_filename);
+		return false;
+	}
+
+	free(temporary_filename);
+	return true;
+}
+
+//gqss_fastq_index_open() returns NULL if the file could not be mapped or is not a valid FASTQ index file
+gqss_fastq_index* gqss_fastq_index_open(char* filename) {
+	struct stat file_stat;
+
+	int file_fd = open(filename, O_RDONLY);
+	if (file_fd < 0) {
+		return NULL;
+	}
+
+	if ((fstat(file_fd, &file_stat) != 0) || ((file_stat.st_mode & S_IFMT) != S_IFREG)
+			|| (file_stat.st_size < (off_t)sizeof(gqss_fastq_index_header))) {
+		close(file_fd);
+		return NULL;
+	}
+
+	gqss_fastq_index* index = (gqss_fastq_index *)calloc(1, sizeof(gqss_fastq_index));
+	if (index == NULL) {
+		perror("gqss_fastq_index_open(): calloc(): error");
+
+		close(file_fd);
+		return NULL;
+	}
+
+	index->length = (size_t)file_stat.st_size;
+	index->data = (char *)mmap(NULL, index->length, PROT_READ, MAP_SHARED, file_fd, 0);
+
+	//the mapping stays valid after closing the file descriptor
+	close(file_fd);
+
+	if (index->data == MAP_FAILED) {
+		perror("gqss_fastq_index_open(): mmap(): error");
+
+		free(index);
+		return NULL;
+	}
+
+	index->header = (gqss_fastq_index_header *)index->data;
+	index->offsets = (uint64_t *)(index->data + sizeof(gqss_fastq_index_header));
+
+	gqss_fastq_index_header* header = index->header;
+	uint64_t entry_capacity = (index->length - sizeof(gqss_fastq_index_header)) / sizeof(uint64_t);
+
+	if ((memcmp(header->magic, GQSS_FASTQ_INDEX_MAGIC, sizeof(header->magic)) != 0)
+			|| (header->version != GQSS_FASTQ_INDEX_VERSION)
+			|| (header->byte_order != GQSS_FASTQ_INDEX_BYTE_ORDER)
+			|| (header->stride == 0)
+			|| (header->entry_count != entry_capacity)
+			|| (header->entry_count != ((header->record_count + header->stride - 1) / header->stride))) {
+		printf("error: gqss_fastq_index_open(): \"%s\" is not a valid FASTQ index file!\n", filename);
+
+		gqss_fastq_index_close(index);
+		return NULL;
+	}
+
+	return index;
+}
+
+void gqss_fastq_index_close(gqss_fastq_index* index) {
+	if (index == NULL) {
+		return;
+	}
+
+	munmap(index->data, index->length);
+	free(index);
+	return;
+}
+
+//number of complete records of the indexed FASTQ file
+uint64_t gqss_fastq_index_record_count(gqss_fastq_index* index) {
+	assert(index != NULL);
+	return index->header->record_count;
+}
+
+//size in bytes of the indexed FASTQ file, an index of a different size is stale
+uint64_t gqss_fastq_index_fastq_length(gqss_fastq_index* index) {
+	assert(index != NULL);
+	return index->header->fastq_length;
+}
+
+/*
+	gqss_fastq_index_matches(gqss_fastq_index* index, char* data, size_t length)
+
+	gqss_fastq_index_matches() checks if 'index' was written for the FASTQ data 'data' of 'length' bytes: the size, the
+	start of the last record and the fingerprint of the first and last records must be equal.
+*/
+bool gqss_fastq_index_matches(gqss_fastq_index* index, char* data, size_t length) {
+	assert(index != NULL);
+
+	gqss_fastq_index_header* header = index->header;
+	if (header->fastq_length != length) {
+		return false;
+	}
+	if (header->record_count == 0) {
+		return true;
+	}
+	if (!is_record_start(data, length, (size_t)header->last_record_offset)) {
+		return false;
+	}
+	return (get_fingerprint(data, length, (size_t)header->last_record_offset) == header->fingerprint);
+}
+
+uint64_t gqss_fastq_index_stride(gqss_fastq_index* index) {
+	assert(index != NULL);
+	return index->header->stride;
+}
+
+/*
+	gqss_fastq_index_seek(gqss_fastq_index* index, char* data, size_t length, uint64_t record_index, size_t* offset)
+
+	gqss_fastq_index_seek() assigns the byte offset of record 'record_index' in the indexed FASTQ data to 'offset', found from
+	the closest indexed record by skipping at most (stride - 1) records. A 'record_index' equal to the record count gives the
+	offset of the end of the last record.
+
+	The function returns false if the indexed offset or the offset found is not the start of a record (a line beginning
+	with '@'), the index does not belong to the data then.
+*/
+bool gqss_fastq_index_seek(gqss_fastq_index* index, char* data, size_t length, uint64_t record_index, size_t* offset) {
+	assert((index != NULL) && (offset != NULL) && (length == index->header->fastq_length));
+
+	if (record_index >= index->header->record_count) {
+		*offset = 0;
+		if (index->header->record_count == 0) {
+			return true;
+		}
+
+		//end of the last record
+		size_t last_offset;
+		if (!gqss_fastq_index_seek(index, data, length, (index->header->record_count - 1), &last_offset)) {
+			return false;
+		}
+		*offset = skip_lines(data, length, last_offset, 4);
+		return true;
+	}
+
+	uint64_t entry = record_index / index->header->stride;
+	uint64_t skipped_records = record_index % index->header->stride;
+
+	//a damaged index must not move the scan out of the data
+	if ((index->offsets[entry] >= length) || (!is_record_start(data, length, (size_t)index->offsets[entry]))) {
+		return false;
+	}
+
+	*offset = skip_lines(data, length, (size_t)index->offsets[entry], (4 * skipped_records));
+	return is_record_start(data, length, *offset);
+}
@@ -0,0 +1,74 @@
+/* GQSS FASTQ record offset index related function definitions
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef GQSS_FASTQ_INDEX_H
+#define GQSS_FASTQ_INDEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+
+//file name extension of the FASTQ index written next to a FASTQ file
+#define GQSS_FASTQ_INDEX_EXTENSION ".gqssfqi"
+
+/*
+	gqss_fastq_index is a read-only memory map of a FASTQ index file, which holds the byte offset of every
+	'stride'-th record of a FASTQ file (records 0, stride, 2 * stride, ...), the total number of records and a
+	fingerprint of the first and last records.
+*/
+typedef struct gqss_fastq_index gqss_fastq_index;
+
+/*
+	gqss_fastq_index_write(char* filename, char* data, size_t length, uint64_t stride)
+
+	gqss_fastq_index_write() scans the FASTQ data 'data' of 'length' bytes for record starts and writes the offset of every
+	'stride'-th record to the index file 'filename' (through a temporary file that is renamed). The function returns false
+	on failure.
+*/
+bool gqss_fastq_index_write(char* filename, char* data, size_t length, uint64_t stride);
+
+//gqss_fastq_index_open() returns NULL if the file could not be mapped or is not a valid FASTQ index file
+gqss_fastq_index* gqss_fastq_index_open(char* filename);
+
+void gqss_fastq_index_close(gqss_fastq_index* index);
+
+//number of complete records of the indexed FASTQ file
+uint64_t gqss_fastq_index_record_count(gqss_fastq_index* index);
+
+//size in bytes of the indexed FASTQ file, an index of a different size is stale
+uint64_t gqss_fastq_index_fastq_length(gqss_fastq_index* index);
+
+//check if 'index' belongs to the FASTQ data 'data' (size, last record offset and fingerprint), a stale index does not
+bool gqss_fastq_index_matches(gqss_fastq_index* index, char* data, size_t length);
+
+uint64_t gqss_fastq_index_stride(gqss_fastq_index* index);
+
+/*
+	gqss_fastq_index_seek(gqss_fastq_index* index, char* data, size_t length, uint64_t record_index, size_t* offset)
+
+	gqss_fastq_index_seek() assigns the byte offset of record 'record_index' in the indexed FASTQ data to 'offset', found from
+	the closest indexed record by skipping at most (stride - 1) records. A 'record_index' equal to the record count gives the
+	offset of the end of the last record. The function returns false if an offset is not the start of a record.
+*/
+bool gqss_fastq_index_seek(gqss_fastq_index* index, char* data, size_t length, uint64_t record_index, size_t* offset);
+
+#endif /* GQSS_FASTQ_INDEX_H */
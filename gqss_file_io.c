@@ -26,7 +26,14 @@ char* read_file(char* filename) {
 	size_t fread_bytes;
 
 	//get file size
-	assert((stat(filename, &file_stat) == 0) && ((file_stat.st_mode & S_IFMT) == S_IFREG));
+	if (stat(filename, &file_stat) != 0) {
+		perror("error: stat()");
+		return NULL;
+	}
+	if ((file_stat.st_mode & S_IFMT) != S_IFREG) {
+		printf("error: read_file(): \"%s\" is not a regular file!\n", filename);
+		return NULL;
+	}
 
 	char* file_data = (char *)malloc((file_stat.st_size + 1) * sizeof(char));
 	if (file_data == NULL) {
@@ -56,6 +63,60 @@ char* read_file(char* filename) {
 	return file_data;
 }
 
+//map_file() maps a regular file read-only and assigns its size to 'length', returns NULL on failure
+char* map_file(char* filename, size_t* length) {
+	struct stat file_stat;
+
+	*length = 0;
+
+	int file_fd = open(filename, O_RDONLY);
+	if (file_fd < 0) {
+		perror("error: open()");
+		return NULL;
+	}
+
+	if (fstat(file_fd, &file_stat) != 0) {
+		perror("error: fstat()");
+
+		close(file_fd);
+		return NULL;
+	}
+	if ((file_stat.st_mode & S_IFMT) != S_IFREG) {
+		printf("error: map_file(): \"%s\" is not a regular file!\n", filename);
+
+		close(file_fd);
+		return NULL;
+	}
+
+	//mmap() rejects a length of 0, an empty file gets a mapping of 1 byte that is never read
+	size_t map_length = (file_stat.st_size > 0) ? (size_t)file_stat.st_size : 1;
+
+	char* file_data = (char *)mmap(NULL, map_length, PROT_READ, MAP_PRIVATE, file_fd, 0);
+
+	//the mapping stays valid after closing the file descriptor
+	close(file_fd);
+
+	if (file_data == MAP_FAILED) {
+		perror("error: mmap()");
+		return NULL;
+	}
+
+	//the file is parsed front to back, let the kernel read ahead
+	posix_madvise(file_data, map_length, POSIX_MADV_SEQUENTIAL);
+
+	*length = (size_t)file_stat.st_size;
+	return file_data;
+}
+
+//unmap a file mapped by map_file()
+void unmap_file(char* data, size_t length) {
+	if (data == NULL) {
+		return;
+	}
+	munmap(data, (length > 0) ? length : 1);
+	return;
+}
+
 //extract_line() returns NULL on failure
 char* extract_line(char* data, size_t idx, size_t line_length) {
 	char* line = (char *)malloc((line_length + 1) * sizeof(char));
@@ -235,3 +296,159 @@ size_t extract_fasta_sequence(char* fasta_data, char** fasta_sequence_identifier
 	assert(strlen(*sequence) == sequence_length);
 	return current_index;
 }
+
+//parse up to 'max_records' complete FASTQ records from 'data', return the number of bytes consumed by the records
+//a last record without a final newline character is only parsed if 'end_of_input' is true
+size_t parse_fastq_records(char* data, size_t length, bool end_of_input, gqss_fastq_record* records, size_t max_records, size_t* record_count) {
+	size_t bytes_consumed = 0;
+	*record_count = 0;
+
+	char* lines[4];
+	size_t line_lengths[4];
+
+	while ((*record_count < max_records) && (bytes_consumed < length)) {
+		size_t line_start = bytes_consumed;
+		size_t line_index;
+
+		for (line_index = 0; line_index < 4; line_index++) {
+			size_t line_end;
+			size_t next_line_start;
+
+			char* newline = (char *)memchr(data + line_start, '\n', length - line_start);
+			if (newline != NULL) {
+				line_end = (size_t)(newline - data);
+				next_line_start = line_end + 1;
+			}
+			else if (end_of_input && (line_index == 3) && (line_start < length)) {
+				//last quality scores line of the input is missing the newline character
+				line_end = length;
+				next_line_start = length;
+			}
+			else {
+				//incomplete record
+				break;
+			}
+
+			lines[line_index] = data + line_start;
+			line_lengths[line_index] = line_end - line_start;
+
+			//check for carriage return
+			if ((line_lengths[line_index] > 0) && (lines[line_index][line_lengths[line_index] - 1] == '\r')) {
+				line_lengths[line_index]--;
+			}
+
+			line_start = next_line_start;
+		}
+
+		if (line_index < 4) {
+			break;
+		}
+
+		gqss_fastq_record* record = &(records[*record_count]);
+		record->record_index = *record_count;
+		record->offset = bytes_consumed;
+		record->length = line_start - bytes_consumed;
+		record->identifier = lines[0];
+		record->identifier_length = line_lengths[0];
+		record->sequence = lines[1];
+		record->sequence_length = line_lengths[1];
+		record->quality = lines[3];
+		record->quality_length = line_lengths[3];
+
+		*record_count = (*record_count) + 1;
+		bytes_consumed = line_start;
+	}
+
+	return bytes_consumed;
+}
+
+/*
+	skip_fastq_records(char* data, size_t length, bool end_of_input, size_t max_records, size_t* record_count)
+
+	skip_fastq_records() moves past up to 'max_records' complete FASTQ records of 'data' like parse_fastq_records(), but only
+	searches the 4 newline characters of each record. It assigns the number of records skipped to 'record_count' and returns
+	the number of bytes consumed by them.
+*/
+size_t skip_fastq_records(char* data, size_t length, bool end_of_input, size_t max_records, size_t* record_count) {
+	size_t bytes_consumed = 0;
+	*record_count = 0;
+
+	while ((*record_count < max_records) && (bytes_consumed < length)) {
+		size_t line_start = bytes_consumed;
+		size_t line_index;
+
+		for (line_index = 0; line_index < 4; line_index++) {
+			char* newline = (char *)memchr(data + line_start, '\n', length - line_start);
+			if (newline != NULL) {
+				line_start = (size_t)(newline - data) + 1;
+			}
+			else if (end_of_input && (line_index == 3) && (line_start < length)) {
+				//last quality scores line of the input is missing the newline character
+				line_start = length;
+			}
+			else {
+				//incomplete record
+				break;
+			}
+		}
+
+		if (line_index < 4) {
+			break;
+		}
+
+		*record_count = (*record_count) + 1;
+		bytes_consumed = line_start;
+	}
+
+	return bytes_consumed;
+}
+
+/*
+	find_fastq_record_start(char* data, size_t length, size_t offset)
+
+	find_fastq_record_start() returns the offset of the first FASTQ record starting at or after 'offset', or 'length'
+	if no record starts there. The data is assumed to start with a record.
+
+	A record starts at a line beginning with '@' whose second following line begins with '+'. A quality scores line
+	may also begin with '@', but its second following line is a sequence line, which never begins with '+'.
+*/
+size_t find_fastq_record_start(char* data, size_t length, size_t offset) {
+	if (offset == 0) {
+		return 0;
+	}
+
+	//move to the start of the next line unless 'offset' already is a line start
+	size_t line_start = offset;
+	if (data[offset - 1] != '\n') {
+		char* newline = (char *)memchr(data + offset, '\n', length - offset);
+		if (newline == NULL) {
+			return length;
+		}
+		line_start = (size_t)(newline - data) + 1;
+	}
+
+	while (line_start < length) {
+		char* newline = (char *)memchr(data + line_start, '\n', length - line_start);
+		if (newline == NULL) {
+			return length;
+		}
+		size_t next_line_start = (size_t)(newline - data) + 1;
+
+		if (data[line_start] == '@') {
+			//check the first character of the second following line
+			char* second_newline = (char *)memchr(data + next_line_start, '\n', length - next_line_start);
+			if (second_newline == NULL) {
+				return length;
+			}
+
+			size_t third_line_start = (size_t)(second_newline - data) + 1;
+			if ((third_line_start < length) && (data[third_line_start] == '+')) {
+				return line_start;
+			}
+		}
+
+		line_start = next_line_start;
+	}
+
+	return length;
+}
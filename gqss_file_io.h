@@ -21,6 +21,7 @@
 #define GQSS_FILE_IO_H
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <stdbool.h>
 
@@ -28,11 +29,20 @@
 #include <stdio.h>
 #include <assert.h>
 
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 
 //read_file() returns NULL on failure
 char* read_file(char* filename);
 
+//map_file() maps a regular file read-only and assigns its size to 'length', returns NULL on failure
+char* map_file(char* filename, size_t* length);
+
+//unmap a file mapped by map_file()
+void unmap_file(char* data, size_t length);
+
 //extract_line() returns NULL on failure
 char* extract_line(char* data, size_t idx, size_t line_length);
 
@@ -42,4 +52,31 @@ size_t get_length_fasta_sequence(char* fasta_data);
 //extract first FASTA sequence in 'fasta_data'
 size_t extract_fasta_sequence(char* fasta_data, char** fasta_sequence_identifier, char** sequence);
 
+/*
+	gqss_fastq_record describes one 4 line FASTQ record as slices of the parsed buffer (the lines are not null
+	terminated and exclude the newline and carriage return characters). 'offset' and 'length' give the bytes of
+	the whole record, including the newline characters.
+*/
+typedef struct gqss_fastq_record {
+	uint64_t record_index;
+	size_t offset;
+	size_t length;
+	char* identifier;
+	size_t identifier_length;
+	char* sequence;
+	size_t sequence_length;
+	char* quality;
+	size_t quality_length;
+} gqss_fastq_record;
+
+//parse up to 'max_records' complete FASTQ records from 'data', return the number of bytes consumed by the records
+//a last record without a final newline character is only parsed if 'end_of_input' is true
+size_t parse_fastq_records(char* data, size_t length, bool end_of_input, gqss_fastq_record* records, size_t max_records, size_t* record_count);
+
+//skip up to 'max_records' complete FASTQ records of 'data' by their newline characters, return the number of bytes skipped
+size_t skip_fastq_records(char* data, size_t length, bool end_of_input, size_t max_records, size_t* record_count);
+
+//return the offset of the first FASTQ record starting at or after 'offset', or 'length' if no record starts there
+size_t find_fastq_record_start(char* data, size_t length, size_t offset);
+
 #endif /* GQSS_FILE_IO_H */
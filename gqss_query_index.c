@@ -0,0 +1,362 @@
+/* GQSS query index file related functions.
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "gqss_query_index.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define GQSS_QUERY_INDEX_VERSION 1
+
+//written in native byte order, a file from a machine of different byte order is rejected
+#define GQSS_QUERY_INDEX_BYTE_ORDER 0x01020304
+
+#define GQSS_QUERY_INDEX_ROW_COUNT (GQSS_QUERY_INDEX_LAST_CHARACTER - GQSS_QUERY_INDEX_FIRST_CHARACTER + 1)
+
+static const char GQSS_QUERY_INDEX_MAGIC[8] = "GQSSQIX";
+
+/*
+	The index file starts with this header, every section is aligned to 8 bytes. The profile of a strand is
+	GQSS_QUERY_INDEX_ROW_COUNT rows of 'query_length' int64_t substitution scores.
+*/
+typedef struct gqss_query_index_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	char substitution_matrix_name[16];
+	uint64_t file_length;
+	uint64_t query_length;
+	uint64_t identifier_offset;
+	uint64_t identifier_length;
+	uint64_t sequence_offsets[2];
+	uint64_t profile_offsets[2];
+} gqss_query_index_header;
+
+struct gqss_query_index {
+	char* data;
+	size_t length;
+	gqss_query_index_header* header;
+
+	//256 profile row pointers into the mapped file for each strand
+	int64_t* profiles[2][256];
+};
+
+//round 'offset' up to a multiple of 8 bytes
+static uint64_t align_offset(uint64_t offset) {
+	return (offset + 7) & ~((uint64_t)7);
+}
+
+/*
+	write_padding(FILE* file_fd, uint64_t length)
+
+	write_padding() writes 'length' zero bytes (less than 8) to 'file_fd'. The function returns false on failure.
+*/
+static bool write_padding(FILE* file_fd, uint64_t length) {
+	static const char padding[8] = {0};
+
+	assert(length < 8);
+	return (fwrite(padding, sizeof(char), length, file_fd) == length);
+}
+
+/*
+	write_profile(FILE* file_fd, char* sequence, size_t sequence_length, int64_t (*get_substitution_matrix_value)(char a, char b))
+
+	write_profile() writes the profile rows of the read characters 'A' to 'Z' against 'sequence' to 'file_fd'. The function
+	returns false on failure.
+*/
+static bool write_profile(FILE* file_fd, char* sequence, size_t sequence_length, int64_t (*get_substitution_matrix_value)(char a, char b)) {
+	int64_t* row = (int64_t *)malloc(sequence_length * sizeof(int64_t));
+	if (row == NULL) {
+		perror("write_profile(): malloc(): error");
+		return false;
+	}
+
+	for (int c = GQSS_QUERY_INDEX_FIRST_CHARACTER; c <= GQSS_QUERY_INDEX_LAST_CHARACTER; c++) {
+		for (size_t i = 0; i < sequence_length; i++) {
+			row[i] = get_substitution_matrix_value(sequence[i], (char)c);
+		}
+
+		if (fwrite(row, sizeof(int64_t), sequence_length, file_fd) != sequence_length) {
+			free(row);
+			return false;
+		}
+	}
+
+	free(row);
+	return true;
+}
+
+/*
+	gqss_query_index_write(char* filename, char* identifier, char* query, char* reverse_complement, int64_t (*get_substitution_matrix_value)(char a, char b), char* substitution_matrix_name)
+
+	gqss_query_index_write() computes the query profiles of 'query' and 'reverse_complement' (both null terminated and of equal
+	length) and writes them with the identifier to the index file 'filename'. The function returns false on failure.
+
+	The index is written to 'filename' with a ".tmp" suffix first and then renamed, so that processes mapping an older index
+	of the same name never see a partially written file.
+*/
+bool gqss_query_index_write(char* filename, char* identifier, char* query, char* reverse_complement, int64_t (*get_substitution_matrix_value)(char a, char b), char* substitution_matrix_name) {
+	assert((filename != NULL) && (identifier != NULL) && (query != NULL) && (reverse_complement != NULL));
+
+	size_t query_length = strlen(query);
+	if ((query_length == 0) || (strlen(reverse_complement) != query_length)) {
+		printf("error: gqss_query_index_write(): the query and reverse complement must be non-empty and of equal length!\n");
+		return false;
+	}
+
+	gqss_query_index_header header;
+	memset(&header, 0, sizeof(gqss_query_index_header));
+	memcpy(header.magic, GQSS_QUERY_INDEX_MAGIC, sizeof(header.magic));
+	header.version = GQSS_QUERY_INDEX_VERSION;
+	header.byte_order = GQSS_QUERY_INDEX_BYTE_ORDER;
+	strncpy(header.substitution_matrix_name, substitution_matrix_name, (sizeof(header.substitution_matrix_name) - 1));
+	header.query_length = query_length;
+
+	//layout: header, identifier, query, reverse complement, query profile, reverse complement profile
+	header.identifier_length = strlen(identifier);
+	header.identifier_offset = align_offset(sizeof(gqss_query_index_header));
+	header.sequence_offsets[GQSS_QUERY_INDEX_FORWARD] = align_offset(header.identifier_offset + header.identifier_length + 1);
+	header.sequence_offsets[GQSS_QUERY_INDEX_REVERSE_COMPLEMENT] = align_offset(header.sequence_offsets[GQSS_QUERY_INDEX_FORWARD] + query_length + 1);
+	header.profile_offsets[GQSS_QUERY_INDEX_FORWARD] = align_offset(header.sequence_offsets[GQSS_QUERY_INDEX_REVERSE_COMPLEMENT] + query_length + 1);
+	header.profile_offsets[GQSS_QUERY_INDEX_REVERSE_COMPLEMENT] = header.profile_offsets[GQSS_QUERY_INDEX_FORWARD] + (GQSS_QUERY_INDEX_ROW_COUNT * query_length * sizeof(int64_t));
+	header.file_length = header.profile_offsets[GQSS_QUERY_INDEX_REVERSE_COMPLEMENT] + (GQSS_QUERY_INDEX_ROW_COUNT * query_length * sizeof(int64_t));
+
+	char* temporary_filename = (char *)malloc((strlen(filename) + 5) * sizeof(char));
+	if (temporary_filename == NULL) {
+		perror("gqss_query_index_write(): malloc(): error");
+		return false;
+	}
+	memcpy(temporary_filename, filename, (strlen(filename) * sizeof(char)));
+	memcpy((temporary_filename + strlen(filename)), ".tmp", (5 * sizeof(char)));
+
+	FILE* file_fd = fopen(temporary_filename, "wb");
+	if (file_fd == NULL) {
+		perror("gqss_query_index_write(): fopen(): error");
+
+		free(temporary_filename);
+		return false;
+	}
+
+	char* sequences[2] = {query, reverse_complement};
+
+	bool written = (fwrite(&header, sizeof(gqss_query_index_header), 1, file_fd) == 1)
+				&& write_padding(file_fd, header.identifier_offset - sizeof(gqss_query_index_header))
+				&& (fwrite(identifier, sizeof(char), (header.identifier_length + 1), file_fd) == (header.identifier_length + 1))
+				&& write_padding(file_fd, header.sequence_offsets[0] - (header.identifier_offset + header.identifier_length + 1));
+
+	for (size_t strand = 0; (strand < 2) && written; strand++) {
+		uint64_t sequence_end = header.sequence_offsets[strand] + query_length + 1;
+		uint64_t next_offset = (strand == 0) ? header.sequence_offsets[1] : header.profile_offsets[0];
+
+		written = (fwrite(sequences[strand], sizeof(char), (query_length + 1), file_fd) == (query_length + 1))
+				&& write_padding(file_fd, next_offset - sequence_end);
+	}
+
+	for (size_t strand = 0; (strand < 2) && written; strand++) {
+		written = write_profile(file_fd, sequences[strand], query_length, get_substitution_matrix_value);
+	}
+
+	if ((fclose(file_fd) != 0) || (!written)) {
+		perror("gqss_query_index_write(): fwrite(): error");
+
+		unlink(temporary_filename);
+		free(temporary_filename);
+		return false;
+	}
+
+	if (rename(temporary_filename, filename) != 0) {
+		perror("gqss_query_index_write(): rename(): error");
+
+		unlink(temporary_filename);
+		free(temporary_filename);
+		return false;
+	}
+
+	free(temporary_filename);
+	return true;
+}
+
+/*
+	valid_string(gqss_query_index* index, uint64_t offset, uint64_t length)
+
+	valid_string() checks if the file holds a null terminated string of 'length' characters at 'offset'.
+*/
+static bool valid_string(gqss_query_index* index, uint64_t offset, uint64_t length) {
+	if ((offset > index->length) || (length >= (index->length - offset))) {
+		return false;
+	}
+	return (index->data[offset + length] == '\0');
+}
+
+/*
+	valid_header(gqss_query_index* index)
+
+	valid_header() checks the header of the mapped file and that every section lies within the file.
+*/
+static bool valid_header(gqss_query_index* index) {
+	gqss_query_index_header* header = index->header;
+
+	if (index->length < sizeof(gqss_query_index_header)) {
+		return false;
+	}
+
+	if ((memcmp(header->magic, GQSS_QUERY_INDEX_MAGIC, sizeof(header->magic)) != 0)
+			|| (header->version != GQSS_QUERY_INDEX_VERSION)
+			|| (header->byte_order != GQSS_QUERY_INDEX_BYTE_ORDER)
+			|| (header->file_length != index->length)
+			|| (header->query_length == 0)
+			|| (header->substitution_matrix_name[sizeof(header->substitution_matrix_name) - 1] != '\0')) {
+		return false;
+	}
+
+	if (!valid_string(index, header->identifier_offset, header->identifier_length)) {
+		return false;
+	}
+
+	uint64_t profile_length = GQSS_QUERY_INDEX_ROW_COUNT * sizeof(int64_t);
+	if (header->query_length > (index->length / profile_length)) {
+		return false;
+	}
+	profile_length = profile_length * header->query_length;
+
+	for (size_t strand = 0; strand < 2; strand++) {
+		if (!valid_string(index, header->sequence_offsets[strand], header->query_length)) {
+			return false;
+		}
+
+		if (((header->profile_offsets[strand] & 7) != 0)
+				|| (header->profile_offsets[strand] > index->length)
+				|| (profile_length > (index->length - header->profile_offsets[strand]))) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//gqss_query_index_open() returns NULL if the file could not be mapped or is not a valid index file
+gqss_query_index* gqss_query_index_open(char* filename) {
+	struct stat file_stat;
+
+	int file_fd = open(filename, O_RDONLY);
+	if (file_fd < 0) {
+		perror("gqss_query_index_open(): open(): error");
+		return NULL;
+	}
+
+	if (fstat(file_fd, &file_stat) != 0) {
+		perror("gqss_query_index_open(): fstat(): error");
+
+		close(file_fd);
+		return NULL;
+	}
+
+	if (((file_stat.st_mode & S_IFMT) != S_IFREG) || (file_stat.st_size < (off_t)sizeof(gqss_query_index_header))) {
+		printf("error: gqss_query_index_open(): \"%s\" is not a query index file!\n", filename);
+
+		close(file_fd);
+		return NULL;
+	}
+
+	gqss_query_index* index = (gqss_query_index *)calloc(1, sizeof(gqss_query_index));
+	if (index == NULL) {
+		perror("gqss_query_index_open(): calloc(): error");
+
+		close(file_fd);
+		return NULL;
+	}
+
+	index->length = (size_t)file_stat.st_size;
+	index->data = (char *)mmap(NULL, index->length, PROT_READ, MAP_SHARED, file_fd, 0);
+
+	//the mapping stays valid after closing the file descriptor
+	close(file_fd);
+
+	if (index->data == MAP_FAILED) {
+		perror("gqss_query_index_open(): mmap(): error");
+
+		free(index);
+		return NULL;
+	}
+	index->header = (gqss_query_index_header *)index->data;
+
+	if (!valid_header(index)) {
+		printf("error: gqss_query_index_open(): \"%s\" is not a valid query index file!\n", filename);
+
+		gqss_query_index_close(index);
+		return NULL;
+	}
+
+	for (size_t strand = 0; strand < 2; strand++) {
+		int64_t* profile = (int64_t *)(index->data + index->header->profile_offsets[strand]);
+		for (int c = GQSS_QUERY_INDEX_FIRST_CHARACTER; c <= GQSS_QUERY_INDEX_LAST_CHARACTER; c++) {
+			index->profiles[strand][c] = profile + ((c - GQSS_QUERY_INDEX_FIRST_CHARACTER) * index->header->query_length);
+		}
+	}
+
+	return index;
+}
+
+//unmap the index file, every aligner created from the index must be destroyed first
+void gqss_query_index_close(gqss_query_index* index) {
+	if (index == NULL) {
+		return;
+	}
+
+	munmap(index->data, index->length);
+	free(index);
+	return;
+}
+
+//null terminated query identifier (as found in the FASTA file)
+char* gqss_query_index_identifier(gqss_query_index* index) {
+	assert(index != NULL);
+	return index->data + index->header->identifier_offset;
+}
+
+//null terminated query ('strand' GQSS_QUERY_INDEX_FORWARD) or reverse complement query sequence
+char* gqss_query_index_sequence(gqss_query_index* index, size_t strand) {
+	assert((index != NULL) && (strand < 2));
+	return index->data + index->header->sequence_offsets[strand];
+}
+
+size_t gqss_query_index_query_length(gqss_query_index* index) {
+	assert(index != NULL);
+	return (size_t)index->header->query_length;
+}
+
+//name of the substitution matrix the profiles were computed with
+char* gqss_query_index_substitution_matrix_name(gqss_query_index* index) {
+	assert(index != NULL);
+	return index->header->substitution_matrix_name;
+}
+
+/*
+	gqss_query_index_create_aligner(gqss_query_index* index, size_t strand, int64_t (*get_substitution_matrix_value)(char a, char b), int64_t gap_penalty)
+
+	gqss_query_index_create_aligner() returns an aligner for the query or reverse complement query ('strand') that borrows the
+	profile rows of the mapped file. 'get_substitution_matrix_value' must be the matrix the index was written with, it is only
+	used for read characters outside of 'A' to 'Z'. The function returns a NULL pointer on failure.
+*/
+gqss_aligner* gqss_query_index_create_aligner(gqss_query_index* index, size_t strand, int64_t (*get_substitution_matrix_value)(char a, char b), int64_t gap_penalty) {
+	assert((index != NULL) && (strand < 2));
+	return gqss_aligner_create_with_profile(gqss_query_index_sequence(index, strand), gqss_query_index_query_length(index), get_substitution_matrix_value, gap_penalty, index->profiles[strand]);
+}
@@ -0,0 +1,81 @@
+/* GQSS query index file related function definitions
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef GQSS_QUERY_INDEX_H
+#define GQSS_QUERY_INDEX_H
+
+#include "linear_gap_smith_waterman.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+
+//the query and the reverse complement query of an index
+#define GQSS_QUERY_INDEX_FORWARD 0
+#define GQSS_QUERY_INDEX_REVERSE_COMPLEMENT 1
+
+//profile rows are stored for the read characters 'A' to 'Z'
+#define GQSS_QUERY_INDEX_FIRST_CHARACTER 'A'
+#define GQSS_QUERY_INDEX_LAST_CHARACTER 'Z'
+
+/*
+	gqss_query_index is a read-only memory map of a query index file. The file holds the query identifier, the query,
+	its reverse complement and the query profile rows of both strands, addressed by file offsets only, so that every
+	process mapping the file shares the same pages of the page cache.
+*/
+typedef struct gqss_query_index gqss_query_index;
+
+/*
+	gqss_query_index_write(char* filename, char* identifier, char* query, char* reverse_complement, int64_t (*get_substitution_matrix_value)(char a, char b), char* substitution_matrix_name)
+
+	gqss_query_index_write() computes the query profiles of 'query' and 'reverse_complement' (both null terminated and of equal
+	length) and writes them with the identifier to the index file 'filename'. The function returns false on failure.
+*/
+bool gqss_query_index_write(char* filename, char* identifier, char* query, char* reverse_complement, int64_t (*get_substitution_matrix_value)(char a, char b), char* substitution_matrix_name);
+
+//gqss_query_index_open() returns NULL if the file could not be mapped or is not a valid index file
+gqss_query_index* gqss_query_index_open(char* filename);
+
+//unmap the index file, every aligner created from the index must be destroyed first
+void gqss_query_index_close(gqss_query_index* index);
+
+//null terminated query identifier (as found in the FASTA file)
+char* gqss_query_index_identifier(gqss_query_index* index);
+
+//null terminated query ('strand' GQSS_QUERY_INDEX_FORWARD) or reverse complement query sequence
+char* gqss_query_index_sequence(gqss_query_index* index, size_t strand);
+
+size_t gqss_query_index_query_length(gqss_query_index* index);
+
+//name of the substitution matrix the profiles were computed with
+char* gqss_query_index_substitution_matrix_name(gqss_query_index* index);
+
+/*
+	gqss_query_index_create_aligner(gqss_query_index* index, size_t strand, int64_t (*get_substitution_matrix_value)(char a, char b), int64_t gap_penalty)
+
+	gqss_query_index_create_aligner() returns an aligner for the query or reverse complement query ('strand') that borrows the
+	profile rows of the mapped file. 'get_substitution_matrix_value' must be the matrix the index was written with, it is only
+	used for read characters outside of 'A' to 'Z'. The function returns a NULL pointer on failure.
+*/
+gqss_aligner* gqss_query_index_create_aligner(gqss_query_index* index, size_t strand, int64_t (*get_substitution_matrix_value)(char a, char b), int64_t gap_penalty);
+
+#endif /* GQSS_QUERY_INDEX_H */
@@ -0,0 +1,243 @@
+/* GQSS thread pool related functions.
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "gqss_thread_pool.h"
+
+typedef struct gqss_task {
+	void (*function)(void* argument, size_t worker_index);
+	void* argument;
+	gqss_task_group* group;
+	struct gqss_task* next;
+} gqss_task;
+
+typedef struct gqss_worker {
+	gqss_thread_pool* pool;
+	size_t worker_index;
+	pthread_t thread;
+} gqss_worker;
+
+struct gqss_thread_pool {
+	pthread_mutex_t mutex;
+	pthread_cond_t task_available;
+
+	gqss_task* first_task;
+	gqss_task* last_task;
+
+	bool shutdown;
+
+	size_t thread_count;
+	gqss_worker* workers;
+};
+
+/*
+	finish_task(gqss_task_group* group)
+
+	finish_task() decrements the number of pending tasks of 'group' and wakes the waiting thread after the last task.
+*/
+static void finish_task(gqss_task_group* group) {
+	pthread_mutex_lock(&group->mutex);
+	group->pending--;
+	if (group->pending == 0) {
+		pthread_cond_broadcast(&group->finished);
+	}
+	pthread_mutex_unlock(&group->mutex);
+	return;
+}
+
+/*
+	run_worker(void* argument)
+
+	run_worker() is the start routine of each worker thread, it runs queued tasks until the pool is shut down
+	and the queue is empty.
+*/
+static void* run_worker(void* argument) {
+	gqss_worker* worker = (gqss_worker *)argument;
+	gqss_thread_pool* pool = worker->pool;
+
+	while (true) {
+		pthread_mutex_lock(&pool->mutex);
+		while ((pool->first_task == NULL) && (!pool->shutdown)) {
+			pthread_cond_wait(&pool->task_available, &pool->mutex);
+		}
+
+		gqss_task* task = pool->first_task;
+		if (task == NULL) {
+			//pool was shut down and no tasks remain
+			pthread_mutex_unlock(&pool->mutex);
+			break;
+		}
+
+		pool->first_task = task->next;
+		if (pool->first_task == NULL) {
+			pool->last_task = NULL;
+		}
+		pthread_mutex_unlock(&pool->mutex);
+
+		task->function(task->argument, worker->worker_index);
+		finish_task(task->group);
+
+		free(task);
+	}
+
+	return NULL;
+}
+
+//gqss_thread_pool_create() returns NULL on failure
+gqss_thread_pool* gqss_thread_pool_create(size_t thread_count) {
+	if (thread_count == 0) {
+		return NULL;
+	}
+
+	gqss_thread_pool* pool = (gqss_thread_pool *)calloc(1, sizeof(gqss_thread_pool));
+	if (pool == NULL) {
+		perror("gqss_thread_pool_create(): calloc(): error");
+		return NULL;
+	}
+
+	pool->workers = (gqss_worker *)calloc(thread_count, sizeof(gqss_worker));
+	if (pool->workers == NULL) {
+		perror("gqss_thread_pool_create(): calloc(): error");
+
+		free(pool);
+		return NULL;
+	}
+
+	if (pthread_mutex_init(&pool->mutex, NULL) != 0) {
+		free(pool->workers);
+		free(pool);
+		return NULL;
+	}
+
+	if (pthread_cond_init(&pool->task_available, NULL) != 0) {
+		pthread_mutex_destroy(&pool->mutex);
+		free(pool->workers);
+		free(pool);
+		return NULL;
+	}
+
+	for (size_t i = 0; i < thread_count; i++) {
+		pool->workers[i].pool = pool;
+		pool->workers[i].worker_index = i;
+		if (pthread_create(&(pool->workers[i].thread), NULL, run_worker, &(pool->workers[i])) != 0) {
+			printf("error: gqss_thread_pool_create(): pthread_create() failed!\n");
+
+			//join the threads that were started
+			pool->thread_count = i;
+			gqss_thread_pool_destroy(pool);
+			return NULL;
+		}
+	}
+	pool->thread_count = thread_count;
+
+	return pool;
+}
+
+//wait for queued tasks to finish and join the worker threads
+void gqss_thread_pool_destroy(gqss_thread_pool* pool) {
+	if (pool == NULL) {
+		return;
+	}
+
+	pthread_mutex_lock(&pool->mutex);
+	pool->shutdown = true;
+	pthread_cond_broadcast(&pool->task_available);
+	pthread_mutex_unlock(&pool->mutex);
+
+	for (size_t i = 0; i < pool->thread_count; i++) {
+		pthread_join(pool->workers[i].thread, NULL);
+	}
+
+	pthread_cond_destroy(&pool->task_available);
+	pthread_mutex_destroy(&pool->mutex);
+
+	free(pool->workers);
+	free(pool);
+	return;
+}
+
+//number of worker threads in 'pool'
+size_t gqss_thread_pool_thread_count(gqss_thread_pool* pool) {
+	assert(pool != NULL);
+	return pool->thread_count;
+}
+
+//gqss_thread_pool_submit() returns false if the task could not be queued
+bool gqss_thread_pool_submit(gqss_thread_pool* pool, gqss_task_group* group, void (*function)(void* argument, size_t worker_index), void* argument) {
+	assert((pool != NULL) && (group != NULL) && (function != NULL));
+
+	gqss_task* task = (gqss_task *)malloc(sizeof(gqss_task));
+	if (task == NULL) {
+		perror("gqss_thread_pool_submit(): malloc(): error");
+		return false;
+	}
+
+	task->function = function;
+	task->argument = argument;
+	task->group = group;
+	task->next = NULL;
+
+	pthread_mutex_lock(&group->mutex);
+	group->pending++;
+	pthread_mutex_unlock(&group->mutex);
+
+	pthread_mutex_lock(&pool->mutex);
+	if (pool->last_task == NULL) {
+		pool->first_task = task;
+	}
+	else {
+		pool->last_task->next = task;
+	}
+	pool->last_task = task;
+	pthread_cond_signal(&pool->task_available);
+	pthread_mutex_unlock(&pool->mutex);
+
+	return true;
+}
+
+//gqss_task_group_init() returns false on failure
+bool gqss_task_group_init(gqss_task_group* group) {
+	group->pending = 0;
+
+	if (pthread_mutex_init(&group->mutex, NULL) != 0) {
+		return false;
+	}
+
+	if (pthread_cond_init(&group->finished, NULL) != 0) {
+		pthread_mutex_destroy(&group->mutex);
+		return false;
+	}
+
+	return true;
+}
+
+void gqss_task_group_destroy(gqss_task_group* group) {
+	pthread_cond_destroy(&group->finished);
+	pthread_mutex_destroy(&group->mutex);
+	return;
+}
+
+//block until every task submitted with 'group' has finished
+void gqss_task_group_wait(gqss_task_group* group) {
+	pthread_mutex_lock(&group->mutex);
+	while (group->pending != 0) {
+		pthread_cond_wait(&group->finished, &group->mutex);
+	}
+	pthread_mutex_unlock(&group->mutex);
+	return;
+}
@@ -0,0 +1,65 @@
+/* GQSS thread pool related function definitions
+ *
+ * Copyright (C) 2019 Qijia (Michael) Jin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef GQSS_THREAD_POOL_H
+#define GQSS_THREAD_POOL_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <assert.h>
+
+#include <pthread.h>
+
+/*
+	gqss_thread_pool is a fixed number of worker threads that run submitted tasks in submission order.
+
+	Every task belongs to a gqss_task_group, so that several callers can share one pool and each wait only
+	for their own tasks. A task is given the index of the worker running it (0 to thread count - 1), which
+	lets callers keep per-worker state without locking since a worker runs one task at a time.
+*/
+typedef struct gqss_thread_pool gqss_thread_pool;
+
+typedef struct gqss_task_group {
+	pthread_mutex_t mutex;
+	pthread_cond_t finished;
+	size_t pending;
+} gqss_task_group;
+
+//gqss_thread_pool_create() returns NULL on failure
+gqss_thread_pool* gqss_thread_pool_create(size_t thread_count);
+
+//wait for queued tasks to finish and join the worker threads
+void gqss_thread_pool_destroy(gqss_thread_pool* pool);
+
+//number of worker threads in 'pool'
+size_t gqss_thread_pool_thread_count(gqss_thread_pool* pool);
+
+//gqss_thread_pool_submit() returns false if the task could not be queued
+bool gqss_thread_pool_submit(gqss_thread_pool* pool, gqss_task_group* group, void (*function)(void* argument, size_t worker_index), void* argument);
+
+//gqss_task_group_init() returns false on failure
+bool gqss_task_group_init(gqss_task_group* group);
+
+void gqss_task_group_destroy(gqss_task_group* group);
+
+//block until every task submitted with 'group' has finished
+void gqss_task_group_wait(gqss_task_group* group);
+
+#endif /* GQSS_THREAD_POOL_H */
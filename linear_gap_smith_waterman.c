@@ -109,21 +109,22 @@ bool best_linear_gap_smith_waterman_score_indices(size_t len_X, size_t len_Y, in
 }
 
 /*
-	trace_linear_gap_smith_waterman(char* seq_X, char* seq_Y, int64_t* Z, char* trace_X, char* trace_Y, size_t x, size_t y, int64_t (*get_substitution_matrix_value)(char a, char b), int64_t gap_penalty)
+	trace_scores(char* seq_X, size_t len_X, char* seq_Y, size_t len_Y, int64_t* Z, char* trace_X, char* trace_Y, size_t* x, size_t* y, int64_t (*get_substitution_matrix_value)(char a, char b), int64_t gap_penalty)
 
-	trace_linear_gap_smith_waterman() expects a matrix scored by the Smith-Waterman algorithm. The strings 'trace_X' and 'trace_Y'
-	should be given alignment 'char *' allocations of size (length(X) + length(Y) + 1) for worst case (triangle inequality)
+	trace_scores() is the traceback of trace_linear_gap_smith_waterman() for sequences of known lengths. The function
+	returns the length of the alignment strings written to 'trace_X' and 'trace_Y'.
 */
-void trace_linear_gap_smith_waterman(char* seq_X, char* seq_Y, int64_t* Z, char* trace_X, char* trace_Y, size_t* x, size_t* y, int64_t (*get_substitution_matrix_value)(char a, char b), int64_t gap_penalty) {
-	size_t len_X = strlen(seq_X);
-	size_t len_Y = strlen(seq_Y);
+static size_t trace_scores(char* seq_X, size_t len_X, char* seq_Y, size_t len_Y, int64_t* Z, char* trace_X, char* trace_Y, size_t* x, size_t* y, int64_t (*get_substitution_matrix_value)(char a, char b), int64_t gap_penalty) {
 	assert(((len_X > 0) && (len_Y > 0)));
 
-
 	int64_t score = Z[((*x) * len_Y) + (*y)];
 
 	size_t alignment_index = 0;
 
+	//a matrix without a positive score aligns the bases at the given indices
+	trace_X[alignment_index] = seq_X[*x];
+	trace_Y[alignment_index] = seq_Y[*y];
+
 	//we should break when we see the next match is 0
 	while (score != 0) {
 		if ((*x == 0) || (*y == 0)) {
@@ -187,5 +188,418 @@ void trace_linear_gap_smith_waterman(char* seq_X, char* seq_Y, int64_t* Z, char*
 		trace_Y[i] = trace_Y[alignment_index - i];
 		trace_Y[alignment_index - i] = swap_buffer;
 	}
+	return alignment_length;
+}
+
+/*
+	trace_linear_gap_smith_waterman(char* seq_X, char* seq_Y, int64_t* Z, char* trace_X, char* trace_Y, size_t x, size_t y, int64_t (*get_substitution_matrix_value)(char a, char b), int64_t gap_penalty)
+
+	trace_linear_gap_smith_waterman() expects a matrix scored by the Smith-Waterman algorithm. The strings 'trace_X' and 'trace_Y'
+	should be given alignment 'char *' allocations of size (length(X) + length(Y) + 1) for worst case (triangle inequality)
+*/
+void trace_linear_gap_smith_waterman(char* seq_X, char* seq_Y, int64_t* Z, char* trace_X, char* trace_Y, size_t* x, size_t* y, int64_t (*get_substitution_matrix_value)(char a, char b), int64_t gap_penalty) {
+	trace_scores(seq_X, strlen(seq_X), seq_Y, strlen(seq_Y), Z, trace_X, trace_Y, x, y, get_substitution_matrix_value, gap_penalty);
 	return;
-}
\ No newline at end of file
+}
+
+struct gqss_aligner {
+	char* query;
+	size_t query_length;
+	int64_t (*get_substitution_matrix_value)(char a, char b);
+	int64_t gap_penalty;
+
+	//query profile, 'profile[c][i]' is the substitution score of query position 'i' and read character 'c'
+	int64_t* profile[256];
+
+	//borrowed profile rows (not freed) used before computing a row, NULL pointer if the aligner has none
+	int64_t** shared_profile;
+
+	//profile row of each read position for the read being aligned
+	int64_t** read_profile;
+	size_t read_capacity;
+
+	int64_t* scores;
+	size_t scores_capacity;
+
+	char* query_trace;
+	char* read_trace;
+	size_t trace_capacity;
+
+	//counters of gqss_aligner_set_stats()
+	bool stats_enabled;
+	gqss_aligner_stats stats;
+};
+
+/*
+	gqss_aligner_create(char* query, size_t query_length, int64_t (*get_substitution_matrix_value)(char a, char b), int64_t gap_penalty)
+
+	gqss_aligner_create() returns a newly allocated aligner context for 'query' (the query is copied). The function returns
+	a NULL pointer if 'query_length' is 0 or if memory could not be allocated.
+*/
+gqss_aligner* gqss_aligner_create(char* query, size_t query_length, int64_t (*get_substitution_matrix_value)(char a, char b), int64_t gap_penalty) {
+	return gqss_aligner_create_with_profile(query, query_length, get_substitution_matrix_value, gap_penalty, NULL);
+}
+
+/*
+	gqss_aligner_create_with_profile(char* query, size_t query_length, int64_t (*get_substitution_matrix_value)(char a, char b), int64_t gap_penalty, int64_t** shared_profile)
+
+	gqss_aligner_create_with_profile() is gqss_aligner_create() with precomputed query profile rows. 'shared_profile' has 256
+	entries, entry 'c' is either a NULL pointer or the 'query_length' substitution scores of read character 'c' against every
+	query position. The rows are borrowed: they are never written or freed and must outlive the aligner and its clones.
+*/
+gqss_aligner* gqss_aligner_create_with_profile(char* query, size_t query_length, int64_t (*get_substitution_matrix_value)(char a, char b), int64_t gap_penalty, int64_t** shared_profile) {
+	if ((query == NULL) || (query_length == 0)) {
+		return NULL;
+	}
+
+	gqss_aligner* aligner = (gqss_aligner *)calloc(1, sizeof(gqss_aligner));
+	if (aligner == NULL) {
+		return NULL;
+	}
+
+	aligner->query = (char *)malloc((query_length + 1) * sizeof(char));
+	if (aligner->query == NULL) {
+		free(aligner);
+		return NULL;
+	}
+	memcpy(aligner->query, query, (query_length * sizeof(char)));
+	aligner->query[query_length] = '\0';
+
+	aligner->query_length = query_length;
+	aligner->get_substitution_matrix_value = get_substitution_matrix_value;
+	aligner->gap_penalty = gap_penalty;
+	aligner->shared_profile = shared_profile;
+
+	return aligner;
+}
+
+/*
+	gqss_aligner_clone(gqss_aligner* aligner)
+
+	gqss_aligner_clone() returns a new aligner context with the same query, substitution matrix and gap penalty as 'aligner'.
+	The clone has its own profile and scratch memory (it borrows the same shared profile rows), so the two contexts may be
+	used from different threads. The function returns a NULL pointer if memory could not be allocated.
+*/
+gqss_aligner* gqss_aligner_clone(gqss_aligner* aligner) {
+	assert(aligner != NULL);
+
+	gqss_aligner* clone = gqss_aligner_create_with_profile(aligner->query, aligner->query_length, aligner->get_substitution_matrix_value, aligner->gap_penalty, aligner->shared_profile);
+	if (clone != NULL) {
+		clone->stats_enabled = aligner->stats_enabled;
+	}
+	return clone;
+}
+
+/*
+	gqss_aligner_query_length(gqss_aligner* aligner)
+
+	gqss_aligner_query_length() returns the length of the aligner's query sequence.
+*/
+size_t gqss_aligner_query_length(gqss_aligner* aligner) {
+	assert(aligner != NULL);
+	return aligner->query_length;
+}
+
+/*
+	gqss_aligner_set_stats(gqss_aligner* aligner, bool enabled)
+
+	gqss_aligner_set_stats() starts or stops counting the work of 'aligner' (see gqss_aligner_stats), clones created from
+	then on count as well. Counting reads the clock 4 times per alignment, it is disabled by default.
+*/
+void gqss_aligner_set_stats(gqss_aligner* aligner, bool enabled) {
+	assert(aligner != NULL);
+
+	aligner->stats_enabled = enabled;
+	return;
+}
+
+//add the counters of 'aligner' to 'stats'
+void gqss_aligner_add_stats(gqss_aligner* aligner, gqss_aligner_stats* stats) {
+	assert((aligner != NULL) && (stats != NULL));
+
+	stats->alignment_count = stats->alignment_count + aligner->stats.alignment_count;
+	stats->cell_count = stats->cell_count + aligner->stats.cell_count;
+	stats->traceback_count = stats->traceback_count + aligner->stats.traceback_count;
+	stats->skipped_traceback_count = stats->skipped_traceback_count + aligner->stats.skipped_traceback_count;
+	stats->allocation_count = stats->allocation_count + aligner->stats.allocation_count;
+	stats->encode_nanoseconds = stats->encode_nanoseconds + aligner->stats.encode_nanoseconds;
+	stats->fill_nanoseconds = stats->fill_nanoseconds + aligner->stats.fill_nanoseconds;
+	stats->traceback_nanoseconds = stats->traceback_nanoseconds + aligner->stats.traceback_nanoseconds;
+	return;
+}
+
+/*
+	gqss_aligner_destroy(gqss_aligner* aligner)
+
+	gqss_aligner_destroy() frees the aligner context and every allocation owned by it.
+*/
+void gqss_aligner_destroy(gqss_aligner* aligner) {
+	if (aligner == NULL) {
+		return;
+	}
+
+	for (size_t c = 0; c < 256; c++) {
+		free(aligner->profile[c]);
+	}
+
+	free(aligner->read_profile);
+	free(aligner->scores);
+	free(aligner->query_trace);
+	free(aligner->read_trace);
+	free(aligner->query);
+	free(aligner);
+	return;
+}
+
+/*
+	get_profile_row(gqss_aligner* aligner, char c)
+
+	get_profile_row() returns the query profile row of the read character 'c', the row is borrowed from the shared profile
+	or computed on first use. Otherwise, return NULL if the row could not be allocated.
+*/
+static int64_t* get_profile_row(gqss_aligner* aligner, char c) {
+	int64_t* row = aligner->profile[(unsigned char)c];
+	if (row != NULL) {
+		return row;
+	}
+
+	if ((aligner->shared_profile != NULL) && (aligner->shared_profile[(unsigned char)c] != NULL)) {
+		return aligner->shared_profile[(unsigned char)c];
+	}
+
+	row = (int64_t *)malloc(aligner->query_length * sizeof(int64_t));
+	if (row == NULL) {
+		return NULL;
+	}
+	if (aligner->stats_enabled) {
+		aligner->stats.allocation_count++;
+	}
+
+	for (size_t i = 0; i < aligner->query_length; i++) {
+		row[i] = aligner->get_substitution_matrix_value(aligner->query[i], c);
+	}
+
+	aligner->profile[(unsigned char)c] = row;
+	return row;
+}
+
+//CLOCK_MONOTONIC time in nanoseconds, for gqss_aligner_stats
+static uint64_t get_monotonic_nanoseconds(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t)now.tv_sec * UINT64_C(1000000000)) + (uint64_t)now.tv_nsec;
+}
+
+//add the time since 'stage_start' to 'counter' and return the start of the next stage
+static uint64_t count_stage_time(uint64_t* counter, uint64_t stage_start) {
+	uint64_t stage_end = get_monotonic_nanoseconds();
+	*counter = (*counter) + (stage_end - stage_start);
+	return stage_end;
+}
+
+/*
+	reserve_scratch(gqss_aligner* aligner, size_t read_length)
+
+	reserve_scratch() grows the scratch allocations of the aligner to fit a read of length 'read_length'. The function
+	returns false if memory could not be allocated.
+*/
+static bool reserve_scratch(gqss_aligner* aligner, size_t read_length) {
+	if (read_length > aligner->read_capacity) {
+		int64_t** read_profile = (int64_t **)realloc(aligner->read_profile, read_length * sizeof(int64_t *));
+		if (read_profile == NULL) {
+			return false;
+		}
+		aligner->read_profile = read_profile;
+		aligner->read_capacity = read_length;
+		if (aligner->stats_enabled) {
+			aligner->stats.allocation_count++;
+		}
+	}
+
+	if (aligner->query_length > (SIZE_MAX / sizeof(int64_t)) / read_length) {
+		return false;
+	}
+
+	size_t matrix_size = aligner->query_length * read_length;
+	if (matrix_size > aligner->scores_capacity) {
+		int64_t* scores = (int64_t *)realloc(aligner->scores, matrix_size * sizeof(int64_t));
+		if (scores == NULL) {
+			return false;
+		}
+		aligner->scores = scores;
+		aligner->scores_capacity = matrix_size;
+		if (aligner->stats_enabled) {
+			aligner->stats.allocation_count++;
+		}
+	}
+
+	//worst case alignment length (triangle inequality) and null character
+	size_t trace_size = aligner->query_length + read_length + 1;
+	if (trace_size > aligner->trace_capacity) {
+		char* query_trace = (char *)realloc(aligner->query_trace, trace_size * sizeof(char));
+		if (query_trace == NULL) {
+			return false;
+		}
+		aligner->query_trace = query_trace;
+
+		char* read_trace = (char *)realloc(aligner->read_trace, trace_size * sizeof(char));
+		if (read_trace == NULL) {
+			return false;
+		}
+		aligner->read_trace = read_trace;
+		aligner->trace_capacity = trace_size;
+		if (aligner->stats_enabled) {
+			aligner->stats.allocation_count = aligner->stats.allocation_count + 2;
+		}
+	}
+
+	return true;
+}
+
+/*
+	profile_linear_gap_smith_waterman_score(int64_t left, int64_t up_left, int64_t up, int64_t substitution_value, int64_t gap_penalty)
+
+	profile_linear_gap_smith_waterman_score() is best_linear_gap_smith_waterman_score() with the substitution matrix value
+	already looked up from the query profile.
+*/
+static inline int64_t profile_linear_gap_smith_waterman_score(int64_t left, int64_t up_left, int64_t up, int64_t substitution_value, int64_t gap_penalty) {
+	return max(max(max(left - gap_penalty, up - gap_penalty), (up_left + substitution_value)), 0);
+}
+
+/*
+	gqss_aligner_align(gqss_aligner* aligner, char* read, size_t read_length, gqss_alignment_result* result)
+
+	gqss_aligner_align() aligns 'read' (which does not need to be null terminated) against the aligner's query and
+	assigns the best score, its indices and the alignment strings to 'result'. The query is 'X' and the read is 'Y'
+	in the terms of linear_gap_smith_waterman() and the results are identical to those functions.
+
+	gqss_aligner_align() returns false if 'read_length' is 0 or if scratch memory could not be allocated.
+*/
+bool gqss_aligner_align(gqss_aligner* aligner, char* read, size_t read_length, gqss_alignment_result* result) {
+	return gqss_aligner_align_cutoff(aligner, read, read_length, INT64_MIN, result);
+}
+
+/*
+	gqss_aligner_align_cutoff(gqss_aligner* aligner, char* read, size_t read_length, int64_t traceback_cutoff, gqss_alignment_result* result)
+
+	gqss_aligner_align_cutoff() is gqss_aligner_align() that only traces back alignments scoring at least 'traceback_cutoff'.
+	The result of a lower score has the best score and stop indices, start indices equal to the stop indices and empty
+	alignment strings. INT64_MAX computes scores only.
+*/
+bool gqss_aligner_align_cutoff(gqss_aligner* aligner, char* read, size_t read_length, int64_t traceback_cutoff, gqss_alignment_result* result) {
+	assert((aligner != NULL) && (result != NULL));
+
+	if ((read == NULL) || (read_length == 0)) {
+		return false;
+	}
+
+	uint64_t stage_start = 0;
+	if (aligner->stats_enabled) {
+		stage_start = get_monotonic_nanoseconds();
+	}
+
+	if (!reserve_scratch(aligner, read_length)) {
+		return false;
+	}
+
+	int64_t** read_profile = aligner->read_profile;
+	for (size_t j = 0; j < read_length; j++) {
+		read_profile[j] = get_profile_row(aligner, read[j]);
+		if (read_profile[j] == NULL) {
+			return false;
+		}
+	}
+
+	if (aligner->stats_enabled) {
+		stage_start = count_stage_time(&aligner->stats.encode_nanoseconds, stage_start);
+	}
+
+	size_t len_X = aligner->query_length;
+	size_t len_Y = read_length;
+	int64_t gap_penalty = aligner->gap_penalty;
+	int64_t* scores = aligner->scores;
+
+	/*
+		Track the best score while filling the matrix, the first best score found in row-major order is
+		kept like best_linear_gap_smith_waterman_score_indices().
+	*/
+	int64_t best_score = -1;
+	size_t best_x = 0;
+	size_t best_y = 0;
+
+	//first row done without the 'up' and 'up_left' neighbors
+	int64_t left = 0;
+	for (size_t j = 0; j < len_Y; j++) {
+		left = profile_linear_gap_smith_waterman_score(left, 0, 0, read_profile[j][0], gap_penalty);
+		scores[j] = left;
+		if (left > best_score) {
+			best_score = left;
+			best_x = 0;
+			best_y = j;
+		}
+	}
+
+	for (size_t i = 1; i < len_X; i++) {
+		int64_t* row = scores + (i * len_Y);
+		int64_t* previous_row = row - len_Y;
+
+		left = profile_linear_gap_smith_waterman_score(0, 0, previous_row[0], read_profile[0][i], gap_penalty);
+		row[0] = left;
+		if (left > best_score) {
+			best_score = left;
+			best_x = i;
+			best_y = 0;
+		}
+
+		for (size_t j = 1; j < len_Y; j++) {
+			left = profile_linear_gap_smith_waterman_score(left, previous_row[j - 1], previous_row[j], read_profile[j][i], gap_penalty);
+			row[j] = left;
+			if (left > best_score) {
+				best_score = left;
+				best_x = i;
+				best_y = j;
+			}
+		}
+	}
+
+	result->score = best_score;
+	result->query_stop = best_x;
+	result->read_stop = best_y;
+
+	if (aligner->stats_enabled) {
+		stage_start = count_stage_time(&aligner->stats.fill_nanoseconds, stage_start);
+		aligner->stats.alignment_count++;
+		aligner->stats.cell_count = aligner->stats.cell_count + ((uint64_t)len_X * len_Y);
+	}
+
+	if (best_score < traceback_cutoff) {
+		//the alignment is not needed, skip the traceback
+		aligner->query_trace[0] = '\0';
+		aligner->read_trace[0] = '\0';
+
+		result->alignment_length = 0;
+		result->query_start = best_x;
+		result->read_start = best_y;
+		result->query_alignment = aligner->query_trace;
+		result->read_alignment = aligner->read_trace;
+
+		if (aligner->stats_enabled) {
+			aligner->stats.skipped_traceback_count++;
+		}
+		return true;
+	}
+
+	result->alignment_length = trace_scores(aligner->query, len_X, read, len_Y, scores, aligner->query_trace, aligner->read_trace, &best_x, &best_y, aligner->get_substitution_matrix_value, gap_penalty);
+
+	if (aligner->stats_enabled) {
+		count_stage_time(&aligner->stats.traceback_nanoseconds, stage_start);
+		aligner->stats.traceback_count++;
+	}
+
+	result->query_start = best_x;
+	result->read_start = best_y;
+	result->query_alignment = aligner->query_trace;
+	result->read_alignment = aligner->read_trace;
+
+	return true;
+}
@@ -22,8 +22,55 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <time.h>
+
+/*
+	gqss_aligner is an opaque Smith-Waterman (linear gap penalty) context for a single query sequence.
+
+	The context owns a copy of the query, the query profile (substitution scores of every query position
+	against each read character, built the first time a character is seen) and the scoring matrix and
+	alignment string scratch memory. Scratch memory only grows, so once a context has aligned its longest
+	read, gqss_aligner_align() no longer allocates. A context must not be used by two threads at once.
+*/
+typedef struct gqss_aligner gqss_aligner;
+
+/*
+	gqss_alignment_result describes the best local alignment found by gqss_aligner_align().
+
+	The indices are 0-indexed and inclusive. 'query_alignment' and 'read_alignment' are null terminated
+	C strings of length 'alignment_length' owned by the aligner, they remain valid until the next call to
+	gqss_aligner_align() or gqss_aligner_destroy().
+*/
+typedef struct gqss_alignment_result {
+	int64_t score;
+	size_t query_start;
+	size_t query_stop;
+	size_t read_start;
+	size_t read_stop;
+	size_t alignment_length;
+	char* query_alignment;
+	char* read_alignment;
+} gqss_alignment_result;
+
+/*
+	gqss_aligner_stats counts the work of an aligner once enabled with gqss_aligner_set_stats(): the reads aligned, the scoring
+	matrix cells filled, the alignments traced back and those skipped for scoring below the traceback cut-off, the
+	allocations made while aligning (growing the scratch buffers and computing query profile rows), and the CLOCK_MONOTONIC
+	nanoseconds spent encoding the reads (looking up their query profile rows), filling the scoring matrix and tracing back.
+*/
+typedef struct gqss_aligner_stats {
+	uint64_t alignment_count;
+	uint64_t cell_count;
+	uint64_t traceback_count;
+	uint64_t skipped_traceback_count;
+	uint64_t allocation_count;
+	uint64_t encode_nanoseconds;
+	uint64_t fill_nanoseconds;
+	uint64_t traceback_nanoseconds;
+} gqss_aligner_stats;
 
 /*
 	best_linear_gap_smith_waterman_score(int64_t left, int64_t up_left, int64_t up, char a, char b, int64_t (*get_substitution_matrix_value)(char a, char b), int64_t gap_penalty)
@@ -56,4 +103,75 @@ bool best_linear_gap_smith_waterman_score_indices(size_t len_X, size_t len_Y, in
 */
 void trace_linear_gap_smith_waterman(char* seq_X, char* seq_Y, int64_t* Z, char* trace_X, char* trace_Y, size_t* x, size_t* y, int64_t (*get_substitution_matrix_value)(char a, char b), int64_t gap_penalty);
 
+/*
+	gqss_aligner_create(char* query, size_t query_length, int64_t (*get_substitution_matrix_value)(char a, char b), int64_t gap_penalty)
+
+	gqss_aligner_create() returns a newly allocated aligner context for 'query' (the query is copied). The function returns
+	a NULL pointer if 'query_length' is 0 or if memory could not be allocated.
+*/
+gqss_aligner* gqss_aligner_create(char* query, size_t query_length, int64_t (*get_substitution_matrix_value)(char a, char b), int64_t gap_penalty);
+
+/*
+	gqss_aligner_create_with_profile(char* query, size_t query_length, int64_t (*get_substitution_matrix_value)(char a, char b), int64_t gap_penalty, int64_t** shared_profile)
+
+	gqss_aligner_create_with_profile() is gqss_aligner_create() with precomputed query profile rows. 'shared_profile' has 256
+	entries, entry 'c' is either a NULL pointer or the 'query_length' substitution scores of read character 'c' against every
+	query position. The rows are borrowed: they are never written or freed and must outlive the aligner and its clones.
+*/
+gqss_aligner* gqss_aligner_create_with_profile(char* query, size_t query_length, int64_t (*get_substitution_matrix_value)(char a, char b), int64_t gap_penalty, int64_t** shared_profile);
+
+/*
+	gqss_aligner_clone(gqss_aligner* aligner)
+
+	gqss_aligner_clone() returns a new aligner context with the same query, substitution matrix and gap penalty as 'aligner'.
+	The clone has its own profile and scratch memory (it borrows the same shared profile rows), so the two contexts may be
+	used from different threads. The function returns a NULL pointer if memory could not be allocated.
+*/
+gqss_aligner* gqss_aligner_clone(gqss_aligner* aligner);
+
+/*
+	gqss_aligner_query_length(gqss_aligner* aligner)
+
+	gqss_aligner_query_length() returns the length of the aligner's query sequence.
+*/
+size_t gqss_aligner_query_length(gqss_aligner* aligner);
+
+/*
+	gqss_aligner_set_stats(gqss_aligner* aligner, bool enabled)
+
+	gqss_aligner_set_stats() starts or stops counting the work of 'aligner' (see gqss_aligner_stats), clones created from
+	then on count as well. Counting reads the clock 4 times per alignment, it is disabled by default.
+*/
+void gqss_aligner_set_stats(gqss_aligner* aligner, bool enabled);
+
+//add the counters of 'aligner' to 'stats'
+void gqss_aligner_add_stats(gqss_aligner* aligner, gqss_aligner_stats* stats);
+
+/*
+	gqss_aligner_destroy(gqss_aligner* aligner)
+
+	gqss_aligner_destroy() frees the aligner context and every allocation owned by it.
+*/
+void gqss_aligner_destroy(gqss_aligner* aligner);
+
+/*
+	gqss_aligner_align(gqss_aligner* aligner, char* read, size_t read_length, gqss_alignment_result* result)
+
+	gqss_aligner_align() aligns 'read' (which does not need to be null terminated) against the aligner's query and
+	assigns the best score, its indices and the alignment strings to 'result'. The query is 'X' and the read is 'Y'
+	in the terms of linear_gap_smith_waterman() and the results are identical to those functions.
+
+	gqss_aligner_align() returns false if 'read_length' is 0 or if scratch memory could not be allocated.
+*/
+bool gqss_aligner_align(gqss_aligner* aligner, char* read, size_t read_length, gqss_alignment_result* result);
+
+/*
+	gqss_aligner_align_cutoff(gqss_aligner* aligner, char* read, size_t read_length, int64_t traceback_cutoff, gqss_alignment_result* result)
+
+	gqss_aligner_align_cutoff() is gqss_aligner_align() that only traces back alignments scoring at least 'traceback_cutoff'.
+	The result of a lower score has the best score and stop indices, start indices equal to the stop indices and empty
+	alignment strings. INT64_MAX computes scores only.
+*/
+bool gqss_aligner_align_cutoff(gqss_aligner* aligner, char* read, size_t read_length, int64_t traceback_cutoff, gqss_alignment_result* result);
+
 #endif /* GQSS_LINEAR_GAP_SMITH_WATERMAN_H */